@@ -380,3 +380,218 @@ public:
     UPROPERTY(BlueprintReadOnly, Category = "Path")
     FString UserLayout;
 };
+
+/** @enum Priority of a request on the background file I/O queue **/
+UENUM(BlueprintType)
+enum class EAGTFileIOPriority : uint8
+{
+    Low UMETA(DisplayName = "Low"),
+    Normal UMETA(DisplayName = "Normal"),
+    High UMETA(DisplayName = "High")
+};
+
+/** @enum Outcome of an asynchronous file request **/
+UENUM(BlueprintType)
+enum class EAGTFileIOResult : uint8
+{
+    Success UMETA(DisplayName = "Success"),
+    Failed UMETA(DisplayName = "Failed"),
+    Canceled UMETA(DisplayName = "Canceled")
+};
+
+/** @struct Output of an asynchronous file request. Only the fields of the requested operation are filled **/
+USTRUCT(BlueprintType)
+struct FAGTFileIOPayload
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "FileSystem")
+    FString Text;
+
+    UPROPERTY(BlueprintReadOnly, Category = "FileSystem")
+    TArray<uint8> Bytes;
+
+    UPROPERTY(BlueprintReadOnly, Category = "FileSystem")
+    TArray<FString> Headers;
+
+    UPROPERTY(BlueprintReadOnly, Category = "FileSystem")
+    TArray<FString> Data;
+
+    UPROPERTY(BlueprintReadOnly, Category = "FileSystem")
+    int32 Total{0};
+
+    UPROPERTY(BlueprintReadOnly, Category = "FileSystem")
+    FString Error;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FAGTFileIOProgressSignature, float, Progress);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FAGTFileIOCompleteSignature, EAGTFileIOResult, Result, const FAGTFileIOPayload&, Payload);
+
+/** @enum Type of a column parsed by the columnar csv reader **/
+UENUM(BlueprintType)
+enum class EAGTCsvColumnType : uint8
+{
+    String UMETA(DisplayName = "String"),
+    Name UMETA(DisplayName = "Name"),
+    Int UMETA(DisplayName = "Int"),
+    Float UMETA(DisplayName = "Float")
+};
+
+/** @struct A typed csv column. Only the array matching Type is filled **/
+USTRUCT(BlueprintType)
+struct FAGTCsvColumn
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "CSV")
+    FString Header;
+
+    UPROPERTY(BlueprintReadOnly, Category = "CSV")
+    EAGTCsvColumnType Type{EAGTCsvColumnType::String};
+
+    UPROPERTY(BlueprintReadOnly, Category = "CSV")
+    TArray<FString> Strings;
+
+    UPROPERTY(BlueprintReadOnly, Category = "CSV")
+    TArray<FName> Names;
+
+    UPROPERTY(BlueprintReadOnly, Category = "CSV")
+    TArray<int32> Ints;
+
+    UPROPERTY(BlueprintReadOnly, Category = "CSV")
+    TArray<float> Floats;
+};
+
+/** @enum How the directory index may answer a query **/
+UENUM(BlueprintType)
+enum class EAGTCachePolicy : uint8
+{
+    // Served from memory only while a watcher keeps the entry up to date, otherwise asks the file system
+    Exact UMETA(DisplayName = "Exact"),
+    // Served from memory whenever the entry is cached, even if nothing watches it
+    Stale UMETA(DisplayName = "Stale")
+};
+
+/** @enum Kind of job handled by the bulk file operation engine **/
+UENUM(BlueprintType)
+enum class EAGTFileOperation : uint8
+{
+    Copy UMETA(DisplayName = "Copy"),
+    Move UMETA(DisplayName = "Move"),
+    Delete UMETA(DisplayName = "Delete")
+};
+
+/** @struct One job of a bulk file operation. For directories Dest is the directory that receives the content of Source **/
+USTRUCT(BlueprintType)
+struct FAGTFileOperationJob
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FileOperation")
+    EAGTFileOperation Operation{EAGTFileOperation::Copy};
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FileOperation")
+    FString Source;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FileOperation")
+    FString Dest;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FileOperation")
+    bool Overwrite{true};
+};
+
+/** @struct Progress of a bulk file operation **/
+USTRUCT(BlueprintType)
+struct FAGTFileOperationProgress
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "FileOperation")
+    int64 BytesDone{0};
+
+    UPROPERTY(BlueprintReadOnly, Category = "FileOperation")
+    int64 BytesTotal{0};
+
+    UPROPERTY(BlueprintReadOnly, Category = "FileOperation")
+    int32 FilesDone{0};
+
+    UPROPERTY(BlueprintReadOnly, Category = "FileOperation")
+    int32 FilesTotal{0};
+
+    UPROPERTY(BlueprintReadOnly, Category = "FileOperation")
+    int32 FilesFailed{0};
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FAGTFileOperationProgressSignature, const FAGTFileOperationProgress&, Progress);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(
+    FAGTFileOperationCompleteSignature, EAGTFileIOResult, Result, const FAGTFileOperationProgress&, Progress, const TArray<FString>&, Errors);
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(
+    FAGTBatchHashCompleteSignature, EAGTFileIOResult, Result, const TArray<FString>&, Hashes, const TArray<FString>&, Errors);
+
+/** @enum How a file is written to disk **/
+UENUM(BlueprintType)
+enum class EAGTWriteMode : uint8
+{
+    // Writes straight over the target
+    Direct UMETA(DisplayName = "Direct"),
+    // Writes a synced temp file and renames it over the target
+    Atomic UMETA(DisplayName = "Atomic"),
+    // Like Atomic, but the sync and rename happen at the end of the frame together with the other batched writes
+    AtomicBatched UMETA(DisplayName = "Atomic Batched")
+};
+
+/** @enum Codec of the compressed block file format **/
+UENUM(BlueprintType)
+enum class EAGTCompression : uint8
+{
+    LZ4 UMETA(DisplayName = "LZ4"),
+    Zlib UMETA(DisplayName = "Zlib"),
+    // Falls back to Zlib when the engine was built without Oodle
+    Oodle UMETA(DisplayName = "Oodle")
+};
+
+/** @struct What a put into the blob store, or a garbage collection pass, did **/
+USTRUCT(BlueprintType)
+struct FAGTBlobStoreStats
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "BlobStore")
+    int32 Chunks{0};
+
+    UPROPERTY(BlueprintReadOnly, Category = "BlobStore")
+    int32 NewChunks{0};
+
+    UPROPERTY(BlueprintReadOnly, Category = "BlobStore")
+    int64 BytesWritten{0};
+
+    UPROPERTY(BlueprintReadOnly, Category = "BlobStore")
+    int32 RemovedChunks{0};
+
+    UPROPERTY(BlueprintReadOnly, Category = "BlobStore")
+    int64 BytesReclaimed{0};
+};
+
+/** @struct A byte range of a file, or of a buffer when returned as a slice **/
+USTRUCT(BlueprintType)
+struct FAGTReadRange
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "File")
+    int64 Offset{0};
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "File")
+    int64 Length{0};
+};
+
+/** @struct Byte array wrapper, Blueprint has no arrays of arrays **/
+USTRUCT(BlueprintType)
+struct FAGTByteArray
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "File")
+    TArray<uint8> Bytes;
+};
@@ -26,6 +26,11 @@ public class AdvanceGameTools : ModuleRules
             // ... add private dependencies that you statically link with here ...
         });
 
+        if (Target.bBuildEditor)
+        {
+            PrivateDependencyModuleNames.Add("DirectoryWatcher");
+        }
+
         DynamicallyLoadedModuleNames.AddRange(new string[] {
             // ... add any modules that your module loads dynamically here ...
         });
@@ -1,18 +1,34 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "AdvanceGameTools.h"
+#include "AdvanceGameTools/Library/AGTFileIOQueue.h"
+#include "AdvanceGameTools/Library/AGTDirectoryIndex.h"
+#include "AdvanceGameTools/Library/AGTAtomicFile.h"
+#include "AdvanceGameTools/Library/AGTAppendLog.h"
+#include "AdvanceGameTools/Library/AGTFileHandlePool.h"
+#include "AdvanceGameTools/Library/AGTHashCache.h"
 
 #define LOCTEXT_NAMESPACE "FAdvanceGameToolsModule"
 
 void FAdvanceGameToolsModule::StartupModule()
 {
     // This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+    FAGTAtomicFile::Startup();
+    FAGTFileIOQueue::Startup();
+    FAGTFileHandlePool::Startup();
+    FAGTAppendLog::Startup();
 }
 
 void FAdvanceGameToolsModule::ShutdownModule()
 {
     // This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
     // we call this function before unloading the module.
+    FAGTAppendLog::Shutdown();
+    FAGTFileIOQueue::Shutdown();
+    FAGTDirectoryIndex::Shutdown();
+    FAGTHashCache::Shutdown();
+    FAGTAtomicFile::Shutdown();
+    FAGTFileHandlePool::Shutdown();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,258 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTAppendLog.h"
+#include "AdvanceGameTools/Library/AGTFileChange.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/ScopeRWLock.h"
+
+static TUniquePtr<FAGTAppendLog> GAppendLog;
+
+namespace AGTAppendLog
+{
+/** Guards creation and destruction of the instance, Get may be called from any thread */
+static FCriticalSection InstanceLock;
+
+/** Appends hold it shared while they check bShutDown and queue, Shutdown takes it exclusively so none is in flight afterwards */
+static FRWLock AppendLock;
+
+/** Set by Shutdown, appends fail until the next Startup instead of bringing the writer back */
+static std::atomic<bool> bShutDown{false};
+}  // namespace AGTAppendLog
+
+void FAGTAppendLog::Startup()
+{
+    FScopeLock ScopeLock(&AGTAppendLog::InstanceLock);
+    AGTAppendLog::bShutDown = false;
+    // An instance created while shut down has no writer, it is replaced by one that has
+    GAppendLog.Reset();
+    GAppendLog = TUniquePtr<FAGTAppendLog>(new FAGTAppendLog(true));
+}
+
+FAGTAppendLog& FAGTAppendLog::Get()
+{
+    FScopeLock ScopeLock(&AGTAppendLog::InstanceLock);
+    if (!GAppendLog.IsValid())
+    {
+        GAppendLog = TUniquePtr<FAGTAppendLog>(new FAGTAppendLog(!AGTAppendLog::bShutDown.load()));
+    }
+    return *GAppendLog;
+}
+
+void FAGTAppendLog::Shutdown()
+{
+    {
+        FWriteScopeLock AppendScope(AGTAppendLog::AppendLock);
+        AGTAppendLog::bShutDown = true;
+    }
+    TUniquePtr<FAGTAppendLog> Log;
+    {
+        FScopeLock ScopeLock(&AGTAppendLog::InstanceLock);
+        Log = MoveTemp(GAppendLog);
+    }
+    // Joins the writer outside the lock, the destructor writes what is still queued
+    Log.Reset();
+}
+
+FAGTAppendLog::FAGTAppendLog(bool bStartWriter)
+{
+    WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+    WrittenEvent = FPlatformProcess::GetSynchEventFromPool(true);
+    if (bStartWriter && FPlatformProcess::SupportsMultithreading())
+    {
+        Writer = new FWriter(*this);
+        Thread = FRunnableThread::Create(Writer, TEXT("AGTAppendLog"), 0, TPri_BelowNormal);
+    }
+}
+
+FAGTAppendLog::~FAGTAppendLog()
+{
+    StopThread();
+    // Whatever was posted after the writer stopped still belongs in the files
+    WriteBatch();
+    Files.Empty();
+    FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+    FPlatformProcess::ReturnSynchEventToPool(WrittenEvent);
+    WakeEvent = nullptr;
+    WrittenEvent = nullptr;
+}
+
+void FAGTAppendLog::StopThread()
+{
+    bStopping = true;
+    if (Thread)
+    {
+        WakeEvent->Trigger();
+        Thread->WaitForCompletion();
+        delete Thread;
+        Thread = nullptr;
+    }
+    delete Writer;
+    Writer = nullptr;
+}
+
+void FAGTAppendLog::SetRotation(int64 InMaxFileSize, double InMaxFileAge, int32 InMaxBackups)
+{
+    MaxFileSize = FMath::Max<int64>(InMaxFileSize, 0);
+    MaxFileAge = FMath::Max(InMaxFileAge, 0.0);
+    MaxBackups = FMath::Max(InMaxBackups, 0);
+}
+
+bool FAGTAppendLog::Append(const FString& Path, FString&& Text)
+{
+    FReadScopeLock AppendScope(AGTAppendLog::AppendLock);
+    if (AGTAppendLog::bShutDown.load())
+    {
+        return false;
+    }
+    Queue.Enqueue({Path, MoveTemp(Text)});
+    NumPosted.fetch_add(1, std::memory_order_release);
+
+    // Without a writer thread the message goes out right away
+    if (!Thread)
+    {
+        WriteBatch();
+    }
+    return true;
+}
+
+void FAGTAppendLog::Flush()
+{
+    const uint64 Target = NumPosted.load(std::memory_order_acquire);
+    if (!Thread)
+    {
+        WriteBatch();
+        return;
+    }
+    while (NumWritten.load(std::memory_order_acquire) < Target && !bStopping)
+    {
+        WrittenEvent->Reset();
+        WakeEvent->Trigger();
+        WrittenEvent->Wait(10);
+    }
+}
+
+FAGTAppendLog::FLogFile* FAGTAppendLog::OpenFile(const FString& Path, int64 IncomingBytes)
+{
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    FLogFile* File = Files.Find(Path);
+    if (File)
+    {
+        const int64 SizeLimit = MaxFileSize.load();
+        const double AgeLimit = MaxFileAge.load();
+        const bool bTooLarge = SizeLimit > 0 && File->Size > 0 && File->Size + IncomingBytes > SizeLimit;
+        const bool bTooOld = AgeLimit > 0.0 && FPlatformTime::Seconds() - File->OpenedAt >= AgeLimit;
+        if (!bTooLarge && !bTooOld)
+        {
+            return File;
+        }
+        File->Handle.Reset();
+        Files.Remove(Path);
+        Rotate(Path);
+    }
+    else
+    {
+        PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Path));
+        // A file left over from an earlier session counts against the size limit too
+        const int64 SizeLimit = MaxFileSize.load();
+        const int64 Existing = PlatformFile.FileSize(*Path);
+        if (SizeLimit > 0 && Existing > 0 && Existing + IncomingBytes > SizeLimit)
+        {
+            Rotate(Path);
+        }
+    }
+
+    const FAGTFileChange Change(Path);
+    TUniquePtr<IFileHandle> Handle(PlatformFile.OpenWrite(*Path, true, false));
+    if (!Handle.IsValid())
+    {
+        UE_LOG(LogTemp, Error, TEXT("FAGTAppendLog: could not open %s"), *Path);
+        return nullptr;
+    }
+    FLogFile& NewFile = Files.Add(Path);
+    NewFile.Size = Handle->Size();
+    NewFile.OpenedAt = FPlatformTime::Seconds();
+    NewFile.Handle = MoveTemp(Handle);
+    return &NewFile;
+}
+
+void FAGTAppendLog::Rotate(const FString& Path)
+{
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    const FString Base = FPaths::GetBaseFilename(Path, false);
+    const FString Extension = FPaths::GetExtension(Path, true);
+    auto BackupPath = [&Base, &Extension](int32 Index) { return FString::Printf(TEXT("%s.%d%s"), *Base, Index, *Extension); };
+    // The backups share the base name, one scope over the directory covers all of them
+    const FAGTFileChange Change(FPaths::GetPath(Path));
+
+    const int32 Backups = MaxBackups.load();
+    if (Backups <= 0)
+    {
+        PlatformFile.DeleteFile(*Path);
+        return;
+    }
+
+    // Shift the older files up by one, the oldest falls off the end
+    PlatformFile.DeleteFile(*BackupPath(Backups));
+    for (int32 Index = Backups - 1; Index >= 1; --Index)
+    {
+        const FString From = BackupPath(Index);
+        if (PlatformFile.FileExists(*From))
+        {
+            PlatformFile.MoveFile(*BackupPath(Index + 1), *From);
+        }
+    }
+    if (!PlatformFile.MoveFile(*BackupPath(1), *Path))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("FAGTAppendLog: could not rotate %s"), *Path);
+    }
+}
+
+void FAGTAppendLog::WriteBatch()
+{
+    FScopeLock ScopeLock(&WriteLock);
+
+    // Group the batch per file so every file gets a single write
+    TMap<FString, TArray<uint8>> Batch;
+    uint64 NumMessages = 0;
+    FMessage Message;
+    while (Queue.Dequeue(Message))
+    {
+        TArray<uint8>& Bytes = Batch.FindOrAdd(Message.Path);
+        const int32 Length = FPlatformString::ConvertedLength<UTF8CHAR>(*Message.Text, Message.Text.Len());
+        const int32 Offset = Bytes.Num();
+        Bytes.AddUninitialized(Length);
+        FPlatformString::Convert(reinterpret_cast<UTF8CHAR*>(Bytes.GetData() + Offset), Length, *Message.Text, Message.Text.Len());
+        ++NumMessages;
+    }
+
+    for (TPair<FString, TArray<uint8>>& Pair : Batch)
+    {
+        FLogFile* File = OpenFile(Pair.Key, Pair.Value.Num());
+        if (!File || !File->Handle->Write(Pair.Value.GetData(), Pair.Value.Num()))
+        {
+            UE_LOG(LogTemp, Error, TEXT("FAGTAppendLog: dropped %d bytes for %s"), Pair.Value.Num(), *Pair.Key);
+            continue;
+        }
+        File->Size += Pair.Value.Num();
+        // Hand the batch to the operating system so a crash of the game does not lose it
+        File->Handle->Flush();
+    }
+
+    if (NumMessages > 0)
+    {
+        NumWritten.fetch_add(NumMessages, std::memory_order_release);
+        WrittenEvent->Trigger();
+    }
+}
+
+uint32 FAGTAppendLog::FWriter::Run()
+{
+    while (!Owner.bStopping)
+    {
+        // Messages pile up for a moment so they leave in batches
+        Owner.WakeEvent->Wait(FTimespan::FromSeconds(FlushInterval));
+        Owner.WriteBatch();
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+
+/**
+ * @class Append-only log files written from a background thread.
+ * Any thread can post a message, posting only pushes it on a lock-free queue. The writer thread drains the queue in batches,
+ * groups the messages by file and writes each group with one call into a handle that stays open.
+ * A file is rotated to Name.1.ext, Name.2.ext... once it grows past the size limit or has been open longer than the rotation interval.
+ */
+class ADVANCEGAMETOOLS_API FAGTAppendLog
+{
+public:
+    /** How long the writer waits for more messages before it writes a batch, in seconds */
+    static constexpr float FlushInterval = 0.1f;
+
+    /** @public Thread safe. After Shutdown it returns a log without a writer whose appends fail **/
+    static FAGTAppendLog& Get();
+    static void Startup();
+
+    /** @public Writes everything still queued, closes the files and stops the writer. Called when the module shuts down **/
+    static void Shutdown();
+
+    ~FAGTAppendLog();
+
+    /** @public Queues Text for the file at Path. Never blocks on disk I/O. Thread safe. False once the module has shut down **/
+    bool Append(const FString& Path, FString&& Text);
+
+    /** @public Blocks until every message posted before the call has been handed to the file **/
+    void Flush();
+
+    /**
+     * @public Rotation limits for every file of the service. 0 disables a limit.
+     * MaxBackups is the number of rotated files kept next to the live one.
+     */
+    void SetRotation(int64 InMaxFileSize, double InMaxFileAge, int32 InMaxBackups);
+
+private:
+    struct FMessage
+    {
+        FString Path;
+        FString Text;
+    };
+
+    struct FLogFile
+    {
+        TUniquePtr<IFileHandle> Handle;
+        int64 Size{0};
+        double OpenedAt{0.0};
+    };
+
+    class FWriter : public FRunnable
+    {
+    public:
+        explicit FWriter(FAGTAppendLog& InOwner) : Owner(InOwner) {}
+        virtual uint32 Run() override;
+
+    private:
+        FAGTAppendLog& Owner;
+    };
+
+    explicit FAGTAppendLog(bool bStartWriter);
+
+    /** @private Drains the queue and writes the batch. Only called by the writer, or inline without threads **/
+    void WriteBatch();
+
+    /** @private Opens the file for appending, rotating it first if it is over a limit **/
+    FLogFile* OpenFile(const FString& Path, int64 IncomingBytes);
+
+    void Rotate(const FString& Path);
+
+    void StopThread();
+
+    TQueue<FMessage, EQueueMode::Mpsc> Queue;
+    std::atomic<uint64> NumPosted{0};
+    std::atomic<uint64> NumWritten{0};
+
+    // Only touched by the thread that writes batches
+    TMap<FString, FLogFile> Files;
+    FCriticalSection WriteLock;
+
+    std::atomic<int64> MaxFileSize{0};
+    std::atomic<double> MaxFileAge{0.0};
+    std::atomic<int32> MaxBackups{5};
+
+    FEvent* WakeEvent{nullptr};
+    FEvent* WrittenEvent{nullptr};
+    FWriter* Writer{nullptr};
+    FRunnableThread* Thread{nullptr};
+    FThreadSafeBool bStopping{false};
+};
@@ -0,0 +1,256 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTAtomicFile.h"
+#include "AdvanceGameTools/Library/AGTFileChange.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/CoreDelegates.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/HideWindowsPlatformTypes.h"
+#elif PLATFORM_UNIX || PLATFORM_MAC
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if PLATFORM_LINUX
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace AGTAtomicFile
+{
+struct FPendingWrite
+{
+    FString TempPath;
+    FString Path;
+};
+
+static FCriticalSection BatchLock;
+static TArray<FPendingWrite> Batch;
+static FDelegateHandle EndFrameHandle;
+
+/** Path the native file API understands */
+static FString NativePath(const FString& Path)
+{
+    return IFileManager::Get().ConvertToAbsolutePathForExternalAppForWrite(*Path);
+}
+}  // namespace AGTAtomicFile
+
+void FAGTAtomicFile::Startup()
+{
+    if (!AGTAtomicFile::EndFrameHandle.IsValid())
+    {
+        AGTAtomicFile::EndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&FAGTAtomicFile::CommitBatch);
+    }
+}
+
+void FAGTAtomicFile::Shutdown()
+{
+    if (AGTAtomicFile::EndFrameHandle.IsValid())
+    {
+        FCoreDelegates::OnEndFrame.Remove(AGTAtomicFile::EndFrameHandle);
+        AGTAtomicFile::EndFrameHandle.Reset();
+    }
+    CommitBatch();
+}
+
+int32 FAGTAtomicFile::NumPending()
+{
+    FScopeLock ScopeLock(&AGTAtomicFile::BatchLock);
+    return AGTAtomicFile::Batch.Num();
+}
+
+FString FAGTAtomicFile::MakeTempPath(const FString& Path)
+{
+    // Same directory as the target, a rename across volumes would not be atomic
+    return FString::Printf(TEXT("%s.%s.tmp"), *Path, *FGuid::NewGuid().ToString(EGuidFormats::Digits));
+}
+
+bool FAGTAtomicFile::WriteFile(const FString& FilePath, const uint8* Data, int64 Size, bool bSync)
+{
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    TUniquePtr<IFileHandle> Handle(PlatformFile.OpenWrite(*FilePath));
+    if (!Handle.IsValid())
+    {
+        return false;
+    }
+    if (Size > 0 && !Handle->Write(Data, Size))
+    {
+        return false;
+    }
+    return Handle->Flush(bSync);
+}
+
+bool FAGTAtomicFile::Replace(const FString& TempPath, const FString& Path)
+{
+#if PLATFORM_WINDOWS
+    // Write-through makes the rename itself durable before the call returns
+    return ::MoveFileExW(*AGTAtomicFile::NativePath(TempPath), *AGTAtomicFile::NativePath(Path), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#elif PLATFORM_UNIX || PLATFORM_MAC
+    return ::rename(TCHAR_TO_UTF8(*AGTAtomicFile::NativePath(TempPath)), TCHAR_TO_UTF8(*AGTAtomicFile::NativePath(Path))) == 0;
+#else
+    // No atomic replace available, there is a short window without a target
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    PlatformFile.DeleteFile(*Path);
+    return PlatformFile.MoveFile(*Path, *TempPath);
+#endif
+}
+
+void FAGTAtomicFile::SyncDirectory(const FString& Directory)
+{
+#if PLATFORM_UNIX || PLATFORM_MAC
+    // The rename is only durable once the directory entry is on disk
+    const int Descriptor = ::open(TCHAR_TO_UTF8(*AGTAtomicFile::NativePath(Directory)), O_RDONLY);
+    if (Descriptor >= 0)
+    {
+        ::fsync(Descriptor);
+        ::close(Descriptor);
+    }
+#endif
+}
+
+bool FAGTAtomicFile::Write(const FString& Path, const uint8* Data, int64 Size, EAGTWriteMode Mode, FString& OutError)
+{
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Path));
+
+    if (Mode == EAGTWriteMode::Direct)
+    {
+        const FAGTFileChange Change(Path);
+        if (!WriteFile(Path, Data, Size, false))
+        {
+            OutError = FString("Write error");
+            return false;
+        }
+        return true;
+    }
+
+    const FString TempPath = MakeTempPath(Path);
+    const bool bBatched = Mode == EAGTWriteMode::AtomicBatched;
+    if (!WriteFile(TempPath, Data, Size, !bBatched))
+    {
+        PlatformFile.DeleteFile(*TempPath);
+        OutError = FString("Write error");
+        return false;
+    }
+
+    if (bBatched)
+    {
+        FScopeLock ScopeLock(&AGTAtomicFile::BatchLock);
+        AGTAtomicFile::Batch.Add({TempPath, Path});
+        return true;
+    }
+
+    if (!Replace(TempPath, Path))
+    {
+        PlatformFile.DeleteFile(*TempPath);
+        OutError = FString("Could not replace the file");
+        return false;
+    }
+    SyncDirectory(FPaths::GetPath(Path));
+    return true;
+}
+
+bool FAGTAtomicFile::WriteStream(const FString& Path, TFunctionRef<bool(IFileHandle& Handle)> Fill, FString& OutError)
+{
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Path));
+
+    const FString TempPath = MakeTempPath(Path);
+    TUniquePtr<IFileHandle> Handle(PlatformFile.OpenWrite(*TempPath));
+    if (!Handle.IsValid())
+    {
+        OutError = FString::Printf(TEXT("Could not create %s"), *TempPath);
+        return false;
+    }
+    const bool bFilled = Fill(*Handle) && Handle->Flush(true);
+    Handle.Reset();
+    if (!bFilled)
+    {
+        PlatformFile.DeleteFile(*TempPath);
+        if (OutError.IsEmpty())
+        {
+            OutError = FString("Write error");
+        }
+        return false;
+    }
+
+    const FAGTFileChange Change(Path);
+    if (!Replace(TempPath, Path))
+    {
+        PlatformFile.DeleteFile(*TempPath);
+        OutError = FString("Could not replace the file");
+        return false;
+    }
+    SyncDirectory(FPaths::GetPath(Path));
+    return true;
+}
+
+void FAGTAtomicFile::CommitBatch()
+{
+    TArray<AGTAtomicFile::FPendingWrite> Pending;
+    {
+        FScopeLock ScopeLock(&AGTAtomicFile::BatchLock);
+        if (AGTAtomicFile::Batch.Num() == 0)
+        {
+            return;
+        }
+        Pending = MoveTemp(AGTAtomicFile::Batch);
+    }
+
+    TSet<FString> Directories;
+    for (const AGTAtomicFile::FPendingWrite& Write : Pending)
+    {
+        Directories.Add(FPaths::GetPath(Write.Path));
+    }
+
+    // Make the content of every temp file durable before any of them replaces its target
+#if PLATFORM_LINUX
+    // One syncfs per file system covers the whole batch
+    TSet<uint64> Devices;
+    for (const FString& Directory : Directories)
+    {
+        const FString Native = AGTAtomicFile::NativePath(Directory);
+        struct stat Stat;
+        if (::stat(TCHAR_TO_UTF8(*Native), &Stat) != 0 || Devices.Contains(static_cast<uint64>(Stat.st_dev)))
+        {
+            continue;
+        }
+        Devices.Add(static_cast<uint64>(Stat.st_dev));
+        const int Descriptor = ::open(TCHAR_TO_UTF8(*Native), O_RDONLY);
+        if (Descriptor >= 0)
+        {
+            ::syscall(SYS_syncfs, Descriptor);
+            ::close(Descriptor);
+        }
+    }
+#else
+    // Without syncfs every file is flushed on its own, but still before the first rename
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    for (const AGTAtomicFile::FPendingWrite& Write : Pending)
+    {
+        TUniquePtr<IFileHandle> Handle(PlatformFile.OpenWrite(*Write.TempPath, true));
+        if (Handle.IsValid())
+        {
+            Handle->Flush(true);
+        }
+    }
+#endif
+
+    for (const AGTAtomicFile::FPendingWrite& Write : Pending)
+    {
+        const FAGTFileChange Change(Write.Path);
+        if (!Replace(Write.TempPath, Write.Path))
+        {
+            UE_LOG(LogTemp, Error, TEXT("FAGTAtomicFile: could not replace %s"), *Write.Path);
+            FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*Write.TempPath);
+        }
+    }
+    for (const FString& Directory : Directories)
+    {
+        SyncDirectory(Directory);
+    }
+}
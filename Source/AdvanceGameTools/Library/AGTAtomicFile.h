@@ -0,0 +1,43 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AdvanceGameTools/AGTDataTypes.h"
+
+class IFileHandle;
+
+/**
+ * @class Crash-safe file replacement.
+ * Data goes to a temp file in the target directory. The temp file is synced and then renamed over the target, so a reader
+ * sees either the old or the new file and never a truncated one.
+ * Batched writes leave the temp file unsynced. Once per frame they are all synced together, renamed, and their directories synced,
+ * so many small saves in one frame cost about one sync. Until then the target still holds the previous content.
+ */
+class ADVANCEGAMETOOLS_API FAGTAtomicFile
+{
+public:
+    static void Startup();
+    static void Shutdown();
+
+    /** @public Writes the data with the given mode. Direct mode writes over the target without syncing **/
+    static bool Write(const FString& Path, const uint8* Data, int64 Size, EAGTWriteMode Mode, FString& OutError);
+    static bool Write(const FString& Path, const TArray<uint8>& Data, EAGTWriteMode Mode, FString& OutError) { return Write(Path, Data.GetData(), Data.Num(), Mode, OutError); }
+
+    /**
+     * @public Atomic write of content produced by Fill through a handle to the temp file, for results too large to keep in memory.
+     * Path is only replaced once Fill returned true, so Fill may still read the file being replaced
+     */
+    static bool WriteStream(const FString& Path, TFunctionRef<bool(IFileHandle& Handle)> Fill, FString& OutError);
+
+    /** @public Syncs and renames every batched write. Runs at the end of every frame **/
+    static void CommitBatch();
+
+    static int32 NumPending();
+
+private:
+    static bool WriteFile(const FString& FilePath, const uint8* Data, int64 Size, bool bSync);
+    static bool Replace(const FString& TempPath, const FString& Path);
+    static void SyncDirectory(const FString& Directory);
+    static FString MakeTempPath(const FString& Path);
+};
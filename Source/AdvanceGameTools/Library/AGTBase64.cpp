@@ -0,0 +1,597 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTBase64.h"
+#include "AdvanceGameTools/Library/AGTAtomicFile.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/PlatformFileManager.h"
+
+#if PLATFORM_CPU_X86_FAMILY
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define AGT_SSSE3_TARGET
+#define AGT_AVX2_TARGET
+#else
+#include <cpuid.h>
+#define AGT_SSSE3_TARGET __attribute__((target("ssse3")))
+#define AGT_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#define AGT_BASE64_X86 1
+#elif PLATFORM_CPU_ARM_FAMILY && PLATFORM_64BITS
+#include <arm_neon.h>
+#define AGT_BASE64_NEON 1
+#endif
+
+#ifndef AGT_BASE64_X86
+#define AGT_BASE64_X86 0
+#endif
+#ifndef AGT_BASE64_NEON
+#define AGT_BASE64_NEON 0
+#endif
+
+namespace AGTBase64
+{
+static const ANSICHAR Alphabet[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static constexpr uint8 Invalid = 0xff;
+
+struct FDecodeTable
+{
+    uint8 Values[256];
+
+    FDecodeTable()
+    {
+        FMemory::Memset(Values, Invalid, sizeof(Values));
+        for (int32 Index = 0; Index < 64; ++Index)
+        {
+            Values[static_cast<uint8>(Alphabet[Index])] = static_cast<uint8>(Index);
+        }
+    }
+};
+
+static const FDecodeTable DecodeTable;
+
+/** Vector kernels handle whole blocks and return how much input they consumed, the scalar loop does the rest */
+typedef int64 (*FKernel)(const uint8* Source, int64 Size, uint8* Dest);
+
+static int64 NoKernel(const uint8*, int64, uint8*)
+{
+    return 0;
+}
+
+#if AGT_BASE64_X86
+static void ReadCpuid(int32 Leaf1[4], int32 Leaf7[4])
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    __cpuid(Leaf1, 1);
+    __cpuidex(Leaf7, 7, 0);
+#else
+    unsigned int A, B, C, D;
+    if (__get_cpuid(1, &A, &B, &C, &D))
+    {
+        Leaf1[2] = static_cast<int32>(C);
+    }
+    if (__get_cpuid_count(7, 0, &A, &B, &C, &D))
+    {
+        Leaf7[1] = static_cast<int32>(B);
+    }
+#endif
+}
+
+static bool HasSsse3()
+{
+    int32 Leaf1[4] = {0};
+    int32 Leaf7[4] = {0};
+    ReadCpuid(Leaf1, Leaf7);
+    return (Leaf1[2] & (1 << 9)) != 0;
+}
+
+static bool HasAvx2()
+{
+    int32 Leaf1[4] = {0};
+    int32 Leaf7[4] = {0};
+    ReadCpuid(Leaf1, Leaf7);
+    if ((Leaf1[2] & (1 << 27)) == 0 || (Leaf1[2] & (1 << 28)) == 0 || (Leaf7[1] & (1 << 5)) == 0)
+    {
+        return false;
+    }
+    // The OS has to save the upper halves of the YMM registers
+#if defined(_MSC_VER) && !defined(__clang__)
+    const uint64 Enabled = _xgetbv(0);
+#else
+    uint32 Low, High;
+    __asm__ volatile("xgetbv" : "=a"(Low), "=d"(High) : "c"(0));
+    const uint64 Enabled = (static_cast<uint64>(High) << 32) | Low;
+#endif
+    return (Enabled & 0x6) == 0x6;
+}
+
+/**
+ * 12 bytes become 16 characters per step (Wojciech Mula's method).
+ * Every group of 3 bytes is spread over a 32 bit lane, multiplies move the four 6 bit indices into separate bytes,
+ * and a 16 entry table of offsets turns the indices into characters.
+ */
+AGT_SSSE3_TARGET static int64 EncodeSsse3(const uint8* Source, int64 Size, uint8* Dest)
+{
+    const __m128i Spread = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m128i Offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+    int64 Done = 0;
+    // Loads 16 bytes for 12, so stop while 16 are still there
+    for (; Size - Done >= 16; Done += 12, Dest += 16)
+    {
+        const __m128i Input = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Source + Done)), Spread);
+        const __m128i High = _mm_mulhi_epu16(_mm_and_si128(Input, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        const __m128i Low = _mm_mullo_epi16(_mm_and_si128(Input, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        const __m128i Indices = _mm_or_si128(High, Low);
+
+        // 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12
+        __m128i Range = _mm_subs_epu8(Indices, _mm_set1_epi8(51));
+        Range = _mm_or_si128(Range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), Indices), _mm_set1_epi8(13)));
+        const __m128i Chars = _mm_add_epi8(_mm_shuffle_epi8(Offsets, Range), Indices);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Dest), Chars);
+    }
+    return Done;
+}
+
+AGT_AVX2_TARGET static int64 EncodeAvx2(const uint8* Source, int64 Size, uint8* Dest)
+{
+    const __m256i Spread = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    const __m256i Offsets = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+    int64 Done = 0;
+    // Each 128 bit half takes its own 12 bytes, the second load reads 4 bytes past the 24 that are used
+    for (; Size - Done >= 28; Done += 24, Dest += 32)
+    {
+        const __m128i First = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Source + Done));
+        const __m128i Second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Source + Done + 12));
+        const __m256i Input = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(First), Second, 1), Spread);
+        const __m256i High = _mm256_mulhi_epu16(_mm256_and_si256(Input, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+        const __m256i Low = _mm256_mullo_epi16(_mm256_and_si256(Input, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+        const __m256i Indices = _mm256_or_si256(High, Low);
+
+        __m256i Range = _mm256_subs_epu8(Indices, _mm256_set1_epi8(51));
+        Range = _mm256_or_si256(Range, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), Indices), _mm256_set1_epi8(13)));
+        const __m256i Chars = _mm256_add_epi8(_mm256_shuffle_epi8(Offsets, Range), Indices);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(Dest), Chars);
+    }
+    return Done;
+}
+
+/**
+ * 16 characters become 12 bytes per step. Two 16 entry tables indexed by the low and high nibble flag every character outside
+ * the alphabet, including '=', which leaves the block to the scalar loop. A third table indexed by the high nibble gives the offset
+ * from character to 6 bit value, '/' is the one character whose nibble does not decide it. Multiply-adds then pack four values into three bytes.
+ */
+AGT_SSSE3_TARGET static int64 DecodeSsse3(const uint8* Source, int64 Size, uint8* Dest)
+{
+    const __m128i LowMask = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+    const __m128i HighMask = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i Offsets = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i Pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m128i Nibble = _mm_set1_epi8(0x0f);
+
+    int64 Done = 0;
+    for (; Size - Done >= 16; Done += 16, Dest += 12)
+    {
+        const __m128i Chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Source + Done));
+        const __m128i High = _mm_and_si128(_mm_srli_epi32(Chars, 4), Nibble);
+        const __m128i Flags = _mm_and_si128(_mm_shuffle_epi8(LowMask, _mm_and_si128(Chars, Nibble)), _mm_shuffle_epi8(HighMask, High));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(Flags, _mm_setzero_si128())) != 0xffff)
+        {
+            break;
+        }
+
+        const __m128i Slash = _mm_cmpeq_epi8(Chars, _mm_set1_epi8('/'));
+        const __m128i Values = _mm_add_epi8(Chars, _mm_shuffle_epi8(Offsets, _mm_add_epi8(Slash, High)));
+        const __m128i Pairs = _mm_maddubs_epi16(Values, _mm_set1_epi32(0x01400140));
+        const __m128i Groups = _mm_madd_epi16(Pairs, _mm_set1_epi32(0x00011000));
+        const __m128i Bytes = _mm_shuffle_epi8(Groups, Pack);
+
+        // Exactly 12 bytes, the output may end right here
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(Dest), Bytes);
+        const int32 Tail = _mm_cvtsi128_si32(_mm_srli_si128(Bytes, 8));
+        FMemory::Memcpy(Dest + 8, &Tail, 4);
+    }
+    return Done;
+}
+
+AGT_AVX2_TARGET static int64 DecodeAvx2(const uint8* Source, int64 Size, uint8* Dest)
+{
+    const __m256i LowMask = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+    const __m256i HighMask = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08,
+        0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i Offsets = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i Pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i Nibble = _mm256_set1_epi8(0x0f);
+    // Joins the 12 bytes of both halves
+    const __m256i Compact = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+    int64 Done = 0;
+    for (; Size - Done >= 32; Done += 32, Dest += 24)
+    {
+        const __m256i Chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Source + Done));
+        const __m256i High = _mm256_and_si256(_mm256_srli_epi32(Chars, 4), Nibble);
+        const __m256i Flags = _mm256_and_si256(_mm256_shuffle_epi8(LowMask, _mm256_and_si256(Chars, Nibble)), _mm256_shuffle_epi8(HighMask, High));
+        if (!_mm256_testz_si256(Flags, Flags))
+        {
+            break;
+        }
+
+        const __m256i Slash = _mm256_cmpeq_epi8(Chars, _mm256_set1_epi8('/'));
+        const __m256i Values = _mm256_add_epi8(Chars, _mm256_shuffle_epi8(Offsets, _mm256_add_epi8(Slash, High)));
+        const __m256i Pairs = _mm256_maddubs_epi16(Values, _mm256_set1_epi32(0x01400140));
+        const __m256i Groups = _mm256_madd_epi16(Pairs, _mm256_set1_epi32(0x00011000));
+        const __m256i Bytes = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(Groups, Pack), Compact);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Dest), _mm256_castsi256_si128(Bytes));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(Dest + 16), _mm256_extracti128_si256(Bytes, 1));
+    }
+    return Done;
+}
+#endif
+
+#if AGT_BASE64_NEON
+/** 48 bytes become 64 characters per step, the structured loads and stores do the interleaving */
+static int64 EncodeNeon(const uint8* Source, int64 Size, uint8* Dest)
+{
+    const uint8* Table = reinterpret_cast<const uint8*>(Alphabet);
+    uint8x16x4_t Lookup;
+    Lookup.val[0] = vld1q_u8(Table);
+    Lookup.val[1] = vld1q_u8(Table + 16);
+    Lookup.val[2] = vld1q_u8(Table + 32);
+    Lookup.val[3] = vld1q_u8(Table + 48);
+    const uint8x16_t Mask = vdupq_n_u8(0x3f);
+
+    int64 Done = 0;
+    for (; Size - Done >= 48; Done += 48, Dest += 64)
+    {
+        const uint8x16x3_t Input = vld3q_u8(Source + Done);
+        uint8x16x4_t Chars;
+        Chars.val[0] = vqtbl4q_u8(Lookup, vshrq_n_u8(Input.val[0], 2));
+        Chars.val[1] = vqtbl4q_u8(Lookup, vandq_u8(vorrq_u8(vshrq_n_u8(Input.val[1], 4), vshlq_n_u8(Input.val[0], 4)), Mask));
+        Chars.val[2] = vqtbl4q_u8(Lookup, vandq_u8(vorrq_u8(vshrq_n_u8(Input.val[2], 6), vshlq_n_u8(Input.val[1], 2)), Mask));
+        Chars.val[3] = vqtbl4q_u8(Lookup, vandq_u8(Input.val[2], Mask));
+        vst4q_u8(Dest, Chars);
+    }
+    return Done;
+}
+
+/** Maps characters to 6 bit values. Valid is all ones where the character is in the alphabet */
+static FORCEINLINE uint8x16_t TranslateNeon(uint8x16_t Chars, uint8x16_t& Valid)
+{
+    const uint8x16_t Upper = vandq_u8(vcgeq_u8(Chars, vdupq_n_u8('A')), vcleq_u8(Chars, vdupq_n_u8('Z')));
+    const uint8x16_t Lower = vandq_u8(vcgeq_u8(Chars, vdupq_n_u8('a')), vcleq_u8(Chars, vdupq_n_u8('z')));
+    const uint8x16_t Digit = vandq_u8(vcgeq_u8(Chars, vdupq_n_u8('0')), vcleq_u8(Chars, vdupq_n_u8('9')));
+    const uint8x16_t Plus = vceqq_u8(Chars, vdupq_n_u8('+'));
+    const uint8x16_t Slash = vceqq_u8(Chars, vdupq_n_u8('/'));
+    Valid = vorrq_u8(vorrq_u8(Upper, Lower), vorrq_u8(Digit, vorrq_u8(Plus, Slash)));
+    const uint8x16_t Shift = vorrq_u8(vorrq_u8(vandq_u8(Upper, vdupq_n_u8(static_cast<uint8>(-'A'))), vandq_u8(Lower, vdupq_n_u8(static_cast<uint8>(26 - 'a')))),
+        vorrq_u8(vandq_u8(Digit, vdupq_n_u8(static_cast<uint8>(52 - '0'))),
+            vorrq_u8(vandq_u8(Plus, vdupq_n_u8(static_cast<uint8>(62 - '+'))), vandq_u8(Slash, vdupq_n_u8(static_cast<uint8>(63 - '/'))))));
+    return vaddq_u8(Chars, Shift);
+}
+
+static int64 DecodeNeon(const uint8* Source, int64 Size, uint8* Dest)
+{
+    int64 Done = 0;
+    for (; Size - Done >= 64; Done += 64, Dest += 48)
+    {
+        const uint8x16x4_t Chars = vld4q_u8(Source + Done);
+        uint8x16_t Valid[4];
+        uint8x16_t Values[4];
+        for (int32 Index = 0; Index < 4; ++Index)
+        {
+            Values[Index] = TranslateNeon(Chars.val[Index], Valid[Index]);
+        }
+        if (vminvq_u8(vandq_u8(vandq_u8(Valid[0], Valid[1]), vandq_u8(Valid[2], Valid[3]))) == 0)
+        {
+            break;
+        }
+
+        uint8x16x3_t Bytes;
+        Bytes.val[0] = vorrq_u8(vshlq_n_u8(Values[0], 2), vshrq_n_u8(Values[1], 4));
+        Bytes.val[1] = vorrq_u8(vshlq_n_u8(Values[1], 4), vshrq_n_u8(Values[2], 2));
+        Bytes.val[2] = vorrq_u8(vshlq_n_u8(Values[2], 6), Values[3]);
+        vst3q_u8(Dest, Bytes);
+    }
+    return Done;
+}
+#endif
+
+static FKernel GetEncodeKernel()
+{
+#if AGT_BASE64_X86
+    if (HasAvx2())
+    {
+        return &EncodeAvx2;
+    }
+    if (HasSsse3())
+    {
+        return &EncodeSsse3;
+    }
+#elif AGT_BASE64_NEON
+    return &EncodeNeon;
+#endif
+    return &NoKernel;
+}
+
+static FKernel GetDecodeKernel()
+{
+#if AGT_BASE64_X86
+    if (HasAvx2())
+    {
+        return &DecodeAvx2;
+    }
+    if (HasSsse3())
+    {
+        return &DecodeSsse3;
+    }
+#elif AGT_BASE64_NEON
+    return &DecodeNeon;
+#endif
+    return &NoKernel;
+}
+}  // namespace AGTBase64
+
+void FAGTBase64::Encode(const uint8* Source, int64 Size, ANSICHAR* Dest)
+{
+    static const AGTBase64::FKernel Kernel = AGTBase64::GetEncodeKernel();
+    const int64 Done = Kernel(Source, Size, reinterpret_cast<uint8*>(Dest));
+    Source += Done;
+    Size -= Done;
+    Dest += Done / 3 * 4;
+
+    const ANSICHAR* Alphabet = AGTBase64::Alphabet;
+    for (; Size >= 3; Size -= 3, Source += 3, Dest += 4)
+    {
+        const uint32 Group = (static_cast<uint32>(Source[0]) << 16) | (static_cast<uint32>(Source[1]) << 8) | Source[2];
+        Dest[0] = Alphabet[Group >> 18];
+        Dest[1] = Alphabet[(Group >> 12) & 0x3f];
+        Dest[2] = Alphabet[(Group >> 6) & 0x3f];
+        Dest[3] = Alphabet[Group & 0x3f];
+    }
+    if (Size > 0)
+    {
+        const uint32 Group = (static_cast<uint32>(Source[0]) << 16) | (Size > 1 ? static_cast<uint32>(Source[1]) << 8 : 0);
+        Dest[0] = Alphabet[Group >> 18];
+        Dest[1] = Alphabet[(Group >> 12) & 0x3f];
+        Dest[2] = Size > 1 ? Alphabet[(Group >> 6) & 0x3f] : '=';
+        Dest[3] = '=';
+    }
+}
+
+int64 FAGTBase64::DecodePiece(const ANSICHAR* Source, int64 Size, uint8* Dest, bool& bOutPadded)
+{
+    bOutPadded = false;
+    if (Size % 4 != 0)
+    {
+        return -1;
+    }
+
+    static const AGTBase64::FKernel Kernel = AGTBase64::GetDecodeKernel();
+    const uint8* Chars = reinterpret_cast<const uint8*>(Source);
+    const int64 Done = Kernel(Chars, Size, Dest);
+    uint8* Out = Dest + Done / 4 * 3;
+
+    const uint8* Values = AGTBase64::DecodeTable.Values;
+    for (int64 Index = Done; Index < Size; Index += 4)
+    {
+        const uint8 A = Values[Chars[Index]];
+        const uint8 B = Values[Chars[Index + 1]];
+        const uint8 C = Values[Chars[Index + 2]];
+        const uint8 D = Values[Chars[Index + 3]];
+        // Invalid is the only value with the top bits set
+        if (((A | B | C | D) & 0xc0) == 0)
+        {
+            *Out++ = static_cast<uint8>((A << 2) | (B >> 4));
+            *Out++ = static_cast<uint8>((B << 4) | (C >> 2));
+            *Out++ = static_cast<uint8>((C << 6) | D);
+            continue;
+        }
+
+        // Padding is only allowed in the last group: "xx==" or "xxx="
+        const bool bLast = Index + 4 == Size;
+        if (!bLast || A == AGTBase64::Invalid || B == AGTBase64::Invalid || Chars[Index + 3] != '=')
+        {
+            return -1;
+        }
+        *Out++ = static_cast<uint8>((A << 2) | (B >> 4));
+        if (Chars[Index + 2] != '=')
+        {
+            if (C == AGTBase64::Invalid)
+            {
+                return -1;
+            }
+            *Out++ = static_cast<uint8>((B << 4) | (C >> 2));
+        }
+        bOutPadded = true;
+    }
+    return Out - Dest;
+}
+
+int64 FAGTBase64::Decode(const ANSICHAR* Source, int64 Size, uint8* Dest)
+{
+    bool bPadded = false;
+    return DecodePiece(Source, Size, Dest, bPadded);
+}
+
+FString FAGTBase64::Encode(const uint8* Source, int64 Size)
+{
+    const int64 Length = EncodedSize(Size);
+    check(Length < MAX_int32);
+    FString Result;
+    if (Length == 0)
+    {
+        return Result;
+    }
+
+    TArray<TCHAR>& Chars = Result.GetCharArray();
+    Chars.SetNumUninitialized(static_cast<int32>(Length) + 1);
+    TCHAR* Out = Chars.GetData();
+
+    // Encoded a piece at a time into a small buffer and widened, instead of building a second full size copy
+    constexpr int64 PieceSize = 12 * 1024;
+    ANSICHAR Piece[PieceSize / 3 * 4];
+    for (int64 Offset = 0; Offset < Size; Offset += PieceSize)
+    {
+        const int64 ToEncode = FMath::Min(PieceSize, Size - Offset);
+        const int64 Encoded = EncodedSize(ToEncode);
+        Encode(Source + Offset, ToEncode, Piece);
+        for (int64 Index = 0; Index < Encoded; ++Index)
+        {
+            *Out++ = static_cast<TCHAR>(Piece[Index]);
+        }
+    }
+    *Out = TEXT('\0');
+    return Result;
+}
+
+bool FAGTBase64::Decode(const FString& Source, TArray<uint8>& OutDest)
+{
+    const int64 Size = Source.Len();
+    OutDest.SetNumUninitialized(static_cast<int32>(MaxDecodedSize(Size)));
+    const TCHAR* In = *Source;
+
+    constexpr int64 PieceSize = 16 * 1024;
+    ANSICHAR Piece[PieceSize];
+    int64 Written = 0;
+    bool bPadded = false;
+    for (int64 Offset = 0; Offset < Size; Offset += PieceSize)
+    {
+        const int64 ToDecode = FMath::Min(PieceSize, Size - Offset);
+        for (int64 Index = 0; Index < ToDecode; ++Index)
+        {
+            // Anything outside ASCII is invalid, '*' stands in for it
+            const TCHAR Char = In[Offset + Index];
+            Piece[Index] = Char < 128 ? static_cast<ANSICHAR>(Char) : '*';
+        }
+        if (bPadded)
+        {
+            OutDest.Reset();
+            return false;
+        }
+        const int64 Decoded = DecodePiece(Piece, ToDecode, OutDest.GetData() + Written, bPadded);
+        if (Decoded < 0)
+        {
+            OutDest.Reset();
+            return false;
+        }
+        Written += Decoded;
+    }
+    OutDest.SetNum(static_cast<int32>(Written));
+    return true;
+}
+
+bool FAGTBase64::EncodeStream(IFileHandle& Source, IFileHandle& Dest, FString& OutError, int64 ChunkSize)
+{
+    ChunkSize = FMath::Max<int64>(ChunkSize / 3 * 3, 3);
+    TArray<uint8> Input;
+    TArray<ANSICHAR> Output;
+    Input.SetNumUninitialized(static_cast<int32>(ChunkSize));
+    Output.SetNumUninitialized(static_cast<int32>(EncodedSize(ChunkSize)));
+
+    for (int64 Remaining = Source.Size() - Source.Tell(); Remaining > 0;)
+    {
+        const int64 ToRead = FMath::Min(ChunkSize, Remaining);
+        if (!Source.Read(Input.GetData(), ToRead))
+        {
+            OutError = TEXT("Could not read the source");
+            return false;
+        }
+        Encode(Input.GetData(), ToRead, Output.GetData());
+        if (!Dest.Write(reinterpret_cast<const uint8*>(Output.GetData()), EncodedSize(ToRead)))
+        {
+            OutError = TEXT("Could not write the destination");
+            return false;
+        }
+        Remaining -= ToRead;
+    }
+    return true;
+}
+
+bool FAGTBase64::DecodeStream(IFileHandle& Source, IFileHandle& Dest, FString& OutError, int64 ChunkSize)
+{
+    ChunkSize = FMath::Max<int64>(ChunkSize / 4 * 4, 4);
+    TArray<ANSICHAR> Input;
+    TArray<uint8> Output;
+    Input.SetNumUninitialized(static_cast<int32>(ChunkSize));
+    Output.SetNumUninitialized(static_cast<int32>(MaxDecodedSize(ChunkSize)));
+
+    bool bPadded = false;
+    for (int64 Remaining = Source.Size() - Source.Tell(); Remaining > 0;)
+    {
+        int64 ToRead = FMath::Min(ChunkSize, Remaining);
+        if (!Source.Read(reinterpret_cast<uint8*>(Input.GetData()), ToRead))
+        {
+            OutError = TEXT("Could not read the source");
+            return false;
+        }
+        Remaining -= ToRead;
+
+        int64 ToDecode = ToRead;
+        if (Remaining == 0)
+        {
+            // Text editors like to end files with a line break
+            while (ToDecode > 0 && FCharAnsi::IsWhitespace(Input[ToDecode - 1]))
+            {
+                --ToDecode;
+            }
+        }
+        if (ToDecode == 0)
+        {
+            continue;
+        }
+        if (bPadded)
+        {
+            OutError = TEXT("Data after the Base64 padding");
+            return false;
+        }
+
+        const int64 Decoded = DecodePiece(Input.GetData(), ToDecode, Output.GetData(), bPadded);
+        if (Decoded < 0)
+        {
+            OutError = TEXT("The source is not valid Base64");
+            return false;
+        }
+        if (!Dest.Write(Output.GetData(), Decoded))
+        {
+            OutError = TEXT("Could not write the destination");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FAGTBase64::TransformFile(const FString& SourcePath, const FString& DestPath, FString& OutError, int64 ChunkSize, FTransform Transform)
+{
+    TUniquePtr<IFileHandle> Source(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*SourcePath));
+    if (!Source)
+    {
+        OutError = FString::Printf(TEXT("Could not open %s"), *SourcePath);
+        return false;
+    }
+
+    // Through a temp file, so a failed transform leaves DestPath untouched and DestPath may even be SourcePath
+    return FAGTAtomicFile::WriteStream(
+        DestPath,
+        [&Source, &OutError, ChunkSize, Transform](IFileHandle& Dest)
+        {
+            const bool bDone = Transform(*Source, Dest, OutError, ChunkSize);
+            // Closed before the rename, Windows cannot replace a file that is still open
+            Source.Reset();
+            return bDone;
+        },
+        OutError);
+}
+
+bool FAGTBase64::EncodeFile(const FString& SourcePath, const FString& DestPath, FString& OutError, int64 ChunkSize)
+{
+    return TransformFile(SourcePath, DestPath, OutError, ChunkSize, &EncodeStream);
+}
+
+bool FAGTBase64::DecodeFile(const FString& SourcePath, const FString& DestPath, FString& OutError, int64 ChunkSize)
+{
+    return TransformFile(SourcePath, DestPath, OutError, ChunkSize, &DecodeStream);
+}
@@ -0,0 +1,48 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IFileHandle;
+
+/**
+ * @class Standard Base64 (RFC 4648, padded) with vector kernels.
+ * AVX2 or SSSE3 on x86 CPUs that report them, NEON on 64 bit ARM, a table driven loop everywhere else and for the tails.
+ * Decoding is strict: the length must be a multiple of four and '=' may only end the data.
+ */
+class ADVANCEGAMETOOLS_API FAGTBase64
+{
+public:
+    /** Input consumed per step of the stream functions. A multiple of both 3 and 4, so chunks never split a group */
+    static constexpr int64 DefaultChunkSize = 3 * 1024 * 1024;
+
+    static int64 EncodedSize(int64 Size) { return (Size + 2) / 3 * 4; }
+    static int64 MaxDecodedSize(int64 Size) { return Size / 4 * 3; }
+
+    /** @public Writes EncodedSize(Size) characters to Dest **/
+    static void Encode(const uint8* Source, int64 Size, ANSICHAR* Dest);
+
+    /** @public Writes up to MaxDecodedSize(Size) bytes to Dest. Returns the number of bytes written, or -1 if the input is not valid Base64 **/
+    static int64 Decode(const ANSICHAR* Source, int64 Size, uint8* Dest);
+
+    static FString Encode(const uint8* Source, int64 Size);
+    static bool Decode(const FString& Source, TArray<uint8>& OutDest);
+
+    /**
+     * @public Encodes or decodes from one handle into another in chunks of ChunkSize, so neither side is ever held in memory whole.
+     * Reading starts at the current position of Source. Trailing whitespace after Base64 input is ignored
+     */
+    static bool EncodeStream(IFileHandle& Source, IFileHandle& Dest, FString& OutError, int64 ChunkSize = DefaultChunkSize);
+    static bool DecodeStream(IFileHandle& Source, IFileHandle& Dest, FString& OutError, int64 ChunkSize = DefaultChunkSize);
+
+    static bool EncodeFile(const FString& SourcePath, const FString& DestPath, FString& OutError, int64 ChunkSize = DefaultChunkSize);
+    static bool DecodeFile(const FString& SourcePath, const FString& DestPath, FString& OutError, int64 ChunkSize = DefaultChunkSize);
+
+private:
+    /** @private Decodes one piece of a longer input. bOutPadded tells whether it ended with '=', after which no more data may follow **/
+    static int64 DecodePiece(const ANSICHAR* Source, int64 Size, uint8* Dest, bool& bOutPadded);
+
+    typedef bool (*FTransform)(IFileHandle& Source, IFileHandle& Dest, FString& OutError, int64 ChunkSize);
+    static bool TransformFile(const FString& SourcePath, const FString& DestPath, FString& OutError, int64 ChunkSize, FTransform Transform);
+};
@@ -0,0 +1,127 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTBatchHash.h"
+#include "AdvanceGameTools/Library/SHA256Hash.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformFileManager.h"
+
+FAGTBatchHash::FAGTBatchHash(const TArray<FString>& InFiles, int32 InConcurrency) : Files(InFiles), Concurrency(FMath::Max(1, InConcurrency))
+{
+    Hashes.SetNum(Files.Num());
+}
+
+void FAGTBatchHash::Start(FOnComplete&& InOnComplete)
+{
+    check(!bRunning);
+    OnComplete = MoveTemp(InOnComplete);
+    bRunning = true;
+    Async(EAsyncExecution::ThreadPool,
+        [Self = AsShared()]()
+        {
+            Self->Measure();
+            const int32 NumWorkers = FMath::Clamp(Self->Files.Num(), 1, Self->Concurrency);
+            Self->ActiveWorkers = NumWorkers;
+            for (int32 Index = 0; Index < NumWorkers; ++Index)
+            {
+                Async(EAsyncExecution::ThreadPool, [Self]() { Self->Work(); });
+            }
+        });
+}
+
+void FAGTBatchHash::Run()
+{
+    check(!bRunning);
+    bRunning = true;
+    Measure();
+    ParallelFor(Files.Num(), [this](int32 Index) { HashItem(Index); });
+    Finish(false);
+}
+
+FAGTFileOperationProgress FAGTBatchHash::GetProgress() const
+{
+    FAGTFileOperationProgress Progress;
+    Progress.BytesDone = BytesDone;
+    Progress.BytesTotal = BytesTotal;
+    Progress.FilesDone = FilesDone;
+    Progress.FilesTotal = Files.Num();
+    Progress.FilesFailed = FilesFailed;
+    return Progress;
+}
+
+TArray<FString> FAGTBatchHash::GetErrors() const
+{
+    FScopeLock ScopeLock(&ErrorLock);
+    return Errors;
+}
+
+void FAGTBatchHash::Measure()
+{
+    // Sizes only feed the progress, one stat per file in parallel
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    std::atomic<int64> Total{0};
+    ParallelFor(Files.Num(), [this, &PlatformFile, &Total](int32 Index) { Total += FMath::Max<int64>(PlatformFile.FileSize(*Files[Index]), 0); });
+    BytesTotal = Total;
+}
+
+void FAGTBatchHash::Work()
+{
+    while (!bCanceled)
+    {
+        const int32 Index = NextItem++;
+        if (Index >= Files.Num())
+        {
+            break;
+        }
+        HashItem(Index);
+    }
+
+    if (--ActiveWorkers == 0)
+    {
+        Finish(true);
+    }
+}
+
+void FAGTBatchHash::HashItem(int32 Index)
+{
+    if (bCanceled)
+    {
+        return;
+    }
+    FSHA256Hash Hash;
+    const bool bHashed = Hash.FromFileOverlapped(Files[Index],
+        [this](int64 Size)
+        {
+            BytesDone += Size;
+            return !bCanceled;
+        });
+    if (bHashed)
+    {
+        Hashes[Index] = Hash.GetHash();
+        ++FilesDone;
+    }
+    else if (!bCanceled)
+    {
+        ++FilesFailed;
+        FScopeLock ScopeLock(&ErrorLock);
+        Errors.Add(FString::Printf(TEXT("Could not hash %s"), *Files[Index]));
+    }
+}
+
+void FAGTBatchHash::Finish(bool bNotify)
+{
+    Result = bCanceled ? EAGTFileIOResult::Canceled : (FilesFailed > 0 ? EAGTFileIOResult::Failed : EAGTFileIOResult::Success);
+    bRunning = false;
+    if (!bNotify)
+    {
+        return;
+    }
+    AsyncTask(ENamedThreads::GameThread,
+        [Self = AsShared()]()
+        {
+            if (Self->OnComplete)
+            {
+                Self->OnComplete(*Self);
+            }
+        });
+}
@@ -0,0 +1,63 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AdvanceGameTools/AGTDataTypes.h"
+#include <atomic>
+
+/**
+ * @class Hashes a list of files with SHA-256 on the thread pool.
+ * A fixed number of workers takes files off the list, every file is read double buffered so disk and hashing overlap.
+ * Hashes come back in the order of the input, a file that could not be hashed gets an empty string.
+ */
+class ADVANCEGAMETOOLS_API FAGTBatchHash : public TSharedFromThis<FAGTBatchHash, ESPMode::ThreadSafe>
+{
+public:
+    /** Runs on the game thread once every worker has stopped */
+    typedef TFunction<void(FAGTBatchHash&)> FOnComplete;
+
+    FAGTBatchHash(const TArray<FString>& InFiles, int32 InConcurrency);
+
+    void Start(FOnComplete&& InOnComplete);
+
+    /** @public Hashes the files on the calling thread and the task graph, returns once all are done **/
+    void Run();
+
+    /** @public Workers stop after their current chunk **/
+    void Cancel() { bCanceled = true; }
+
+    bool IsRunning() const { return bRunning; }
+    EAGTFileIOResult GetResult() const { return Result; }
+    FAGTFileOperationProgress GetProgress() const;
+
+    /** @public Only complete once the operation has stopped **/
+    const TArray<FString>& GetHashes() const { return Hashes; }
+    TArray<FString> GetErrors() const;
+
+private:
+    void Measure();
+    void Work();
+    void HashItem(int32 Index);
+    void Finish(bool bNotify);
+
+    TArray<FString> Files;
+    TArray<FString> Hashes;
+    int32 Concurrency;
+
+    std::atomic<int32> NextItem{0};
+    std::atomic<int32> ActiveWorkers{0};
+    std::atomic<int64> BytesDone{0};
+    std::atomic<int64> BytesTotal{0};
+    std::atomic<int32> FilesDone{0};
+    std::atomic<int32> FilesFailed{0};
+    std::atomic<bool> bCanceled{false};
+    std::atomic<bool> bRunning{false};
+    EAGTFileIOResult Result{EAGTFileIOResult::Success};
+
+    mutable FCriticalSection ErrorLock;
+    TArray<FString> Errors;
+    FOnComplete OnComplete;
+};
+
+typedef TSharedPtr<FAGTBatchHash, ESPMode::ThreadSafe> FAGTBatchHashPtr;
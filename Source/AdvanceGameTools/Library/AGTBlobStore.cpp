@@ -0,0 +1,400 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTBlobStore.h"
+#include "AdvanceGameTools/Library/AGTAtomicFile.h"
+#include "AdvanceGameTools/Library/AGTFileChange.h"
+#include "AdvanceGameTools/Library/SHA256Hash.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+namespace AGTBlobStore
+{
+static const TCHAR* ManifestHeader = TEXT("AGTBLOB 1");
+
+static FCriticalSection StoresLock;
+static TMap<FString, FAGTBlobStoreRef> Stores;
+
+/** Random 64 bit value per byte value, fixed so the same content is always cut at the same places */
+struct FGearTable
+{
+    uint64 Values[256];
+
+    FGearTable()
+    {
+        uint64 State = 0x9E3779B97F4A7C15ull;
+        for (uint64& Value : Values)
+        {
+            // splitmix64
+            State += 0x9E3779B97F4A7C15ull;
+            uint64 Mixed = State;
+            Mixed = (Mixed ^ (Mixed >> 30)) * 0xBF58476D1CE4E5B9ull;
+            Mixed = (Mixed ^ (Mixed >> 27)) * 0x94D049BB133111EBull;
+            Value = Mixed ^ (Mixed >> 31);
+        }
+    }
+};
+
+static const FGearTable Gear;
+
+/** Names may use / for folders but must stay inside the manifest directory */
+static bool IsValidName(const FString& Name)
+{
+    if (Name.IsEmpty() || Name.Contains(TEXT("\\")) || Name.Contains(TEXT(":")))
+    {
+        return false;
+    }
+    TArray<FString> Parts;
+    Name.ParseIntoArray(Parts, TEXT("/"), false);
+    for (const FString& Part : Parts)
+    {
+        if (Part.IsEmpty() || Part == TEXT(".") || Part == TEXT(".."))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool IsChunkName(const FString& Name)
+{
+    if (Name.Len() != 64)
+    {
+        return false;
+    }
+    for (const TCHAR Char : Name)
+    {
+        if (!FChar::IsHexDigit(Char))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace AGTBlobStore
+
+FAGTBlobStoreRef FAGTBlobStore::Get(const FString& Root)
+{
+    FString Key = FPaths::ConvertRelativePathToFull(Root);
+    FPaths::NormalizeDirectoryName(Key);
+
+    FScopeLock ScopeLock(&AGTBlobStore::StoresLock);
+    if (const FAGTBlobStoreRef* Store = AGTBlobStore::Stores.Find(Key))
+    {
+        return *Store;
+    }
+    return AGTBlobStore::Stores.Add(Key, MakeShared<FAGTBlobStore, ESPMode::ThreadSafe>(Key));
+}
+
+FAGTBlobStore::FAGTBlobStore(const FString& InRoot) : Root(InRoot) {}
+
+FString FAGTBlobStore::GetChunkPath(const FString& Hash) const
+{
+    // Two hex digits of fan-out keep directories small
+    return FPaths::Combine(Root, TEXT("chunks"), Hash.Left(2), Hash);
+}
+
+FString FAGTBlobStore::GetManifestPath(const FString& Name) const
+{
+    return FPaths::Combine(Root, TEXT("manifests"), Name + TEXT(".manifest"));
+}
+
+void FAGTBlobStore::Split(const uint8* Data, int64 Size, TArray<int64>& OutEnds)
+{
+    const uint64 Mask = ((1ull << AverageChunkBits) - 1) << (64 - AverageChunkBits);
+    int64 Start = 0;
+    while (Start < Size)
+    {
+        const int64 Limit = FMath::Min<int64>(Size, Start + MaxChunkSize);
+        int64 End = Limit;
+        uint64 Hash = 0;
+        // The shift pushes old bytes out, the top bits depend on the last 64 bytes only
+        for (int64 Index = Start + MinChunkSize; Index < Limit; ++Index)
+        {
+            Hash = (Hash << 1) + AGTBlobStore::Gear.Values[Data[Index]];
+            if ((Hash & Mask) == 0)
+            {
+                End = Index + 1;
+                break;
+            }
+        }
+        OutEnds.Add(End);
+        Start = End;
+    }
+}
+
+void FAGTBlobStore::ScanChunks()
+{
+    if (bScanned)
+    {
+        return;
+    }
+    bScanned = true;
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    PlatformFile.IterateDirectoryRecursively(*FPaths::Combine(Root, TEXT("chunks")),
+        [this](const TCHAR* Path, bool bIsDirectory)
+        {
+            // Skips temp files of writes that have not been committed. Content is only checked when a chunk is read
+            FString Name = FPaths::GetCleanFilename(Path);
+            if (!bIsDirectory && AGTBlobStore::IsChunkName(Name))
+            {
+                KnownChunks.Add(MoveTemp(Name));
+            }
+            return true;
+        });
+}
+
+bool FAGTBlobStore::Put(const FString& Name, const uint8* Data, int64 Size, EAGTWriteMode Mode, FAGTBlobStoreStats& OutStats, FString& OutError)
+{
+    OutStats = FAGTBlobStoreStats();
+    if (!AGTBlobStore::IsValidName(Name))
+    {
+        OutError = FString("Blob name is not valid");
+        return false;
+    }
+    TArray<int64> Ends;
+    Split(Data, Size, Ends);
+
+    // Hashing is the expensive part and every chunk is independent
+    TArray<FChunkRef> Chunks;
+    Chunks.SetNum(Ends.Num());
+    ParallelFor(Ends.Num(),
+        [Data, &Ends, &Chunks](int32 Index)
+        {
+            const int64 Start = Index > 0 ? Ends[Index - 1] : 0;
+            FSHA256Hash Hash;
+            Hash.FromBytes(Data + Start, Ends[Index] - Start);
+            Chunks[Index].Hash = Hash.GetHash();
+            Chunks[Index].Size = Ends[Index] - Start;
+        });
+
+    FScopeLock ScopeLock(&Lock);
+    ScanChunks();
+
+    TArray<int32> Missing;
+    TSet<FString> Queued;
+    for (int32 Index = 0; Index < Chunks.Num(); ++Index)
+    {
+        if (!KnownChunks.Contains(Chunks[Index].Hash) && !Queued.Contains(Chunks[Index].Hash))
+        {
+            Queued.Add(Chunks[Index].Hash);
+            Missing.Add(Index);
+        }
+    }
+
+    // Chunks are always committed right away, a batched chunk could be counted as stored and then never reach the disk
+    TArray<bool> Written;
+    Written.SetNumZeroed(Missing.Num());
+    ParallelFor(Missing.Num(),
+        [this, Data, &Ends, &Chunks, &Missing, &Written](int32 Step)
+        {
+            const int32 Index = Missing[Step];
+            const int64 Start = Index > 0 ? Ends[Index - 1] : 0;
+            FString Error;
+            Written[Step] = FAGTAtomicFile::Write(GetChunkPath(Chunks[Index].Hash), Data + Start, Chunks[Index].Size, EAGTWriteMode::Atomic, Error);
+        });
+
+    bool bWritten = true;
+    for (int32 Step = 0; Step < Missing.Num(); ++Step)
+    {
+        if (!Written[Step])
+        {
+            bWritten = false;
+            continue;
+        }
+        KnownChunks.Add(Chunks[Missing[Step]].Hash);
+        OutStats.BytesWritten += Chunks[Missing[Step]].Size;
+    }
+    if (!bWritten)
+    {
+        OutError = FString("Could not write a chunk");
+        return false;
+    }
+    OutStats.Chunks = Chunks.Num();
+    OutStats.NewChunks = Missing.Num();
+
+    TArray<FString> Lines;
+    Lines.Reserve(Chunks.Num() + 1);
+    Lines.Add(FString::Printf(TEXT("%s %lld"), AGTBlobStore::ManifestHeader, Size));
+    for (const FChunkRef& Chunk : Chunks)
+    {
+        Lines.Add(FString::Printf(TEXT("%s %lld"), *Chunk.Hash, Chunk.Size));
+    }
+    // Only the manifest follows Mode, the chunks it lists are already on disk
+    const FTCHARToUTF8 Manifest(*FString::Join(Lines, TEXT("\n")));
+    return FAGTAtomicFile::Write(GetManifestPath(Name), reinterpret_cast<const uint8*>(Manifest.Get()), Manifest.Length(), Mode, OutError);
+}
+
+bool FAGTBlobStore::LoadManifest(const FString& Name, TArray<FChunkRef>& OutChunks, int64& OutSize) const
+{
+    FString Text;
+    if (!FFileHelper::LoadFileToString(Text, *GetManifestPath(Name)))
+    {
+        return false;
+    }
+    TArray<FString> Lines;
+    Text.ParseIntoArrayLines(Lines);
+    if (Lines.Num() == 0 || !Lines[0].StartsWith(AGTBlobStore::ManifestHeader))
+    {
+        return false;
+    }
+    OutSize = FCString::Atoi64(*Lines[0].RightChop(FCString::Strlen(AGTBlobStore::ManifestHeader)));
+
+    OutChunks.Reset(Lines.Num() - 1);
+    int64 Total = 0;
+    for (int32 Index = 1; Index < Lines.Num(); ++Index)
+    {
+        FString Hash;
+        FString Length;
+        if (!Lines[Index].Split(TEXT(" "), &Hash, &Length))
+        {
+            return false;
+        }
+        FChunkRef& Chunk = OutChunks.AddDefaulted_GetRef();
+        Chunk.Hash = MoveTemp(Hash);
+        Chunk.Size = FCString::Atoi64(*Length);
+        Total += Chunk.Size;
+    }
+    return Total == OutSize;
+}
+
+bool FAGTBlobStore::Read(const FString& Name, TArray<uint8>& OutData, FString& OutError)
+{
+    if (!AGTBlobStore::IsValidName(Name))
+    {
+        OutError = FString("Blob name is not valid");
+        return false;
+    }
+    TArray<FChunkRef> Chunks;
+    int64 Size = 0;
+    if (!LoadManifest(Name, Chunks, Size))
+    {
+        OutError = FString("Manifest is missing or damaged");
+        return false;
+    }
+    if (Size > MAX_int32)
+    {
+        OutError = FString("Blob is too large");
+        return false;
+    }
+
+    TArray<int64> Starts;
+    Starts.SetNum(Chunks.Num());
+    for (int32 Index = 1; Index < Chunks.Num(); ++Index)
+    {
+        Starts[Index] = Starts[Index - 1] + Chunks[Index - 1].Size;
+    }
+
+    OutData.SetNumUninitialized(static_cast<int32>(Size));
+    TArray<bool> Damaged;
+    Damaged.SetNumZeroed(Chunks.Num());
+    ParallelFor(Chunks.Num(),
+        [this, &Chunks, &Starts, &OutData, &Damaged](int32 Index)
+        {
+            const FChunkRef& Chunk = Chunks[Index];
+            uint8* Out = OutData.GetData() + Starts[Index];
+            const FAGTPositionalReaderPtr Reader = FAGTFileHandlePool::Get().Acquire(GetChunkPath(Chunk.Hash));
+            if (!Reader.IsValid() || Reader->Size() != Chunk.Size || Reader->ReadAt(0, Out, Chunk.Size) != Chunk.Size)
+            {
+                Damaged[Index] = true;
+                return;
+            }
+            // The name is the hash of the content, a chunk that no longer matches it was damaged on disk
+            FSHA256Hash Hash;
+            Hash.FromBytes(Out, Chunk.Size);
+            Damaged[Index] = !Hash.GetHash().Equals(Chunk.Hash, ESearchCase::IgnoreCase);
+        });
+    if (Damaged.Contains(true))
+    {
+        // Forgotten so the next Put that produces one of them writes it again instead of deduplicating against it
+        FScopeLock ScopeLock(&Lock);
+        for (int32 Index = 0; Index < Chunks.Num(); ++Index)
+        {
+            if (Damaged[Index])
+            {
+                KnownChunks.Remove(Chunks[Index].Hash);
+            }
+        }
+        OutData.Reset();
+        OutError = FString("A chunk is missing or damaged");
+        return false;
+    }
+    return true;
+}
+
+bool FAGTBlobStore::Contains(const FString& Name) const
+{
+    return AGTBlobStore::IsValidName(Name) && FPlatformFileManager::Get().GetPlatformFile().FileExists(*GetManifestPath(Name));
+}
+
+bool FAGTBlobStore::Remove(const FString& Name)
+{
+    if (!AGTBlobStore::IsValidName(Name))
+    {
+        return false;
+    }
+    const FString Path = GetManifestPath(Name);
+    const FAGTFileChange Change(Path);
+    return FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*Path);
+}
+
+FAGTBlobStoreStats FAGTBlobStore::CollectGarbage()
+{
+    FAGTBlobStoreStats Stats;
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+    FScopeLock ScopeLock(&Lock);
+    // Batched chunk and manifest writes must be on disk before they are counted
+    FAGTAtomicFile::CommitBatch();
+
+    const FString ManifestDir = FPaths::Combine(Root, TEXT("manifests"));
+    TArray<FString> Manifests;
+    PlatformFile.IterateDirectoryRecursively(*ManifestDir,
+        [&Manifests, &ManifestDir](const TCHAR* Path, bool bIsDirectory)
+        {
+            FString Relative = Path;
+            if (!bIsDirectory && Relative.EndsWith(TEXT(".manifest")) && FPaths::MakePathRelativeTo(Relative, *(ManifestDir + TEXT("/"))))
+            {
+                Manifests.Add(Relative.LeftChop(9));
+            }
+            return true;
+        });
+
+    TMap<FString, int32> References;
+    for (const FString& Name : Manifests)
+    {
+        TArray<FChunkRef> Chunks;
+        int64 Size = 0;
+        if (!LoadManifest(Name, Chunks, Size))
+        {
+            // An unreadable manifest could refer to anything, deleting now could destroy data
+            UE_LOG(LogTemp, Warning, TEXT("FAGTBlobStore: manifest %s is damaged, garbage collection skipped"), *Name);
+            return Stats;
+        }
+        for (const FChunkRef& Chunk : Chunks)
+        {
+            ++References.FindOrAdd(Chunk.Hash);
+        }
+    }
+
+    KnownChunks.Reset();
+    bScanned = false;
+    ScanChunks();
+    for (auto It = KnownChunks.CreateIterator(); It; ++It)
+    {
+        if (References.Contains(*It))
+        {
+            continue;
+        }
+        const FString Path = GetChunkPath(*It);
+        const int64 Size = PlatformFile.FileSize(*Path);
+        const FAGTFileChange Change(Path);
+        if (PlatformFile.DeleteFile(*Path))
+        {
+            ++Stats.RemovedChunks;
+            Stats.BytesReclaimed += FMath::Max<int64>(Size, 0);
+            It.RemoveCurrent();
+        }
+    }
+    return Stats;
+}
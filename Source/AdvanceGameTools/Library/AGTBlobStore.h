@@ -0,0 +1,69 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AdvanceGameTools/AGTDataTypes.h"
+
+typedef TSharedRef<class FAGTBlobStore, ESPMode::ThreadSafe> FAGTBlobStoreRef;
+
+/**
+ * @class Content-addressed, deduplicating store for byte blobs.
+ * Blobs are cut into content-defined chunks with a gear rolling hash, so an edit only changes the chunks around it.
+ * Every chunk is stored once under its SHA-256 in Root/chunks, a blob is a manifest in Root/manifests listing its chunks.
+ * Chunks are never changed once written. CollectGarbage counts the references of every manifest and deletes chunks nobody refers to.
+ */
+class ADVANCEGAMETOOLS_API FAGTBlobStore
+{
+public:
+    static constexpr int32 MinChunkSize = 2 * 1024;
+    static constexpr int32 MaxChunkSize = 64 * 1024;
+    /** Cut points are where the top bits of the rolling hash are zero, giving chunks of about 8 KB on average */
+    static constexpr int32 AverageChunkBits = 13;
+
+    /** @public The store of a root directory, shared by every caller **/
+    static FAGTBlobStoreRef Get(const FString& Root);
+
+    explicit FAGTBlobStore(const FString& InRoot);
+
+    /**
+     * @public Stores Data under Name, replacing an earlier blob of that name. Only chunks the store does not have are written.
+     * Name may contain / for folders, but no . or .. parts. Mode applies to the manifest, chunks are always written atomically.
+     */
+    bool Put(const FString& Name, const uint8* Data, int64 Size, EAGTWriteMode Mode, FAGTBlobStoreStats& OutStats, FString& OutError);
+
+    /** @public Rebuilds the blob from its manifest. Every chunk is checked against its hash, a damaged one fails the read **/
+    bool Read(const FString& Name, TArray<uint8>& OutData, FString& OutError);
+
+    bool Contains(const FString& Name) const;
+
+    /** @public Deletes the manifest. The chunks stay until the next garbage collection **/
+    bool Remove(const FString& Name);
+
+    /** @public Deletes every chunk that no manifest refers to **/
+    FAGTBlobStoreStats CollectGarbage();
+
+    /** @public Finds the content-defined chunk boundaries of Data. OutEnds holds the end offset of every chunk **/
+    static void Split(const uint8* Data, int64 Size, TArray<int64>& OutEnds);
+
+private:
+    struct FChunkRef
+    {
+        FString Hash;
+        int64 Size{0};
+    };
+
+    FString GetChunkPath(const FString& Hash) const;
+    FString GetManifestPath(const FString& Name) const;
+
+    bool LoadManifest(const FString& Name, TArray<FChunkRef>& OutChunks, int64& OutSize) const;
+
+    /** @private Fills the set of chunks on disk the first time it is needed. Lock must be held **/
+    void ScanChunks();
+
+    FString Root;
+    TSet<FString> KnownChunks;
+    bool bScanned{false};
+    // Put and CollectGarbage must not interleave, a collection could delete a chunk a new manifest is about to use
+    mutable FCriticalSection Lock;
+};
@@ -0,0 +1,363 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTBulkFileOperation.h"
+#include "AdvanceGameTools/Library/AGTDirectoryScanner.h"
+#include "AdvanceGameTools/Library/AGTFileChange.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformFileManager.h"
+
+FAGTBulkFileOperation::FAGTBulkFileOperation(const TArray<FAGTFileOperationJob>& InJobs, int32 InConcurrency, bool bInResume)
+    : Jobs(InJobs), Concurrency(FMath::Max(1, InConcurrency)), bResume(bInResume)
+{
+}
+
+void FAGTBulkFileOperation::Start(FOnComplete&& InOnComplete)
+{
+    check(!bRunning);
+    OnComplete = MoveTemp(InOnComplete);
+    ++RunId;
+    bRunning = true;
+    Async(EAsyncExecution::ThreadPool,
+        [Self = AsShared()]()
+        {
+            Self->Expand();
+            Self->RunWorkers();
+        });
+}
+
+bool FAGTBulkFileOperation::Resume()
+{
+    if (bRunning || !bExpanded)
+    {
+        return false;
+    }
+    bCanceled = false;
+    ++RunId;
+    bRunning = true;
+    FilesFailed = 0;
+    for (FItem& Item : Items)
+    {
+        if (Item.State == EItemState::Failed)
+        {
+            Item.State = EItemState::Pending;
+        }
+    }
+    {
+        FScopeLock ScopeLock(&ErrorLock);
+        Errors.Reset();
+    }
+    Async(EAsyncExecution::ThreadPool, [Self = AsShared()]() { Self->RunWorkers(); });
+    return true;
+}
+
+FAGTFileOperationProgress FAGTBulkFileOperation::GetProgress() const
+{
+    FAGTFileOperationProgress Progress;
+    Progress.BytesDone = BytesDone;
+    Progress.BytesTotal = BytesTotal;
+    Progress.FilesDone = FilesDone;
+    Progress.FilesTotal = FilesTotal;
+    Progress.FilesFailed = FilesFailed;
+    return Progress;
+}
+
+TArray<FString> FAGTBulkFileOperation::GetErrors() const
+{
+    FScopeLock ScopeLock(&ErrorLock);
+    return Errors;
+}
+
+void FAGTBulkFileOperation::AddError(const FString& Error)
+{
+    FScopeLock ScopeLock(&ErrorLock);
+    Errors.Add(Error);
+}
+
+#pragma region Expand
+
+void FAGTBulkFileOperation::Expand()
+{
+    for (const FAGTFileOperationJob& Job : Jobs)
+    {
+        ExpandJob(Job);
+    }
+
+    // Sizes are gathered in parallel, one stat per file is the slow part of a large tree
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    ParallelFor(Items.Num(),
+        [this, &PlatformFile](int32 Index)
+        {
+            FItem& Item = Items[Index];
+            if (Item.State == EItemState::Pending && Item.Operation != EAGTFileOperation::Delete)
+            {
+                Item.Size = FMath::Max<int64>(PlatformFile.FileSize(*Item.Source), 0);
+            }
+        });
+
+    int64 Total = 0;
+    for (const FItem& Item : Items)
+    {
+        Total += Item.Size;
+    }
+    BytesTotal = Total;
+    FilesTotal = Items.Num();
+    bExpanded = true;
+}
+
+void FAGTBulkFileOperation::ExpandJob(const FAGTFileOperationJob& Job)
+{
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    FString Source = Job.Source;
+    FString Dest = Job.Dest;
+    FPaths::NormalizeDirectoryName(Source);
+    FPaths::NormalizeDirectoryName(Dest);
+
+    const FFileStatData Stat = PlatformFile.GetStatData(*Source);
+    if (!Stat.bIsValid)
+    {
+        FItem& Missing = Items.AddDefaulted_GetRef();
+        Missing.Operation = Job.Operation;
+        Missing.Source = Source;
+        Missing.State = EItemState::Failed;
+        ++FilesFailed;
+        AddError(FString::Printf(TEXT("Source does not exist: %s"), *Source));
+        return;
+    }
+
+    if (!Stat.bIsDirectory)
+    {
+        FItem& Item = Items.AddDefaulted_GetRef();
+        Item.Operation = Job.Operation;
+        Item.Source = Source;
+        Item.Dest = Dest;
+        Item.bOverwrite = Job.Overwrite;
+        if (Job.Operation != EAGTFileOperation::Delete)
+        {
+            PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Dest));
+        }
+        return;
+    }
+
+    FAGTDirectoryScanOptions Options;
+    TArray<FString> Files;
+    Options.bDirectories = false;
+    FAGTDirectoryScanner::Scan(Source, Options, Files);
+
+    if (Job.Operation == EAGTFileOperation::Delete)
+    {
+        for (const FString& File : Files)
+        {
+            FItem& Item = Items.AddDefaulted_GetRef();
+            Item.Operation = EAGTFileOperation::Delete;
+            Item.Source = Source / File;
+        }
+        DirectoriesToRemove.Add(Source);
+        return;
+    }
+
+    // Mirror the tree first so the workers never race on creating directories
+    TArray<FString> Directories;
+    Options.bFiles = false;
+    Options.bDirectories = true;
+    FAGTDirectoryScanner::Scan(Source, Options, Directories);
+    PlatformFile.CreateDirectoryTree(*Dest);
+    for (const FString& Directory : Directories)
+    {
+        PlatformFile.CreateDirectoryTree(*(Dest / Directory));
+    }
+
+    for (const FString& File : Files)
+    {
+        FItem& Item = Items.AddDefaulted_GetRef();
+        Item.Operation = Job.Operation;
+        Item.Source = Source / File;
+        Item.Dest = Dest / File;
+        Item.bOverwrite = Job.Overwrite;
+    }
+    if (Job.Operation == EAGTFileOperation::Move)
+    {
+        DirectoriesToRemove.Add(Source);
+    }
+}
+
+#pragma endregion
+
+#pragma region Work
+
+void FAGTBulkFileOperation::RunWorkers()
+{
+    NextItem = 0;
+    const int32 NumWorkers = FMath::Clamp(Items.Num(), 1, Concurrency);
+    ActiveWorkers = NumWorkers;
+    for (int32 Index = 0; Index < NumWorkers; ++Index)
+    {
+        Async(EAsyncExecution::ThreadPool, [Self = AsShared()]() { Self->Work(); });
+    }
+}
+
+void FAGTBulkFileOperation::Work()
+{
+    TArray<uint8> Buffer;
+    while (!bCanceled)
+    {
+        const int32 Index = NextItem++;
+        if (Index >= Items.Num())
+        {
+            break;
+        }
+        FItem& Item = Items[Index];
+        if (Item.State != EItemState::Pending)
+        {
+            continue;
+        }
+        if (ProcessItem(Item, Buffer))
+        {
+            Item.State = EItemState::Done;
+            ++FilesDone;
+        }
+        else if (!bCanceled)
+        {
+            Item.State = EItemState::Failed;
+            ++FilesFailed;
+        }
+    }
+
+    if (--ActiveWorkers == 0)
+    {
+        Finish();
+    }
+}
+
+bool FAGTBulkFileOperation::ProcessItem(FItem& Item, TArray<uint8>& Buffer)
+{
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    if (Item.Operation == EAGTFileOperation::Delete)
+    {
+        const FAGTFileChange Change(Item.Source);
+        PlatformFile.SetReadOnly(*Item.Source, false);
+        if (!PlatformFile.DeleteFile(*Item.Source))
+        {
+            AddError(FString::Printf(TEXT("Could not delete %s"), *Item.Source));
+            return false;
+        }
+        return true;
+    }
+
+    const FAGTFileChange SourceChange(Item.Source);
+    const FAGTFileChange DestChange(Item.Dest);
+    if (Item.Done == 0 && PlatformFile.FileExists(*Item.Dest))
+    {
+        const int64 DestSize = PlatformFile.FileSize(*Item.Dest);
+        if (bResume && DestSize == Item.Size)
+        {
+            // Finished by an earlier run
+            BytesDone += Item.Size;
+            return Item.Operation == EAGTFileOperation::Move ? PlatformFile.DeleteFile(*Item.Source) : true;
+        }
+        if (bResume && DestSize > 0 && DestSize < Item.Size)
+        {
+            Item.Done = DestSize;
+            BytesDone += DestSize;
+        }
+        else if (!Item.bOverwrite)
+        {
+            AddError(FString::Printf(TEXT("Destination already exists: %s"), *Item.Dest));
+            return false;
+        }
+        else
+        {
+            PlatformFile.SetReadOnly(*Item.Dest, false);
+            PlatformFile.DeleteFile(*Item.Dest);
+        }
+    }
+
+    if (Item.Operation == EAGTFileOperation::Move && Item.Done == 0 && PlatformFile.MoveFile(*Item.Dest, *Item.Source))
+    {
+        // Same volume, a rename is enough
+        BytesDone += Item.Size;
+        return true;
+    }
+    if (!CopyItem(Item, Buffer))
+    {
+        return false;
+    }
+    if (Item.Operation == EAGTFileOperation::Move && !PlatformFile.DeleteFile(*Item.Source))
+    {
+        AddError(FString::Printf(TEXT("Could not remove %s after copying it"), *Item.Source));
+        return false;
+    }
+    return true;
+}
+
+bool FAGTBulkFileOperation::CopyItem(FItem& Item, TArray<uint8>& Buffer)
+{
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    TUniquePtr<IFileHandle> Reader(PlatformFile.OpenRead(*Item.Source));
+    if (!Reader.IsValid() || (Item.Done > 0 && !Reader->Seek(Item.Done)))
+    {
+        AddError(FString::Printf(TEXT("Could not read %s"), *Item.Source));
+        return false;
+    }
+    TUniquePtr<IFileHandle> Writer(PlatformFile.OpenWrite(*Item.Dest, Item.Done > 0));
+    if (!Writer.IsValid())
+    {
+        AddError(FString::Printf(TEXT("Could not write %s"), *Item.Dest));
+        return false;
+    }
+
+    Buffer.SetNumUninitialized(static_cast<int32>(FMath::Min(ChunkSize, FMath::Max<int64>(Item.Size, 1))));
+    while (Item.Done < Item.Size)
+    {
+        if (bCanceled)
+        {
+            // The partial file stays, Done tells Resume where to continue
+            return false;
+        }
+        const int64 ToCopy = FMath::Min<int64>(Buffer.Num(), Item.Size - Item.Done);
+        if (!Reader->Read(Buffer.GetData(), ToCopy) || !Writer->Write(Buffer.GetData(), ToCopy))
+        {
+            AddError(FString::Printf(TEXT("Copy of %s failed"), *Item.Source));
+            // Start over next time, the tail of the destination cannot be trusted
+            BytesDone -= Item.Done;
+            Item.Done = 0;
+            return false;
+        }
+        Item.Done += ToCopy;
+        BytesDone += ToCopy;
+    }
+    return Writer->Flush();
+}
+
+void FAGTBulkFileOperation::Finish()
+{
+    if (!bCanceled && FilesFailed == 0)
+    {
+        IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+        for (const FString& Directory : DirectoriesToRemove)
+        {
+            const FAGTFileChange Change(Directory);
+            PlatformFile.DeleteDirectoryRecursively(*Directory);
+        }
+    }
+
+    Result = bCanceled ? EAGTFileIOResult::Canceled : (FilesFailed > 0 ? EAGTFileIOResult::Failed : EAGTFileIOResult::Success);
+    // Read before bRunning drops, after that Resume may already start the next run
+    const uint32 FinishedRun = RunId.load();
+    bRunning = false;
+    AsyncTask(ENamedThreads::GameThread,
+        [Self = AsShared(), FinishedRun]()
+        {
+            // Resume started another run before this completion got here
+            if (Self->RunId.load() != FinishedRun)
+            {
+                return;
+            }
+            if (Self->OnComplete)
+            {
+                Self->OnComplete(*Self);
+            }
+        });
+}
+
+#pragma endregion
@@ -0,0 +1,92 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AdvanceGameTools/AGTDataTypes.h"
+
+/**
+ * @class Runs a batch of copy, move and delete jobs on the thread pool.
+ * Directory jobs are expanded to single files first, then a fixed number of workers takes files off the list, so small and large files mix freely.
+ * Canceling keeps partially copied files. Resume, or a new operation with bResume set, continues them instead of starting over.
+ */
+class ADVANCEGAMETOOLS_API FAGTBulkFileOperation : public TSharedFromThis<FAGTBulkFileOperation, ESPMode::ThreadSafe>
+{
+public:
+    /** Runs on the game thread once every worker has stopped */
+    typedef TFunction<void(FAGTBulkFileOperation&)> FOnComplete;
+
+    static constexpr int64 ChunkSize = 1024 * 1024;
+
+    /** @param bInResume Skip destinations that already have the size of their source and append to shorter ones */
+    FAGTBulkFileOperation(const TArray<FAGTFileOperationJob>& InJobs, int32 InConcurrency, bool bInResume);
+
+    void Start(FOnComplete&& InOnComplete);
+
+    /** @public Workers stop after their current chunk **/
+    void Cancel() { bCanceled = true; }
+
+    /** @public Runs everything that is not done yet again. Only valid once the operation has stopped **/
+    bool Resume();
+
+    bool IsRunning() const { return bRunning; }
+    EAGTFileIOResult GetResult() const { return Result; }
+    FAGTFileOperationProgress GetProgress() const;
+    TArray<FString> GetErrors() const;
+
+private:
+    enum class EItemState : uint8
+    {
+        Pending,
+        Done,
+        Failed
+    };
+
+    struct FItem
+    {
+        EAGTFileOperation Operation{EAGTFileOperation::Copy};
+        FString Source;
+        FString Dest;
+        int64 Size{0};
+        /** Bytes already in Dest, where a copy continues from */
+        int64 Done{0};
+        bool bOverwrite{true};
+        EItemState State{EItemState::Pending};
+    };
+
+    void Expand();
+    void ExpandJob(const FAGTFileOperationJob& Job);
+    void RunWorkers();
+    void Work();
+    bool ProcessItem(FItem& Item, TArray<uint8>& Buffer);
+    bool CopyItem(FItem& Item, TArray<uint8>& Buffer);
+    void Finish();
+    void AddError(const FString& Error);
+
+    TArray<FAGTFileOperationJob> Jobs;
+    TArray<FItem> Items;
+    /** Deleted or moved directories, removed once all their files are handled */
+    TArray<FString> DirectoriesToRemove;
+    int32 Concurrency;
+    bool bResume;
+    bool bExpanded{false};
+
+    std::atomic<int32> NextItem{0};
+    std::atomic<int32> ActiveWorkers{0};
+    std::atomic<int64> BytesDone{0};
+    std::atomic<int64> BytesTotal{0};
+    std::atomic<int32> FilesDone{0};
+    std::atomic<int32> FilesTotal{0};
+    std::atomic<int32> FilesFailed{0};
+    std::atomic<bool> bCanceled{false};
+    std::atomic<bool> bRunning{false};
+    /** Bumped by Start and Resume, a completion queued by an earlier run is dropped */
+    std::atomic<uint32> RunId{0};
+    EAGTFileIOResult Result{EAGTFileIOResult::Success};
+
+    mutable FCriticalSection ErrorLock;
+    TArray<FString> Errors;
+    FOnComplete OnComplete;
+};
+
+typedef TSharedPtr<FAGTBulkFileOperation, ESPMode::ThreadSafe> FAGTBulkFileOperationPtr;
@@ -0,0 +1,100 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTChunkedExport.h"
+#include "AdvanceGameTools/Library/AGTAtomicFile.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformFileManager.h"
+
+bool FAGTChunkedExport::Run(int32 Num, FWriteChunk WriteChunk, FSink Sink, bool bParallel, int32 ChunkSize)
+{
+    ChunkSize = FMath::Max(ChunkSize, 1);
+    const int32 NumChunks = FMath::DivideAndRoundUp(Num, ChunkSize);
+
+    if (!bParallel)
+    {
+        FString Chunk;
+        for (int32 Begin = 0; Begin < Num; Begin += ChunkSize)
+        {
+            Chunk.Reset();
+            WriteChunk(Begin, FMath::Min(Begin + ChunkSize, Num), Chunk);
+            if (!Sink(Chunk))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    TArray<FString> Chunks;
+    for (int32 First = 0; First < NumChunks; First += ChunksPerBatch)
+    {
+        const int32 BatchChunks = FMath::Min(ChunksPerBatch, NumChunks - First);
+        // The buffers keep their allocation from one batch to the next
+        Chunks.SetNum(BatchChunks);
+        ParallelFor(BatchChunks,
+            [&Chunks, &WriteChunk, First, ChunkSize, Num](int32 Index)
+            {
+                const int32 Begin = (First + Index) * ChunkSize;
+                FString& Out = Chunks[Index];
+                Out.Reset();
+                WriteChunk(Begin, FMath::Min(Begin + ChunkSize, Num), Out);
+            });
+
+        for (const FString& Chunk : Chunks)
+        {
+            if (!Sink(Chunk))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool FAGTChunkedExport::ToFile(const FString& Path, TFunctionRef<bool(FSink)> Export, FString& OutError)
+{
+    // The export goes to a temp file, a failed one leaves the previous export in place
+    return FAGTAtomicFile::WriteStream(
+        Path,
+        [&Export, &OutError](IFileHandle& Handle)
+        {
+            constexpr int32 BufferSize = 256 * 1024;
+            TArray<uint8> Buffer;
+            Buffer.Reserve(BufferSize);
+            bool bWriteFailed = false;
+            auto Flush = [&Handle, &Buffer, &bWriteFailed]()
+            {
+                if (Buffer.Num() > 0 && !Handle.Write(Buffer.GetData(), Buffer.Num()))
+                {
+                    bWriteFailed = true;
+                }
+                Buffer.Reset();
+                return !bWriteFailed;
+            };
+
+            auto Sink = [&Handle, &Buffer, &Flush, &bWriteFailed](const FString& Text)
+            {
+                const FTCHARToUTF8 Utf8(*Text, Text.Len());
+                if (Buffer.Num() + Utf8.Length() > BufferSize && !Flush())
+                {
+                    return false;
+                }
+                if (Utf8.Length() >= BufferSize)
+                {
+                    // Large pieces go to the file without the copy
+                    bWriteFailed = !Handle.Write(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+                    return !bWriteFailed;
+                }
+                Buffer.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+                return true;
+            };
+
+            const bool bExported = Export(Sink);
+            if (!bExported && !bWriteFailed && OutError.IsEmpty())
+            {
+                OutError = FString("Export failed");
+            }
+            return bExported && Flush();
+        },
+        OutError);
+}
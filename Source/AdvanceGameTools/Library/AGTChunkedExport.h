@@ -0,0 +1,30 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * @class Text export in chunks.
+ * Items are split into fixed size chunks, and each finished chunk is handed to the sink in item order, so memory use does not grow with the number of items.
+ * A parallel export lets worker threads serialize a batch of chunks at a time into their own buffers and matches the serial output.
+ * It is only safe when WriteChunk may run off the game thread.
+ */
+class ADVANCEGAMETOOLS_API FAGTChunkedExport
+{
+public:
+    static constexpr int32 DefaultChunkSize = 256;
+    static constexpr int32 ChunksPerBatch = 64;
+
+    typedef TFunctionRef<void(int32 Begin, int32 End, FString& Out)> FWriteChunk;
+    typedef TFunctionRef<bool(const FString& Text)> FSink;
+
+    /**
+     * @public Serializes items [0, Num) with WriteChunk. Stops and returns false as soon as Sink does.
+     * @param bParallel Calls WriteChunk from worker threads. Otherwise every chunk is written on the calling thread
+     */
+    static bool Run(int32 Num, FWriteChunk WriteChunk, FSink Sink, bool bParallel = false, int32 ChunkSize = DefaultChunkSize);
+
+    /** @public Hands Export a sink that streams UTF-8 to Path through a small buffer. Path is only replaced once Export and every write succeeded **/
+    static bool ToFile(const FString& Path, TFunctionRef<bool(FSink)> Export, FString& OutError);
+};
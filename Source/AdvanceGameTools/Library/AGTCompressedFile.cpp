@@ -0,0 +1,336 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTCompressedFile.h"
+#include "AdvanceGameTools/Library/AGTFileHandlePool.h"
+#include "Async/ParallelFor.h"
+#include "Misc/Compression.h"
+#include <atomic>
+
+namespace AGTCompressed
+{
+template <typename T>
+static void Put(TArray<uint8>& Out, T Value)
+{
+    // Every supported platform is little endian, the value is copied as is
+    Out.Append(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+}
+
+template <typename T>
+static T Get(const uint8* Data)
+{
+    T Value;
+    FMemory::Memcpy(&Value, Data, sizeof(T));
+    return Value;
+}
+
+FName GetFormatName(EAGTCompression Codec, EAGTCompression* OutUsed)
+{
+    EAGTCompression Used = Codec;
+    FName Format = NAME_Zlib;
+    switch (Codec)
+    {
+        case EAGTCompression::LZ4: Format = NAME_LZ4; break;
+        case EAGTCompression::Oodle: Format = NAME_Oodle; break;
+        default: Format = NAME_Zlib; break;
+    }
+    if (!FCompression::IsFormatValid(Format))
+    {
+        Format = NAME_Zlib;
+        Used = EAGTCompression::Zlib;
+    }
+    if (OutUsed)
+    {
+        *OutUsed = Used;
+    }
+    return Format;
+}
+}  // namespace AGTCompressed
+
+#pragma region Writer
+
+FAGTCompressedWriter::FAGTCompressedWriter(FSink&& InSink, EAGTCompression InCodec, int32 InBlockSize)
+    : Sink(MoveTemp(InSink)), Codec(InCodec), BlockSize(FMath::Clamp(InBlockSize, AGTCompressed::MinBlockSize, AGTCompressed::MaxBlockSize))
+{
+    Format = AGTCompressed::GetFormatName(InCodec, &Codec);
+
+    TArray<uint8> Header;
+    AGTCompressed::Put<uint32>(Header, AGTCompressed::HeaderMagic);
+    AGTCompressed::Put<uint16>(Header, AGTCompressed::Version);
+    AGTCompressed::Put<uint8>(Header, static_cast<uint8>(Codec));
+    AGTCompressed::Put<uint8>(Header, 0);
+    AGTCompressed::Put<uint32>(Header, static_cast<uint32>(BlockSize));
+    WriteBytes(Header.GetData(), Header.Num());
+}
+
+bool FAGTCompressedWriter::WriteBytes(const uint8* Data, int64 Size)
+{
+    if (bFailed)
+    {
+        return false;
+    }
+    if (Size > 0 && !Sink(Data, Size))
+    {
+        bFailed = true;
+        return false;
+    }
+    Written += Size;
+    return true;
+}
+
+bool FAGTCompressedWriter::Write(const uint8* Data, int64 Size)
+{
+    if (bFailed || bFinished)
+    {
+        return false;
+    }
+    const int64 BatchSize = static_cast<int64>(BlockSize) * BlocksPerBatch;
+    while (Size > 0)
+    {
+        const int64 ToCopy = FMath::Min(Size, BatchSize - Pending.Num());
+        Pending.Append(Data, static_cast<int32>(ToCopy));
+        UncompressedSize += ToCopy;
+        Data += ToCopy;
+        Size -= ToCopy;
+        if (Pending.Num() >= BatchSize && !FlushBlocks(false))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FAGTCompressedWriter::FlushBlocks(bool bFinal)
+{
+    const int32 NumBlocks = bFinal ? FMath::DivideAndRoundUp(Pending.Num(), BlockSize) : Pending.Num() / BlockSize;
+    if (NumBlocks == 0)
+    {
+        return !bFailed;
+    }
+
+    TArray<TArray<uint8>> Blocks;
+    Blocks.SetNum(NumBlocks);
+    ParallelFor(NumBlocks,
+        [this, &Blocks](int32 Index)
+        {
+            const int32 Start = Index * BlockSize;
+            const int32 RawSize = FMath::Min(BlockSize, Pending.Num() - Start);
+            const uint8* Raw = Pending.GetData() + Start;
+
+            TArray<uint8>& Block = Blocks[Index];
+            int32 CompressedSize = FCompression::CompressMemoryBound(Format, RawSize);
+            Block.SetNumUninitialized(AGTCompressed::BlockHeaderSize + CompressedSize);
+            if (!FCompression::CompressMemory(Format, Block.GetData() + AGTCompressed::BlockHeaderSize, CompressedSize, Raw, RawSize) || CompressedSize >= RawSize)
+            {
+                // Incompressible, keep the raw bytes
+                CompressedSize = RawSize;
+                Block.SetNumUninitialized(AGTCompressed::BlockHeaderSize + RawSize, false);
+                FMemory::Memcpy(Block.GetData() + AGTCompressed::BlockHeaderSize, Raw, RawSize);
+            }
+            Block.SetNum(AGTCompressed::BlockHeaderSize + CompressedSize, false);
+            FMemory::Memcpy(Block.GetData(), &CompressedSize, sizeof(int32));
+            FMemory::Memcpy(Block.GetData() + sizeof(int32), &RawSize, sizeof(int32));
+        });
+
+    for (const TArray<uint8>& Block : Blocks)
+    {
+        Offsets.Add(static_cast<uint64>(Written));
+        if (!WriteBytes(Block.GetData(), Block.Num()))
+        {
+            return false;
+        }
+    }
+    Pending.RemoveAt(0, FMath::Min(Pending.Num(), NumBlocks * BlockSize), false);
+    return true;
+}
+
+bool FAGTCompressedWriter::Finish()
+{
+    if (bFinished)
+    {
+        return !bFailed;
+    }
+    bFinished = true;
+    if (!FlushBlocks(true))
+    {
+        return false;
+    }
+
+    TArray<uint8> Index;
+    Index.Reserve(Offsets.Num() * sizeof(uint64) + AGTCompressed::TrailerSize);
+    for (const uint64 Offset : Offsets)
+    {
+        AGTCompressed::Put<uint64>(Index, Offset);
+    }
+    AGTCompressed::Put<uint32>(Index, static_cast<uint32>(Offsets.Num()));
+    AGTCompressed::Put<uint64>(Index, static_cast<uint64>(UncompressedSize));
+    AGTCompressed::Put<uint32>(Index, AGTCompressed::TrailerMagic);
+    return WriteBytes(Index.GetData(), Index.Num());
+}
+
+#pragma endregion
+
+#pragma region Reader
+
+bool FAGTCompressedReader::Open(const FString& Path)
+{
+    Offsets.Reset();
+    UncompressedSize = 0;
+    File = FAGTFileHandlePool::Get().Acquire(Path);
+    if (!File.IsValid() || File->Size() < AGTCompressed::HeaderSize + AGTCompressed::TrailerSize)
+    {
+        File.Reset();
+        return false;
+    }
+
+    uint8 Header[AGTCompressed::HeaderSize];
+    uint8 Trailer[AGTCompressed::TrailerSize];
+    if (File->ReadAt(0, Header, AGTCompressed::HeaderSize) != AGTCompressed::HeaderSize ||
+        File->ReadAt(File->Size() - AGTCompressed::TrailerSize, Trailer, AGTCompressed::TrailerSize) != AGTCompressed::TrailerSize ||
+        AGTCompressed::Get<uint32>(Header) != AGTCompressed::HeaderMagic || AGTCompressed::Get<uint16>(Header + 4) != AGTCompressed::Version ||
+        AGTCompressed::Get<uint32>(Trailer + 12) != AGTCompressed::TrailerMagic)
+    {
+        File.Reset();
+        return false;
+    }
+
+    // Every field is checked before it sizes anything, a damaged or hostile file must not drive allocations
+    const uint8 CodecId = Header[6];
+    const EAGTCompression Codec = static_cast<EAGTCompression>(CodecId);
+    const bool bKnownCodec = CodecId <= static_cast<uint8>(EAGTCompression::Oodle);
+    EAGTCompression Used = Codec;
+    Format = bKnownCodec ? AGTCompressed::GetFormatName(Codec, &Used) : NAME_None;
+    const uint32 StoredBlockSize = AGTCompressed::Get<uint32>(Header + 8);
+    const uint32 NumBlocks = AGTCompressed::Get<uint32>(Trailer);
+    UncompressedSize = static_cast<int64>(AGTCompressed::Get<uint64>(Trailer + 4));
+
+    // Every block costs at least its header and an index entry in the file
+    const int64 Body = File->Size() - AGTCompressed::HeaderSize - AGTCompressed::TrailerSize;
+    const bool bValid = StoredBlockSize >= AGTCompressed::MinBlockSize && StoredBlockSize <= AGTCompressed::MaxBlockSize && NumBlocks <= MAX_int32 &&
+                        static_cast<int64>(NumBlocks) * (AGTCompressed::BlockHeaderSize + sizeof(uint64)) <= Body && UncompressedSize >= 0 &&
+                        FMath::DivideAndRoundUp<int64>(UncompressedSize, StoredBlockSize) == NumBlocks;
+    // A codec the engine swapped for another one could not decode the data
+    if (!bValid || !bKnownCodec || Used != Codec)
+    {
+        UE_LOG(LogTemp, Error, TEXT("FAGTCompressedReader: %s is damaged or uses a codec this build does not have"), *Path);
+        UncompressedSize = 0;
+        File.Reset();
+        return false;
+    }
+    BlockSize = static_cast<int32>(StoredBlockSize);
+    IndexOffset = File->Size() - AGTCompressed::TrailerSize - static_cast<int64>(NumBlocks) * sizeof(uint64);
+
+    Offsets.SetNumUninitialized(static_cast<int32>(NumBlocks));
+    if (File->ReadAt(IndexOffset, Offsets.GetData(), NumBlocks * sizeof(uint64)) != NumBlocks * static_cast<int64>(sizeof(uint64)))
+    {
+        Offsets.Reset();
+        UncompressedSize = 0;
+        File.Reset();
+        return false;
+    }
+    return true;
+}
+
+int64 FAGTCompressedReader::GetRawBlockSize(int32 Index) const
+{
+    return FMath::Min<int64>(BlockSize, UncompressedSize - static_cast<int64>(Index) * BlockSize);
+}
+
+bool FAGTCompressedReader::DecodeBlock(int32 Index, uint8* Dest) const
+{
+    const int64 Start = static_cast<int64>(Offsets[Index]);
+    const int64 End = Index + 1 < Offsets.Num() ? static_cast<int64>(Offsets[Index + 1]) : IndexOffset;
+    // A stored block is never larger than its raw data, so no record can be longer than a block
+    if (Start < AGTCompressed::HeaderSize || End - Start < AGTCompressed::BlockHeaderSize || End - Start > AGTCompressed::BlockHeaderSize + BlockSize || End > IndexOffset)
+    {
+        return false;
+    }
+
+    TArray<uint8> Record;
+    Record.SetNumUninitialized(static_cast<int32>(End - Start));
+    if (File->ReadAt(Start, Record.GetData(), Record.Num()) != Record.Num())
+    {
+        return false;
+    }
+    const int32 CompressedSize = AGTCompressed::Get<int32>(Record.GetData());
+    const int32 RawSize = AGTCompressed::Get<int32>(Record.GetData() + sizeof(int32));
+    if (RawSize != GetRawBlockSize(Index) || CompressedSize != Record.Num() - AGTCompressed::BlockHeaderSize || CompressedSize > RawSize)
+    {
+        return false;
+    }
+
+    const uint8* Payload = Record.GetData() + AGTCompressed::BlockHeaderSize;
+    if (CompressedSize == RawSize)
+    {
+        FMemory::Memcpy(Dest, Payload, RawSize);
+        return true;
+    }
+    return FCompression::UncompressMemory(Format, Dest, RawSize, Payload, CompressedSize);
+}
+
+bool FAGTCompressedReader::ReadBlock(int32 Index, TArray<uint8>& Out) const
+{
+    if (!File.IsValid() || !Offsets.IsValidIndex(Index))
+    {
+        return false;
+    }
+    Out.SetNumUninitialized(static_cast<int32>(GetRawBlockSize(Index)));
+    return DecodeBlock(Index, Out.GetData());
+}
+
+bool FAGTCompressedReader::Read(int64 Offset, int64 Length, TArray<uint8>& Out) const
+{
+    if (!File.IsValid() || Offset < 0 || Offset > UncompressedSize)
+    {
+        return false;
+    }
+    Length = FMath::Clamp<int64>(Length, 0, UncompressedSize - Offset);
+    if (Length > MAX_int32)
+    {
+        return false;
+    }
+    Out.SetNumUninitialized(static_cast<int32>(Length));
+    if (Length == 0)
+    {
+        return true;
+    }
+
+    const int32 First = static_cast<int32>(Offset / BlockSize);
+    const int32 Last = static_cast<int32>((Offset + Length - 1) / BlockSize);
+    std::atomic<bool> bSuccess{true};
+    ParallelFor(Last - First + 1,
+        [this, First, Offset, Length, &Out, &bSuccess](int32 Step)
+        {
+            const int32 Index = First + Step;
+            const int64 BlockStart = static_cast<int64>(Index) * BlockSize;
+            const int64 RawSize = GetRawBlockSize(Index);
+            const int64 CopyStart = FMath::Max(Offset, BlockStart);
+            const int64 CopyEnd = FMath::Min(Offset + Length, BlockStart + RawSize);
+
+            if (CopyStart == BlockStart && CopyEnd == BlockStart + RawSize)
+            {
+                // Whole block wanted, decompress straight into the output
+                if (!DecodeBlock(Index, Out.GetData() + (BlockStart - Offset)))
+                {
+                    bSuccess = false;
+                }
+                return;
+            }
+            TArray<uint8> Block;
+            Block.SetNumUninitialized(static_cast<int32>(RawSize));
+            if (!DecodeBlock(Index, Block.GetData()))
+            {
+                bSuccess = false;
+                return;
+            }
+            FMemory::Memcpy(Out.GetData() + (CopyStart - Offset), Block.GetData() + (CopyStart - BlockStart), CopyEnd - CopyStart);
+        });
+
+    if (!bSuccess)
+    {
+        Out.Reset();
+        return false;
+    }
+    return true;
+}
+
+#pragma endregion
@@ -0,0 +1,105 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AdvanceGameTools/AGTDataTypes.h"
+#include "AdvanceGameTools/Library/AGTPositionalReader.h"
+
+/**
+ * Layout of a compressed file, all values little endian:
+ * - Header: magic, version, codec, reserved byte, block size.
+ * - Blocks: compressed size, raw size, data. A block whose compressed size equals its raw size is stored as is.
+ * - Index: file offset of every block.
+ * - Trailer: block count, uncompressed size, magic.
+ * Blocks are independent, so they compress and decompress in parallel and any block can be read on its own.
+ */
+namespace AGTCompressed
+{
+static constexpr uint32 HeaderMagic = 0x5A544741;  // "AGTZ"
+static constexpr uint32 TrailerMagic = 0x46544741;  // "AGTF"
+static constexpr uint16 Version = 1;
+static constexpr int32 HeaderSize = 12;
+static constexpr int32 BlockHeaderSize = 8;
+static constexpr int32 TrailerSize = 16;
+static constexpr int32 DefaultBlockSize = 256 * 1024;
+static constexpr int32 MinBlockSize = 4096;
+static constexpr int32 MaxBlockSize = 64 * 1024 * 1024;
+
+/** Engine format of the codec. Oodle falls back to Zlib when the engine was built without it */
+ADVANCEGAMETOOLS_API FName GetFormatName(EAGTCompression Codec, EAGTCompression* OutUsed = nullptr);
+}  // namespace AGTCompressed
+
+/**
+ * @class Writes the compressed block format through a sink.
+ * Data is collected until a batch of blocks is full, the batch is compressed on the thread pool and handed to the sink in order,
+ * so memory use is bounded by the batch and not by the size of the data.
+ */
+class ADVANCEGAMETOOLS_API FAGTCompressedWriter
+{
+public:
+    typedef TFunction<bool(const uint8*, int64)> FSink;
+
+    /** Blocks compressed together in one parallel batch */
+    static constexpr int32 BlocksPerBatch = 16;
+
+    FAGTCompressedWriter(FSink&& InSink, EAGTCompression InCodec, int32 InBlockSize = AGTCompressed::DefaultBlockSize);
+
+    bool Write(const uint8* Data, int64 Size);
+
+    /** @public Compresses what is left and writes the index. Nothing can be written afterwards **/
+    bool Finish();
+
+private:
+    bool WriteBytes(const uint8* Data, int64 Size);
+
+    /** @private Compresses the pending blocks in parallel. Without bFinal a trailing partial block stays pending **/
+    bool FlushBlocks(bool bFinal);
+
+    FSink Sink;
+    FName Format;
+    EAGTCompression Codec;
+    int32 BlockSize;
+    TArray<uint8> Pending;
+    TArray<uint64> Offsets;
+    int64 Written{0};
+    int64 UncompressedSize{0};
+    bool bFailed{false};
+    bool bFinished{false};
+};
+
+/**
+ * @class Random access to a file in the compressed block format.
+ * Only the blocks overlapping a requested range are read and decompressed, in parallel. Thread safe once opened.
+ */
+class ADVANCEGAMETOOLS_API FAGTCompressedReader
+{
+public:
+    bool Open(const FString& Path);
+
+    /** @public Size of the data once decompressed **/
+    int64 Size() const { return UncompressedSize; }
+    int32 NumBlocks() const { return Offsets.Num(); }
+    int32 GetBlockSize() const { return BlockSize; }
+
+    /** @public Decompresses Length bytes at Offset, clamped to the end of the data. Resizes Out **/
+    bool Read(int64 Offset, int64 Length, TArray<uint8>& Out) const;
+
+    /** @public Decompresses the whole block Index into Out **/
+    bool ReadBlock(int32 Index, TArray<uint8>& Out) const;
+
+    bool ReadAll(TArray<uint8>& Out) const { return Read(0, UncompressedSize, Out); }
+
+private:
+    int64 GetRawBlockSize(int32 Index) const;
+
+    /** @private Reads block Index and decompresses it into Dest, which holds exactly its raw size **/
+    bool DecodeBlock(int32 Index, uint8* Dest) const;
+
+    FAGTPositionalReaderPtr File;
+    FName Format;
+    int32 BlockSize{0};
+    int64 UncompressedSize{0};
+    int64 IndexOffset{0};
+    TArray<uint64> Offsets;
+};
@@ -0,0 +1,333 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTCsvReader.h"
+#include "HAL/PlatformFileManager.h"
+
+#if PLATFORM_CPU_X86_FAMILY
+#include <emmintrin.h>
+#elif PLATFORM_CPU_ARM_FAMILY && PLATFORM_64BITS
+#include <arm_neon.h>
+#endif
+
+FAGTCsvReader::~FAGTCsvReader()
+{
+    Close();
+}
+
+bool FAGTCsvReader::Open(const FString& Path)
+{
+    Close();
+    Handle = FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Path);
+    return Handle != nullptr;
+}
+
+void FAGTCsvReader::Close()
+{
+    if (Handle)
+    {
+        delete Handle;
+        Handle = nullptr;
+    }
+}
+
+int32 FAGTCsvReader::FindAny(const uint8* Data, int32 Num, uint8 A, uint8 B, uint8 C, uint8 D)
+{
+    int32 Index = 0;
+#if PLATFORM_CPU_X86_FAMILY
+    const __m128i VA = _mm_set1_epi8(static_cast<char>(A));
+    const __m128i VB = _mm_set1_epi8(static_cast<char>(B));
+    const __m128i VC = _mm_set1_epi8(static_cast<char>(C));
+    const __m128i VD = _mm_set1_epi8(static_cast<char>(D));
+    for (; Index + 16 <= Num; Index += 16)
+    {
+        const __m128i Block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Data + Index));
+        const __m128i Hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(Block, VA), _mm_cmpeq_epi8(Block, VB)), _mm_or_si128(_mm_cmpeq_epi8(Block, VC), _mm_cmpeq_epi8(Block, VD)));
+        const uint32 Mask = static_cast<uint32>(_mm_movemask_epi8(Hits));
+        if (Mask != 0)
+        {
+            return Index + static_cast<int32>(FMath::CountTrailingZeros(Mask));
+        }
+    }
+#elif PLATFORM_CPU_ARM_FAMILY && PLATFORM_64BITS
+    const uint8x16_t VA = vdupq_n_u8(A);
+    const uint8x16_t VB = vdupq_n_u8(B);
+    const uint8x16_t VC = vdupq_n_u8(C);
+    const uint8x16_t VD = vdupq_n_u8(D);
+    for (; Index + 16 <= Num; Index += 16)
+    {
+        const uint8x16_t Block = vld1q_u8(Data + Index);
+        const uint8x16_t Hits = vorrq_u8(vorrq_u8(vceqq_u8(Block, VA), vceqq_u8(Block, VB)), vorrq_u8(vceqq_u8(Block, VC), vceqq_u8(Block, VD)));
+        if (vmaxvq_u8(Hits) != 0)
+        {
+            break;  // the scalar loop below finds the exact position inside this block
+        }
+    }
+#endif
+    for (; Index < Num; ++Index)
+    {
+        const uint8 Value = Data[Index];
+        if (Value == A || Value == B || Value == C || Value == D)
+        {
+            return Index;
+        }
+    }
+    return Num;
+}
+
+void FAGTCsvReader::EndCell()
+{
+    CellRanges.Emplace(CellStart, Scratch.Num() - CellStart);
+    Scratch.Add('\0');
+    CellStart = Scratch.Num();
+    State = EState::FieldStart;
+}
+
+bool FAGTCsvReader::EndRow(FRowCallback& Callback)
+{
+    bool bContinue = true;
+    // A line holding a single empty cell is an empty line, unless the cell was written as ""
+    const bool bEmptyLine = CellRanges.Num() == 1 && CellRanges[0].Value == 0 && !bRowQuoted;
+    if (!bEmptyLine)
+    {
+        CellViews.Reset();
+        for (const TPair<int32, int32>& Range : CellRanges)
+        {
+            CellViews.Emplace(Scratch.GetData() + Range.Key, Range.Value);
+        }
+        bContinue = Callback(RowIndex++, CellViews);
+    }
+    Scratch.Reset();
+    CellRanges.Reset();
+    CellStart = 0;
+    bRowQuoted = false;
+    return bContinue;
+}
+
+bool FAGTCsvReader::ParseChunk(const uint8* Data, int32 Num, FRowCallback& Callback)
+{
+    int32 Index = 0;
+    while (Index < Num)
+    {
+        switch (State)
+        {
+            case EState::FieldStart:
+                if (Data[Index] == '"')
+                {
+                    State = EState::Quoted;
+                    bRowQuoted = true;
+                    ++Index;
+                    break;
+                }
+                State = EState::Unquoted;
+                [[fallthrough]];
+            case EState::Unquoted:
+            {
+                const int32 Stop = Index + FindAny(Data + Index, Num - Index, Delimiter, '\n', '\r', Delimiter);
+                Scratch.Append(reinterpret_cast<const ANSICHAR*>(Data + Index), Stop - Index);
+                Index = Stop;
+                if (Index >= Num)
+                {
+                    break;
+                }
+                const uint8 Value = Data[Index++];
+                if (Value == Delimiter)
+                {
+                    EndCell();
+                }
+                else if (Value == '\n')
+                {
+                    EndCell();
+                    if (!EndRow(Callback))
+                    {
+                        return false;
+                    }
+                }
+                else if (Value == '\r')
+                {
+                    // Decided by the next byte, which may only arrive with the next chunk
+                    State = EState::CarriageReturn;
+                }
+                break;
+            }
+            case EState::CarriageReturn:
+            {
+                if (Data[Index] == '\n')
+                {
+                    // CRLF ends the row like LF
+                    ++Index;
+                    EndCell();
+                    if (!EndRow(Callback))
+                    {
+                        return false;
+                    }
+                }
+                else
+                {
+                    Scratch.Add('\r');
+                    State = EState::Unquoted;
+                }
+                break;
+            }
+            case EState::Quoted:
+            {
+                const int32 Stop = Index + FindAny(Data + Index, Num - Index, '"', '"', '"', '"');
+                Scratch.Append(reinterpret_cast<const ANSICHAR*>(Data + Index), Stop - Index);
+                Index = Stop;
+                if (Index < Num)
+                {
+                    State = EState::QuoteInQuoted;
+                    ++Index;
+                }
+                break;
+            }
+            case EState::QuoteInQuoted:
+            {
+                if (Data[Index] == '"')
+                {
+                    // Escaped quote
+                    Scratch.Add('"');
+                    State = EState::Quoted;
+                    ++Index;
+                }
+                else
+                {
+                    // Closing quote, anything up to the next delimiter is kept as is
+                    State = EState::Unquoted;
+                }
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+bool FAGTCsvReader::ForEachRow(FRowCallback Callback)
+{
+    if (!Handle)
+    {
+        return false;
+    }
+
+    State = EState::FieldStart;
+    Scratch.Reset();
+    CellRanges.Reset();
+    CellStart = 0;
+    RowIndex = 0;
+    bRowQuoted = false;
+    Chunk.SetNumUninitialized(ChunkSize);
+
+    const int64 FileSize = Handle->Size();
+    bool bFirstChunk = true;
+    for (int64 Position = 0; Position < FileSize;)
+    {
+        const int32 NumToRead = static_cast<int32>(FMath::Min<int64>(ChunkSize, FileSize - Position));
+        if (!Handle->Read(Chunk.GetData(), NumToRead))
+        {
+            return false;
+        }
+        Position += NumToRead;
+
+        int32 Skip = 0;
+        if (bFirstChunk && NumToRead >= 3 && Chunk[0] == 0xEF && Chunk[1] == 0xBB && Chunk[2] == 0xBF)
+        {
+            Skip = 3;
+        }
+        bFirstChunk = false;
+
+        if (!ParseChunk(Chunk.GetData() + Skip, NumToRead - Skip, Callback))
+        {
+            return true;
+        }
+    }
+
+    // Last row without a trailing newline. A '\r' right before the end of the file ends the row like CRLF
+    if (Scratch.Num() > 0 || CellRanges.Num() > 0 || State != EState::FieldStart)
+    {
+        EndCell();
+        EndRow(Callback);
+    }
+    return true;
+}
+
+bool FAGTCsvReader::ReadColumns(const FString& Path, const TArray<EAGTCsvColumnType>& ColumnTypes, bool bHeaderFirst, TArray<FAGTCsvColumn>& OutColumns, int32& OutRows)
+{
+    OutColumns.Reset();
+    OutRows = 0;
+
+    FAGTCsvReader Reader;
+    if (!Reader.Open(Path))
+    {
+        return false;
+    }
+
+    const int64 SizeHint = FMath::Max<int64>(FPlatformFileManager::Get().GetPlatformFile().FileSize(*Path), 0);
+    return Reader.ForEachRow(
+        [&](int32 RowIndex, TArrayView<const FAnsiStringView> Cells)
+        {
+            if (RowIndex == 0)
+            {
+                // The first row fixes the number of columns
+                OutColumns.SetNum(Cells.Num());
+                for (int32 Column = 0; Column < Cells.Num(); ++Column)
+                {
+                    FAGTCsvColumn& Out = OutColumns[Column];
+                    Out.Type = ColumnTypes.IsValidIndex(Column) ? ColumnTypes[Column] : EAGTCsvColumnType::String;
+                    if (bHeaderFirst)
+                    {
+                        const FUTF8ToTCHAR Converted(Cells[Column].GetData(), Cells[Column].Len());
+                        Out.Header = FString(Converted.Length(), Converted.Get());
+                    }
+                }
+                if (bHeaderFirst)
+                {
+                    return true;
+                }
+            }
+
+            if (OutRows == 0 && SizeHint > 0)
+            {
+                // Rough row count from the size of the first data row, so the string columns are not regrown over and over
+                int64 RowBytes = Cells.Num();
+                for (const FAnsiStringView& Cell : Cells)
+                {
+                    RowBytes += Cell.Len();
+                }
+                const int32 EstimatedRows = static_cast<int32>(FMath::Min<int64>(SizeHint / FMath::Max<int64>(RowBytes, 1), 1 << 20));
+                for (FAGTCsvColumn& Out : OutColumns)
+                {
+                    if (Out.Type == EAGTCsvColumnType::String)
+                    {
+                        Out.Strings.Reserve(EstimatedRows);
+                    }
+                }
+            }
+
+            for (int32 Column = 0; Column < OutColumns.Num(); ++Column)
+            {
+                FAGTCsvColumn& Out = OutColumns[Column];
+                const bool bHasCell = Cells.IsValidIndex(Column);
+                // Cells are NUL-terminated inside the scratch buffer, so the C parsers can read them in place
+                const ANSICHAR* Cell = bHasCell ? Cells[Column].GetData() : "";
+                const int32 CellLen = bHasCell ? Cells[Column].Len() : 0;
+                switch (Out.Type)
+                {
+                    case EAGTCsvColumnType::Int: Out.Ints.Add(FCStringAnsi::Atoi(Cell)); break;
+                    case EAGTCsvColumnType::Float: Out.Floats.Add(FCStringAnsi::Atof(Cell)); break;
+                    case EAGTCsvColumnType::Name:
+                    {
+                        const FUTF8ToTCHAR Converted(Cell, CellLen);
+                        Out.Names.Add(CellLen > 0 ? FName(Converted.Length(), Converted.Get()) : NAME_None);
+                        break;
+                    }
+                    case EAGTCsvColumnType::String:
+                    {
+                        const FUTF8ToTCHAR Converted(Cell, CellLen);
+                        Out.Strings.Emplace(Converted.Length(), Converted.Get());
+                        break;
+                    }
+                }
+            }
+            ++OutRows;
+            return true;
+        });
+}
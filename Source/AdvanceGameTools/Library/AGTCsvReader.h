@@ -0,0 +1,74 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AdvanceGameTools/AGTDataTypes.h"
+
+class IFileHandle;
+
+/**
+ * @class Streaming csv parser.
+ * Reads the file in fixed-size chunks straight from disk and scans for delimiters, quotes and newlines 16 bytes at a time.
+ * Cells are handed out as views into a reusable scratch buffer, so no string is allocated per cell.
+ * Expects UTF-8 or ANSI input; a UTF-8 BOM is skipped.
+ */
+class ADVANCEGAMETOOLS_API FAGTCsvReader
+{
+public:
+    /** Receives the index of the row and its unescaped, NUL-terminated cells. Return false to stop reading. Views are only valid during the call. */
+    typedef TFunctionRef<bool(int32 RowIndex, TArrayView<const FAnsiStringView> Cells)> FRowCallback;
+
+    static constexpr int32 ChunkSize = 256 * 1024;
+
+    explicit FAGTCsvReader(ANSICHAR InDelimiter = ',') : Delimiter(static_cast<uint8>(InDelimiter)) {}
+    ~FAGTCsvReader();
+
+    bool Open(const FString& Path);
+    void Close();
+
+    /** @public Streams every row of the file to the callback. Empty lines are skipped, a line holding only "" is a row with one empty cell **/
+    bool ForEachRow(FRowCallback Callback);
+
+    /**
+     * @public Parses a whole file into typed columns.
+     * Columns without an entry in ColumnTypes are read as strings. Missing cells get the default value of the column type.
+     */
+    static bool ReadColumns(const FString& Path, const TArray<EAGTCsvColumnType>& ColumnTypes, bool bHeaderFirst, TArray<FAGTCsvColumn>& OutColumns, int32& OutRows);
+
+    /** @public Returns the index of the first byte equal to one of A, B, C or D, or Num if there is none **/
+    static int32 FindAny(const uint8* Data, int32 Num, uint8 A, uint8 B, uint8 C, uint8 D);
+
+private:
+    /** @private Closes the current cell in the scratch buffer **/
+    void EndCell();
+
+    /** @private Closes the current row and hands it to the callback. Returns the callback result **/
+    bool EndRow(FRowCallback& Callback);
+
+    /** @private Parses one chunk, carrying the quote state over to the next one. Returns false if the callback stopped the read **/
+    bool ParseChunk(const uint8* Data, int32 Num, FRowCallback& Callback);
+
+    enum class EState : uint8
+    {
+        FieldStart,
+        Unquoted,
+        Quoted,
+        QuoteInQuoted,
+        /** A '\r' outside quotes, dropped if a '\n' follows and kept in the cell otherwise */
+        CarriageReturn
+    };
+
+    uint8 Delimiter;
+    IFileHandle* Handle{nullptr};
+    TArray<uint8> Chunk;
+
+    EState State{EState::FieldStart};
+    TArray<ANSICHAR> Scratch;
+    TArray<TPair<int32, int32>> CellRanges;
+    TArray<FAnsiStringView> CellViews;
+    int32 CellStart{0};
+    int32 RowIndex{0};
+    /** The current row has a quoted cell, so it is not empty even if every cell is */
+    bool bRowQuoted{false};
+};
@@ -0,0 +1,224 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTCsvWriter.h"
+#include "AdvanceGameTools/Library/AGTFileChange.h"
+#include "HAL/PlatformFileManager.h"
+
+FAGTCsvWriter::~FAGTCsvWriter()
+{
+    Close();
+}
+
+bool FAGTCsvWriter::Open(const FString& Path, bool bAppend)
+{
+    Close();
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Path));
+    const FAGTFileChange Change(Path);
+    FilePath = Path;
+    Handle = PlatformFile.OpenWrite(*Path, bAppend);
+    bFailed = Handle == nullptr;
+    Buffer.Reset(BufferSize);
+    return Handle != nullptr;
+}
+
+bool FAGTCsvWriter::Close()
+{
+    if (!Handle)
+    {
+        return !bFailed;
+    }
+    FlushBuffer();
+    if (!Handle->Flush())
+    {
+        bFailed = true;
+    }
+    delete Handle;
+    Handle = nullptr;
+    FAGTFileChange::Notify(FilePath);
+    return !bFailed;
+}
+
+bool FAGTCsvWriter::FlushBuffer()
+{
+    if (Buffer.Num() > 0)
+    {
+        if (!Handle->Write(Buffer.GetData(), Buffer.Num()))
+        {
+            bFailed = true;
+        }
+        Buffer.Reset();
+    }
+    return !bFailed;
+}
+
+void FAGTCsvWriter::Put(const uint8* Data, int32 Num)
+{
+    while (Num > 0)
+    {
+        const int32 Space = BufferSize - Buffer.Num();
+        if (Space == 0)
+        {
+            FlushBuffer();
+            continue;
+        }
+        const int32 ToCopy = FMath::Min(Space, Num);
+        Buffer.Append(Data, ToCopy);
+        Data += ToCopy;
+        Num -= ToCopy;
+    }
+}
+
+bool FAGTCsvWriter::WriteRow(TArrayView<const FString> Cells)
+{
+    if (!Handle || bFailed)
+    {
+        return false;
+    }
+
+    static const uint8 Quote = '"';
+    static const uint8 Comma = ',';
+    for (int32 Index = 0; Index < Cells.Num(); ++Index)
+    {
+        if (Index > 0)
+        {
+            Put(&Comma, 1);
+        }
+        Put(&Quote, 1);
+
+        // Cells are usually short, so the converter keeps them on the stack
+        const FString& Cell = Cells[Index];
+        const FTCHARToUTF8 Utf8(*Cell, Cell.Len());
+        const uint8* Start = reinterpret_cast<const uint8*>(Utf8.Get());
+        const uint8* End = Start + Utf8.Length();
+        for (const uint8* Cursor = Start; Cursor < End; ++Cursor)
+        {
+            if (*Cursor == Quote)
+            {
+                // Write up to and including the quote, the next segment starts with the same quote again
+                Put(Start, static_cast<int32>(Cursor - Start) + 1);
+                Start = Cursor;
+            }
+        }
+        Put(Start, static_cast<int32>(End - Start));
+        Put(&Quote, 1);
+    }
+
+    const ANSICHAR* Terminator = LINE_TERMINATOR_ANSI;
+    Put(reinterpret_cast<const uint8*>(Terminator), FCStringAnsi::Strlen(Terminator));
+    return !bFailed;
+}
+
+int32 FAGTCsvWriter::RowLength(TArrayView<const FString> Cells)
+{
+    int32 Length = FCString::Strlen(LINE_TERMINATOR);
+    for (const FString& Cell : Cells)
+    {
+        // Two quotes, one extra character per inner quote
+        Length += Cell.Len() + 2;
+        for (const TCHAR Char : Cell)
+        {
+            Length += Char == TEXT('"') ? 1 : 0;
+        }
+    }
+    // Separators
+    return Length + FMath::Max(Cells.Num() - 1, 0);
+}
+
+void FAGTCsvWriter::AppendRow(FString& Out, TArrayView<const FString> Cells)
+{
+    const int32 Start = Out.Len();
+    const int32 Length = RowLength(Cells);
+    TArray<TCHAR>& CharArray = Out.GetCharArray();
+    // Keep the terminating zero in place
+    CharArray.SetNumUninitialized(Start + Length + 1);
+
+    TCHAR* Dest = CharArray.GetData() + Start;
+    for (int32 Index = 0; Index < Cells.Num(); ++Index)
+    {
+        if (Index > 0)
+        {
+            *Dest++ = TEXT(',');
+        }
+        *Dest++ = TEXT('"');
+        for (const TCHAR Char : Cells[Index])
+        {
+            if (Char == TEXT('"'))
+            {
+                *Dest++ = TEXT('"');
+            }
+            *Dest++ = Char;
+        }
+        *Dest++ = TEXT('"');
+    }
+    for (const TCHAR* Terminator = LINE_TERMINATOR; *Terminator; ++Terminator)
+    {
+        *Dest++ = *Terminator;
+    }
+    *Dest = TEXT('\0');
+    check(Dest == CharArray.GetData() + Start + Length);
+}
+
+bool FAGTCsvWriter::ToString(const TArray<FString>& Headers, const TArray<FString>& Data, FString& Out, int32& Total)
+{
+    Total = 0;
+    if (Headers.Num() == 0 || Data.Num() % Headers.Num() != 0)
+    {
+        return false;
+    }
+
+    const int32 NumColumns = Headers.Num();
+    const int32 NumRows = Data.Num() / NumColumns;
+
+    // First pass only measures, so the string is allocated exactly once
+    int64 Length = RowLength(Headers);
+    for (int32 Row = 0; Row < NumRows; ++Row)
+    {
+        Length += RowLength(TArrayView<const FString>(Data.GetData() + Row * NumColumns, NumColumns));
+    }
+    if (Length >= MAX_int32)
+    {
+        return false;
+    }
+
+    Out.Reset(static_cast<int32>(Length));
+    AppendRow(Out, Headers);
+    for (int32 Row = 0; Row < NumRows; ++Row)
+    {
+        AppendRow(Out, TArrayView<const FString>(Data.GetData() + Row * NumColumns, NumColumns));
+    }
+    Total = NumRows + 1;
+    return true;
+}
+
+bool FAGTCsvWriter::ToFile(const FString& Path, const TArray<FString>& Headers, const TArray<FString>& Data, int32& Total)
+{
+    Total = 0;
+    if (Headers.Num() == 0 || Data.Num() % Headers.Num() != 0)
+    {
+        return false;
+    }
+
+    FAGTCsvWriter Writer;
+    if (!Writer.Open(Path))
+    {
+        return false;
+    }
+
+    const int32 NumColumns = Headers.Num();
+    const int32 NumRows = Data.Num() / NumColumns;
+    Writer.WriteRow(Headers);
+    for (int32 Row = 0; Row < NumRows; ++Row)
+    {
+        if (!Writer.WriteRow(TArrayView<const FString>(Data.GetData() + Row * NumColumns, NumColumns)))
+        {
+            break;
+        }
+    }
+    if (!Writer.Close())
+    {
+        return false;
+    }
+    Total = NumRows + 1;
+    return true;
+}
@@ -0,0 +1,56 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IFileHandle;
+
+/**
+ * @class Csv writer.
+ * Every cell is quoted and inner quotes are doubled, same as the library has always written csv.
+ * Rows can either be escaped into a string that is sized once up front, or streamed to disk as UTF-8 through a small write buffer.
+ */
+class ADVANCEGAMETOOLS_API FAGTCsvWriter
+{
+public:
+    static constexpr int32 BufferSize = 64 * 1024;
+
+    FAGTCsvWriter() = default;
+    ~FAGTCsvWriter();
+
+    FAGTCsvWriter(const FAGTCsvWriter&) = delete;
+    FAGTCsvWriter& operator=(const FAGTCsvWriter&) = delete;
+
+    bool Open(const FString& Path, bool bAppend = false);
+
+    /** @public Flushes the buffer and closes the file. Returns false if any write failed **/
+    bool Close();
+
+    bool IsOpen() const { return Handle != nullptr; }
+
+    /** @public Encodes and buffers one row **/
+    bool WriteRow(TArrayView<const FString> Cells);
+
+    /** @public Number of characters AppendRow adds for these cells, line terminator included **/
+    static int32 RowLength(TArrayView<const FString> Cells);
+
+    /** @public Escapes one row straight into the spare capacity of Out **/
+    static void AppendRow(FString& Out, TArrayView<const FString> Cells);
+
+    /** @public Builds the whole csv with a single allocation. Returns false if Data does not match the headers **/
+    static bool ToString(const TArray<FString>& Headers, const TArray<FString>& Data, FString& Out, int32& Total);
+
+    /** @public Streams the whole csv to disk. Memory use does not depend on the number of rows **/
+    static bool ToFile(const FString& Path, const TArray<FString>& Headers, const TArray<FString>& Data, int32& Total);
+
+private:
+    /** @private Appends raw bytes to the write buffer, flushing it when full **/
+    void Put(const uint8* Data, int32 Num);
+    bool FlushBuffer();
+
+    IFileHandle* Handle{nullptr};
+    FString FilePath;
+    TArray<uint8> Buffer;
+    bool bFailed{false};
+};
@@ -0,0 +1,464 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTDirectoryIndex.h"
+#include "HAL/PlatformFileManager.h"
+
+#if WITH_EDITOR
+#include "DirectoryWatcherModule.h"
+#include "IDirectoryWatcher.h"
+#include "Modules/ModuleManager.h"
+#elif PLATFORM_LINUX
+#include <errno.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+static TUniquePtr<FAGTDirectoryIndex> GDirectoryIndex;
+
+namespace AGTDirectoryIndex
+{
+/** Guards creation and destruction of the instance, writes on any thread report their changes through it */
+static FCriticalSection InstanceLock;
+}  // namespace AGTDirectoryIndex
+
+FAGTDirectoryIndex& FAGTDirectoryIndex::Get()
+{
+    FScopeLock ScopeLock(&AGTDirectoryIndex::InstanceLock);
+    if (!GDirectoryIndex.IsValid())
+    {
+        GDirectoryIndex = TUniquePtr<FAGTDirectoryIndex>(new FAGTDirectoryIndex());
+    }
+    return *GDirectoryIndex;
+}
+
+void FAGTDirectoryIndex::Shutdown()
+{
+    TUniquePtr<FAGTDirectoryIndex> Index;
+    {
+        FScopeLock ScopeLock(&AGTDirectoryIndex::InstanceLock);
+        Index = MoveTemp(GDirectoryIndex);
+    }
+    // Unwatches outside the lock, a watcher callback may still be reporting a change
+    Index.Reset();
+}
+
+void FAGTDirectoryIndex::NotifyChanged(const FString& Path)
+{
+    // Without an index nothing is cached, a write must not create one
+    FScopeLock InstanceScope(&AGTDirectoryIndex::InstanceLock);
+    if (!GDirectoryIndex.IsValid())
+    {
+        return;
+    }
+    FAGTDirectoryIndex& Index = *GDirectoryIndex;
+    FScopeLock ScopeLock(&Index.Lock);
+    const FString Normalized = NormalizePath(Path);
+    Index.InvalidateLocked(Normalized);
+    // The parent gained or lost an entry, its modification time moved as well
+    Index.Stats.Remove(FPaths::GetPath(Normalized));
+}
+
+FAGTDirectoryIndex::~FAGTDirectoryIndex()
+{
+    TArray<FString> Roots = WatchedRoots;
+    for (const FString& Root : Roots)
+    {
+        Unwatch(Root);
+    }
+#if !WITH_EDITOR && PLATFORM_LINUX
+    if (TickerHandle.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+    }
+    if (InotifyFd >= 0)
+    {
+        close(InotifyFd);
+    }
+#endif
+}
+
+FString FAGTDirectoryIndex::NormalizePath(const FString& Path)
+{
+    FString Result = FPaths::ConvertRelativePathToFull(Path);
+    FPaths::NormalizeFilename(Result);
+    while (Result.Len() > 1 && Result.EndsWith(TEXT("/")))
+    {
+        Result.LeftChopInline(1, false);
+    }
+    return Result;
+}
+
+#pragma region Watch
+
+bool FAGTDirectoryIndex::Watch(const FString& Root)
+{
+    const FString Normalized = NormalizePath(Root);
+    if (!FPlatformFileManager::Get().GetPlatformFile().DirectoryExists(*Normalized))
+    {
+        return false;
+    }
+    {
+        FScopeLock ScopeLock(&Lock);
+        if (WatchedRoots.Contains(Normalized))
+        {
+            return true;
+        }
+        // Anything cached before the watcher existed may already be out of date
+        InvalidateLocked(Normalized);
+    }
+
+#if WITH_EDITOR
+    FDirectoryWatcherModule& Module = FModuleManager::LoadModuleChecked<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+    IDirectoryWatcher* Watcher = Module.Get();
+    FDelegateHandle Handle;
+    if (!Watcher || !Watcher->RegisterDirectoryChangedCallback_Handle(Normalized, IDirectoryWatcher::FDirectoryChanged::CreateRaw(this, &FAGTDirectoryIndex::OnDirectoryChanged),
+                        Handle, IDirectoryWatcher::WatchOptions::IncludeDirectoryChanges))
+    {
+        return false;
+    }
+    WatcherHandles.Add(Normalized, Handle);
+#elif PLATFORM_LINUX
+    if (InotifyFd < 0)
+    {
+        InotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (InotifyFd < 0)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("FAGTDirectoryIndex: inotify_init1 failed with errno %d"), errno);
+            return false;
+        }
+        TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FAGTDirectoryIndex::PollInotify), 0.1f);
+    }
+    AddInotifyWatches(Normalized, Normalized);
+#endif
+
+#if WITH_EDITOR || PLATFORM_LINUX
+    FScopeLock ScopeLock(&Lock);
+    WatchedRoots.Add(Normalized);
+    return true;
+#else
+    // No watcher on this platform, exact queries keep going to the file system
+    return false;
+#endif
+}
+
+void FAGTDirectoryIndex::Unwatch(const FString& Root)
+{
+    const FString Normalized = NormalizePath(Root);
+    {
+        FScopeLock ScopeLock(&Lock);
+        if (WatchedRoots.Remove(Normalized) == 0)
+        {
+            return;
+        }
+    }
+
+#if WITH_EDITOR
+    FDelegateHandle Handle;
+    if (WatcherHandles.RemoveAndCopyValue(Normalized, Handle))
+    {
+        if (FDirectoryWatcherModule* Module = FModuleManager::GetModulePtr<FDirectoryWatcherModule>(TEXT("DirectoryWatcher")))
+        {
+            if (IDirectoryWatcher* Watcher = Module->Get())
+            {
+                Watcher->UnregisterDirectoryChangedCallback_Handle(Normalized, Handle);
+            }
+        }
+    }
+#elif PLATFORM_LINUX
+    TSet<int32> Owned;
+    InotifyRootWatches.RemoveAndCopyValue(Normalized, Owned);
+    for (const int32 Descriptor : Owned)
+    {
+        int32* RefCount = InotifyRefCounts.Find(Descriptor);
+        if (RefCount && --(*RefCount) > 0)
+        {
+            // Another watched root still covers this directory
+            continue;
+        }
+        inotify_rm_watch(InotifyFd, Descriptor);
+        ForgetInotifyWatch(Descriptor);
+    }
+    if (WatchedRoots.Num() == 0 && TickerHandle.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+        TickerHandle.Reset();
+        close(InotifyFd);
+        InotifyFd = -1;
+        InotifyDirectories.Reset();
+        InotifyRootWatches.Reset();
+        InotifyRefCounts.Reset();
+    }
+#endif
+}
+
+bool FAGTDirectoryIndex::IsWatched(const FString& Path) const
+{
+    FScopeLock ScopeLock(&Lock);
+    return IsWatchedLocked(NormalizePath(Path));
+}
+
+bool FAGTDirectoryIndex::IsWatchedLocked(const FString& Path) const
+{
+    for (const FString& Root : WatchedRoots)
+    {
+        if (Path.StartsWith(Root) && (Path.Len() == Root.Len() || Path[Root.Len()] == TEXT('/')))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+#if WITH_EDITOR
+void FAGTDirectoryIndex::OnDirectoryChanged(const TArray<FFileChangeData>& Changes)
+{
+    FScopeLock ScopeLock(&Lock);
+    for (const FFileChangeData& Change : Changes)
+    {
+        InvalidateLocked(NormalizePath(Change.Filename));
+    }
+}
+#elif PLATFORM_LINUX
+void FAGTDirectoryIndex::AddInotifyWatches(const FString& Root, const FString& Directory)
+{
+    constexpr uint32 Mask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+
+    // inotify is not recursive, every directory of the tree needs its own watch
+    TArray<FString> Directories;
+    Directories.Add(Directory);
+    FAGTDirectoryScanOptions Options;
+    Options.bFiles = false;
+    TArray<FString> Relative;
+    FAGTDirectoryScanner::Scan(Directory, Options, Relative);
+    for (const FString& Path : Relative)
+    {
+        Directories.Add(Directory / Path);
+    }
+
+    // Adding a directory that is already watched returns the same descriptor
+    TSet<int32>& Owned = InotifyRootWatches.FindOrAdd(Root);
+    for (const FString& Path : Directories)
+    {
+        const int32 Descriptor = inotify_add_watch(InotifyFd, TCHAR_TO_UTF8(*Path), Mask);
+        if (Descriptor < 0)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("FAGTDirectoryIndex: could not watch %s, errno %d"), *Path, errno);
+            continue;
+        }
+        InotifyDirectories.Add(Descriptor, Path);
+        bool bAlreadyOwned = false;
+        Owned.Add(Descriptor, &bAlreadyOwned);
+        if (!bAlreadyOwned)
+        {
+            ++InotifyRefCounts.FindOrAdd(Descriptor);
+        }
+    }
+}
+
+void FAGTDirectoryIndex::ForgetInotifyWatch(int32 Descriptor)
+{
+    InotifyDirectories.Remove(Descriptor);
+    InotifyRefCounts.Remove(Descriptor);
+    for (TPair<FString, TSet<int32>>& Root : InotifyRootWatches)
+    {
+        Root.Value.Remove(Descriptor);
+    }
+}
+
+bool FAGTDirectoryIndex::PollInotify(float DeltaTime)
+{
+    alignas(struct inotify_event) uint8 Buffer[16 * 1024];
+    TArray<FString> NewDirectories;
+    TArray<int32> Ignored;
+    for (;;)
+    {
+        const ssize_t NumRead = read(InotifyFd, Buffer, sizeof(Buffer));
+        if (NumRead <= 0)
+        {
+            break;
+        }
+
+        FScopeLock ScopeLock(&Lock);
+        for (ssize_t Offset = 0; Offset < NumRead;)
+        {
+            const struct inotify_event* Event = reinterpret_cast<const struct inotify_event*>(Buffer + Offset);
+            Offset += sizeof(struct inotify_event) + Event->len;
+
+            if (Event->mask & IN_Q_OVERFLOW)
+            {
+                // Events were dropped, nothing cached can be trusted anymore
+                ++Generation;
+                Stats.Reset();
+                Listings.Reset();
+                continue;
+            }
+            const FString* Directory = InotifyDirectories.Find(Event->wd);
+            if (!Directory)
+            {
+                continue;
+            }
+            const FString Path = Event->len > 0 ? *Directory / FString(UTF8_TO_TCHAR(Event->name)) : *Directory;
+            InvalidateLocked(Path);
+
+            if ((Event->mask & IN_ISDIR) && (Event->mask & (IN_CREATE | IN_MOVED_TO)))
+            {
+                NewDirectories.Add(Path);
+            }
+            if (Event->mask & IN_IGNORED)
+            {
+                Ignored.Add(Event->wd);
+            }
+        }
+    }
+
+    for (const int32 Descriptor : Ignored)
+    {
+        ForgetInotifyWatch(Descriptor);
+    }
+
+    // Watching new directories scans them, which must not block the queries on other threads
+    for (const FString& Directory : NewDirectories)
+    {
+        TArray<FString> Roots;
+        {
+            FScopeLock ScopeLock(&Lock);
+            Roots = WatchedRoots;
+        }
+        for (const FString& Root : Roots)
+        {
+            if (Directory.StartsWith(Root + TEXT("/")))
+            {
+                AddInotifyWatches(Root, Directory);
+            }
+        }
+        // Whatever was cached below it before its watch existed may have missed a change
+        Invalidate(Directory);
+    }
+    return true;
+}
+#endif
+
+#pragma endregion
+
+#pragma region Query
+
+bool FAGTDirectoryIndex::CanServe(const FString& Path, double CachedAt, EAGTCachePolicy Policy) const
+{
+    if (Policy == EAGTCachePolicy::Stale)
+    {
+        return MaxStaleAge <= 0.0 || FPlatformTime::Seconds() - CachedAt <= MaxStaleAge;
+    }
+    return IsWatchedLocked(Path);
+}
+
+bool FAGTDirectoryIndex::List(const FString& Directory, const FAGTDirectoryScanOptions& Options, TArray<FString>& OutNodes, EAGTCachePolicy Policy)
+{
+    const FString Normalized = NormalizePath(Directory);
+    const FString Key = FString::Printf(TEXT("%s|%d%d%d|%s"), *Normalized, Options.bFiles, Options.bDirectories, Options.bRecursive, *Options.Pattern);
+    uint64 ScanGeneration = 0;
+    {
+        FScopeLock ScopeLock(&Lock);
+        if (const FListing* Listing = Listings.Find(Key))
+        {
+            if (CanServe(Normalized, Listing->CachedAt, Policy))
+            {
+                OutNodes.Append(Listing->Nodes);
+                return true;
+            }
+        }
+        ScanGeneration = Generation;
+    }
+
+    FListing Listing;
+    Listing.Directory = Normalized;
+    Listing.bRecursive = Options.bRecursive;
+    Listing.CachedAt = FPlatformTime::Seconds();
+    if (!FAGTDirectoryScanner::Scan(Normalized, Options, Listing.Nodes))
+    {
+        return false;
+    }
+    OutNodes.Append(Listing.Nodes);
+
+    FScopeLock ScopeLock(&Lock);
+    // An invalidation during the scan may cover changes the scan missed
+    if (Generation == ScanGeneration)
+    {
+        Listings.Add(Key, MoveTemp(Listing));
+    }
+    return true;
+}
+
+FFileStatData FAGTDirectoryIndex::GetStat(const FString& Path, EAGTCachePolicy Policy)
+{
+    const FString Normalized = NormalizePath(Path);
+    uint64 StatGeneration = 0;
+    {
+        FScopeLock ScopeLock(&Lock);
+        if (const FStat* Stat = Stats.Find(Normalized))
+        {
+            if (CanServe(Normalized, Stat->CachedAt, Policy))
+            {
+                return Stat->Data;
+            }
+        }
+        StatGeneration = Generation;
+    }
+
+    // One stat call answers IsFile, IsDirectory and GetFileSize together
+    FStat Stat;
+    Stat.Data = FPlatformFileManager::Get().GetPlatformFile().GetStatData(*Normalized);
+    Stat.CachedAt = FPlatformTime::Seconds();
+
+    FScopeLock ScopeLock(&Lock);
+    if (Generation == StatGeneration)
+    {
+        Stats.Add(Normalized, Stat);
+    }
+    return Stat.Data;
+}
+
+#pragma endregion
+
+#pragma region Invalidate
+
+void FAGTDirectoryIndex::Invalidate(const FString& Path)
+{
+    FScopeLock ScopeLock(&Lock);
+    InvalidateLocked(NormalizePath(Path));
+}
+
+void FAGTDirectoryIndex::InvalidateAll()
+{
+    FScopeLock ScopeLock(&Lock);
+    ++Generation;
+    Stats.Reset();
+    Listings.Reset();
+}
+
+void FAGTDirectoryIndex::InvalidateLocked(const FString& Path)
+{
+    ++Generation;
+    const FString Prefix = Path + TEXT("/");
+    for (auto It = Stats.CreateIterator(); It; ++It)
+    {
+        if (It.Key() == Path || It.Key().StartsWith(Prefix))
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    const FString Parent = FPaths::GetPath(Path);
+    for (auto It = Listings.CreateIterator(); It; ++It)
+    {
+        const FListing& Listing = It.Value();
+        // The listing contains the path, or the listed directory itself changed
+        const bool bContains = Listing.bRecursive ? Path.StartsWith(Listing.Directory + TEXT("/")) : Parent == Listing.Directory;
+        const bool bInside = Listing.Directory == Path || Listing.Directory.StartsWith(Prefix);
+        if (bContains || bInside)
+        {
+            It.RemoveCurrent();
+        }
+    }
+}
+
+#pragma endregion
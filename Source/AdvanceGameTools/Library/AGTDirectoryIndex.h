@@ -0,0 +1,90 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "AdvanceGameTools/AGTDataTypes.h"
+#include "AdvanceGameTools/Library/AGTDirectoryScanner.h"
+
+struct FFileChangeData;
+
+/**
+ * @class In-memory index of directory listings and file stats.
+ * Watched roots are kept current by the editor directory watcher, or by inotify in Linux builds without the editor.
+ * Change events arrive asynchronously, so an exact answer may lag the disk by the latency of the watcher.
+ * Queries are thread safe, Watch and Unwatch belong on the game thread.
+ */
+class ADVANCEGAMETOOLS_API FAGTDirectoryIndex
+{
+public:
+    static FAGTDirectoryIndex& Get();
+    static void Shutdown();
+
+    /** @public Called after the library wrote, moved or deleted Path. Drops the path and the stat of its parent, if an index exists **/
+    static void NotifyChanged(const FString& Path);
+
+    ~FAGTDirectoryIndex();
+
+    /** @public Starts watching a root so queries below it can be answered exactly from memory **/
+    bool Watch(const FString& Root);
+    void Unwatch(const FString& Root);
+    bool IsWatched(const FString& Path) const;
+
+    bool List(const FString& Directory, const FAGTDirectoryScanOptions& Options, TArray<FString>& OutNodes, EAGTCachePolicy Policy);
+    FFileStatData GetStat(const FString& Path, EAGTCachePolicy Policy);
+
+    /** @public Drops everything cached for a path, its children and the listings that contain it **/
+    void Invalidate(const FString& Path);
+    void InvalidateAll();
+
+    /** @public Oldest entry a stale query may return, in seconds. 0 keeps entries until they are invalidated **/
+    void SetMaxStaleAge(double Seconds) { MaxStaleAge = Seconds; }
+
+    static FString NormalizePath(const FString& Path);
+
+private:
+    FAGTDirectoryIndex() = default;
+
+    struct FListing
+    {
+        FString Directory;
+        bool bRecursive{false};
+        TArray<FString> Nodes;
+        double CachedAt{0.0};
+    };
+
+    struct FStat
+    {
+        FFileStatData Data;
+        double CachedAt{0.0};
+    };
+
+    /** @private Caller holds the lock **/
+    bool CanServe(const FString& Path, double CachedAt, EAGTCachePolicy Policy) const;
+    bool IsWatchedLocked(const FString& Path) const;
+    void InvalidateLocked(const FString& Path);
+
+    mutable FCriticalSection Lock;
+    TMap<FString, FStat> Stats;
+    TMap<FString, FListing> Listings;
+    TArray<FString> WatchedRoots;
+    double MaxStaleAge{0.0};
+    /** Bumped by every invalidation. A scan that saw it change while the lock was released does not cache its result */
+    uint64 Generation{0};
+
+#if WITH_EDITOR
+    void OnDirectoryChanged(const TArray<FFileChangeData>& Changes);
+    TMap<FString, FDelegateHandle> WatcherHandles;
+#elif PLATFORM_LINUX
+    void AddInotifyWatches(const FString& Root, const FString& Directory);
+    void ForgetInotifyWatch(int32 Descriptor);
+    bool PollInotify(float DeltaTime);
+    int32 InotifyFd{-1};
+    TMap<int32, FString> InotifyDirectories;
+    /** Descriptors each root asked for. Nested roots share descriptors, one is only removed with the last root that uses it */
+    TMap<FString, TSet<int32>> InotifyRootWatches;
+    TMap<int32, int32> InotifyRefCounts;
+    FTSTicker::FDelegateHandle TickerHandle;
+#endif
+};
@@ -0,0 +1,238 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTDirectoryScanner.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformFileManager.h"
+#include "Internationalization/Regex.h"
+#include <atomic>
+
+namespace AGTDirectoryScan
+{
+/** A directory still to be listed, with its path relative to the root */
+struct FDirectory
+{
+    FString Path;
+    FString Relative;
+};
+
+/** Directories waiting to be listed by one worker. The owner works from the back, thieves take from the front */
+struct FWorkQueue
+{
+    FCriticalSection Lock;
+    TArray<FDirectory> Directories;
+
+    void Push(FDirectory&& Directory)
+    {
+        FScopeLock ScopeLock(&Lock);
+        Directories.Add(MoveTemp(Directory));
+    }
+
+    bool PopBack(FDirectory& OutDirectory)
+    {
+        FScopeLock ScopeLock(&Lock);
+        if (Directories.Num() == 0)
+        {
+            return false;
+        }
+        OutDirectory = Directories.Pop(false);
+        return true;
+    }
+
+    bool StealFront(FDirectory& OutDirectory)
+    {
+        FScopeLock ScopeLock(&Lock);
+        if (Directories.Num() == 0)
+        {
+            return false;
+        }
+        OutDirectory = MoveTemp(Directories[0]);
+        Directories.RemoveAt(0, 1, false);
+        return true;
+    }
+};
+
+/** Receives the index of the worker that found the entry */
+typedef TFunctionRef<void(int32 WorkerIndex, FStringView RelativePath, bool bIsDirectory)> FOnWorkerEntry;
+
+class FScan
+{
+public:
+    /** Failed steal attempts in a row before an idle worker gives its task-graph thread back */
+    static constexpr int32 MaxIdleRounds = 256;
+
+    FScan(const FString& InRoot, const FAGTDirectoryScanOptions& InOptions) : Root(InRoot), Options(InOptions), Pattern(InOptions.Pattern)
+    {
+        // A drive root keeps its slash, "C:" alone is relative to the current directory of that drive
+        while (Root.Len() > 1 && (Root.EndsWith(TEXT("/")) || Root.EndsWith(TEXT("\\"))) && Root[Root.Len() - 2] != TEXT(':'))
+        {
+            Root.LeftChopInline(1, false);
+        }
+        NumWorkers = Options.bRecursive ? FMath::Max(1, Options.NumWorkers > 0 ? Options.NumWorkers : FTaskGraphInterface::Get().GetNumWorkerThreads() + 1) : 1;
+    }
+
+    /** False if a directory could not be listed, the results are then incomplete */
+    bool IsComplete() const { return bComplete.load(); }
+
+    int32 GetNumWorkers() const { return NumWorkers; }
+
+    void Run(FOnWorkerEntry OnEntry)
+    {
+        if (!Options.bRecursive)
+        {
+            ListDirectory({Root, FString()}, 0, false, OnEntry);
+            return;
+        }
+
+        Queues.SetNum(NumWorkers);
+        for (int32 Index = 0; Index < NumWorkers; ++Index)
+        {
+            Queues[Index] = MakeUnique<FWorkQueue>();
+        }
+        Pending = 1;
+        Queues[0]->Push({Root, FString()});
+
+        ParallelFor(NumWorkers, [this, &OnEntry](int32 WorkerIndex) { Work(WorkerIndex, OnEntry); });
+    }
+
+private:
+    void Work(int32 WorkerIndex, FOnWorkerEntry& OnEntry)
+    {
+        FDirectory Directory;
+        int32 IdleRounds = 0;
+        while (Pending.load() > 0)
+        {
+            if (!TakeWork(WorkerIndex, Directory))
+            {
+                // Everything pending is being listed by other workers, and each of them drains what it pushes itself.
+                // A worker that finds nothing to steal for a while leaves instead of holding a task-graph thread until the scan ends
+                if (++IdleRounds > MaxIdleRounds)
+                {
+                    return;
+                }
+                FPlatformProcess::Yield();
+                continue;
+            }
+
+            IdleRounds = 0;
+            ListDirectory(Directory, WorkerIndex, true, OnEntry);
+            --Pending;
+        }
+    }
+
+    bool TakeWork(int32 WorkerIndex, FDirectory& OutDirectory) { return Queues[WorkerIndex]->PopBack(OutDirectory) || Steal(WorkerIndex, OutDirectory); }
+
+    bool Steal(int32 WorkerIndex, FDirectory& OutDirectory)
+    {
+        for (int32 Offset = 1; Offset < Queues.Num(); ++Offset)
+        {
+            if (Queues[(WorkerIndex + Offset) % Queues.Num()]->StealFront(OutDirectory))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ListDirectory(const FDirectory& Directory, int32 WorkerIndex, bool bDescend, FOnWorkerEntry& OnEntry)
+    {
+        IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+        // The relative path is the parent's plus the entry name, whatever form of the root the platform file hands back
+        FString Relative = Directory.Relative;
+        if (!Relative.IsEmpty())
+        {
+            Relative.AppendChar(TEXT('/'));
+        }
+        const int32 PrefixLen = Relative.Len();
+        const bool bListed = PlatformFile.IterateDirectory(*Directory.Path,
+            [this, WorkerIndex, bDescend, &OnEntry, &Relative, PrefixLen](const TCHAR* FilenameOrDirectory, bool bIsDirectory)
+            {
+                FStringView Name(FilenameOrDirectory);
+                int32 Separator = INDEX_NONE;
+                if (Name.FindLastCharByPredicate([](TCHAR Char) { return Char == TEXT('/') || Char == TEXT('\\'); }, Separator))
+                {
+                    Name.RightChopInline(Separator + 1);
+                }
+                Relative.LeftInline(PrefixLen, false);
+                Relative.Append(Name.GetData(), Name.Len());
+
+                if (bIsDirectory && bDescend)
+                {
+                    // Counted before it is visible to the other workers, so nobody sees zero pending work too early
+                    ++Pending;
+                    Queues[WorkerIndex]->Push({FString(FilenameOrDirectory), Relative});
+                }
+                if ((bIsDirectory && Options.bDirectories) || (!bIsDirectory && Options.bFiles))
+                {
+                    if (Options.Pattern.IsEmpty() || Matches(Relative))
+                    {
+                        OnEntry(WorkerIndex, Relative, bIsDirectory);
+                    }
+                }
+                return true;
+            });
+        if (!bListed)
+        {
+            bComplete = false;
+        }
+    }
+
+    bool Matches(FStringView Relative) const
+    {
+        FRegexMatcher Matcher(Pattern, FString(Relative));
+        return Matcher.FindNext();
+    }
+
+    FString Root;
+    const FAGTDirectoryScanOptions& Options;
+    const FRegexPattern Pattern;
+    int32 NumWorkers{1};
+    TArray<TUniquePtr<FWorkQueue>> Queues;
+    std::atomic<int32> Pending{0};
+    std::atomic<bool> bComplete{true};
+};
+}  // namespace AGTDirectoryScan
+
+bool FAGTDirectoryScanner::Scan(const FString& Root, const FAGTDirectoryScanOptions& Options, FOnEntry OnEntry)
+{
+    if (!FPlatformFileManager::Get().GetPlatformFile().DirectoryExists(*Root))
+    {
+        return false;
+    }
+    if (!Options.bFiles && !Options.bDirectories)
+    {
+        return true;
+    }
+    AGTDirectoryScan::FScan Scan(Root, Options);
+    Scan.Run([&OnEntry](int32 WorkerIndex, FStringView RelativePath, bool bIsDirectory) { OnEntry(RelativePath, bIsDirectory); });
+    return Scan.IsComplete();
+}
+
+bool FAGTDirectoryScanner::Scan(const FString& Root, const FAGTDirectoryScanOptions& Options, TArray<FString>& OutPaths)
+{
+    if (!FPlatformFileManager::Get().GetPlatformFile().DirectoryExists(*Root))
+    {
+        return false;
+    }
+    if (!Options.bFiles && !Options.bDirectories)
+    {
+        return true;
+    }
+
+    // One bucket per worker, so collecting never waits on a shared lock
+    AGTDirectoryScan::FScan Scan(Root, Options);
+    TArray<TArray<FString>> Buckets;
+    Buckets.SetNum(Scan.GetNumWorkers());
+    Scan.Run([&Buckets](int32 WorkerIndex, FStringView RelativePath, bool bIsDirectory) { Buckets[WorkerIndex].Emplace(RelativePath); });
+
+    int32 NumPaths = OutPaths.Num();
+    for (const TArray<FString>& Bucket : Buckets)
+    {
+        NumPaths += Bucket.Num();
+    }
+    OutPaths.Reserve(NumPaths);
+    for (TArray<FString>& Bucket : Buckets)
+    {
+        OutPaths.Append(MoveTemp(Bucket));
+    }
+    return Scan.IsComplete();
+}
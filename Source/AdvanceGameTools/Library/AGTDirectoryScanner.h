@@ -0,0 +1,36 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** @struct What a directory scan should report **/
+struct FAGTDirectoryScanOptions
+{
+    /** Regex matched against the path relative to the root. Empty matches everything */
+    FString Pattern;
+    bool bFiles{true};
+    bool bDirectories{true};
+    bool bRecursive{true};
+    /** Number of workers for recursive scans, 0 picks one per worker thread */
+    int32 NumWorkers{0};
+};
+
+/**
+ * @class Recursive directory scanner.
+ * Every worker owns a queue of directories it still has to list. Subdirectories are pushed to the local queue and workers that run dry steal from the others,
+ * so deep and wide trees are spread evenly. Results are kept per worker and only merged at the end.
+ * The order of the results is not defined.
+ */
+class ADVANCEGAMETOOLS_API FAGTDirectoryScanner
+{
+public:
+    /** Receives the path relative to the root. Called from several worker threads at once */
+    typedef TFunctionRef<void(FStringView RelativePath, bool bIsDirectory)> FOnEntry;
+
+    /** @public Collects every matching entry below Root. Returns false if Root does not exist or a directory below it could not be listed **/
+    static bool Scan(const FString& Root, const FAGTDirectoryScanOptions& Options, TArray<FString>& OutPaths);
+
+    /** @public Streams matching entries to the callback while the scan is still running **/
+    static bool Scan(const FString& Root, const FAGTDirectoryScanOptions& Options, FOnEntry OnEntry);
+};
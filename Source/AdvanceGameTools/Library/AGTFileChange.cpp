@@ -0,0 +1,22 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTFileChange.h"
+#include "AdvanceGameTools/Library/AGTDirectoryIndex.h"
+#include "AdvanceGameTools/Library/AGTFileHandlePool.h"
+
+FAGTFileChange::FAGTFileChange(const FString& InPath)
+    : Path(InPath)
+{
+    FAGTFileHandlePool::Get().Invalidate(Path);
+}
+
+FAGTFileChange::~FAGTFileChange()
+{
+    Notify(Path);
+}
+
+void FAGTFileChange::Notify(const FString& Path)
+{
+    FAGTFileHandlePool::Get().Invalidate(Path);
+    FAGTDirectoryIndex::NotifyChanged(Path);
+}
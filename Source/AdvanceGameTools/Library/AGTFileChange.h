@@ -0,0 +1,27 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * @class Scope around a write, move or delete made by the library.
+ * Construction closes the pooled readers of the path, so on Windows the change does not run into a sharing violation.
+ * Destruction drops them again, a reader opened while the change was under way may hold the old file,
+ * and invalidates the path and its parent directory in the directory index, so an exact query never sees the old state.
+ */
+class ADVANCEGAMETOOLS_API FAGTFileChange
+{
+public:
+    explicit FAGTFileChange(const FString& InPath);
+    ~FAGTFileChange();
+
+    FAGTFileChange(const FAGTFileChange&) = delete;
+    FAGTFileChange& operator=(const FAGTFileChange&) = delete;
+
+    /** @public For changes that have no scope of their own, such as a handle opened for write **/
+    static void Notify(const FString& Path);
+
+private:
+    FString Path;
+};
@@ -0,0 +1,155 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTFileHandlePool.h"
+#include "HAL/PlatformFileManager.h"
+
+FAGTFileHandlePool& FAGTFileHandlePool::Get()
+{
+    // Never destroyed before exit, a worker still holding the reference after Shutdown finds an empty pool instead of freed memory
+    static FAGTFileHandlePool Pool;
+    return Pool;
+}
+
+void FAGTFileHandlePool::Startup()
+{
+    FAGTFileHandlePool& Pool = Get();
+    FScopeLock ScopeLock(&Pool.Lock);
+    Pool.bShutDown = false;
+}
+
+void FAGTFileHandlePool::Shutdown()
+{
+    FAGTFileHandlePool& Pool = Get();
+    FScopeLock ScopeLock(&Pool.Lock);
+    Pool.bShutDown = true;
+    Pool.Entries.Empty();
+}
+
+FString FAGTFileHandlePool::MakeKey(const FString& Path)
+{
+    // One entry per file however callers spell its path
+    FString Key = FPaths::ConvertRelativePathToFull(Path);
+    FPaths::NormalizeFilename(Key);
+    FPaths::RemoveDuplicateSlashes(Key);
+    return Key;
+}
+
+FAGTPositionalReaderPtr FAGTFileHandlePool::Acquire(const FString& Path)
+{
+    const FString Key = MakeKey(Path);
+    FAGTPositionalReaderPtr Pooled;
+    {
+        FScopeLock ScopeLock(&Lock);
+        if (const FEntry* Entry = Entries.Find(Key))
+        {
+            Pooled = Entry->Reader;
+        }
+    }
+
+    if (Pooled.IsValid())
+    {
+        // Size, full precision modification time and file id, a file replaced within one timestamp tick still gets a new id
+        FAGTFileIdentity Current;
+        const bool bSameFile = Pooled->ReadPathIdentity(Current) && Current == Pooled->GetOpenIdentity();
+        FScopeLock ScopeLock(&Lock);
+        FEntry* Entry = Entries.Find(Key);
+        if (Entry && Entry->Reader == Pooled)
+        {
+            if (bSameFile)
+            {
+                Entry->LastUse = ++UseCounter;
+                ++Hits;
+                return Pooled;
+            }
+            // Changed since it was opened, the old descriptor may point at a replaced file
+            Entries.Remove(Key);
+        }
+    }
+    ++Misses;
+
+    // Opened outside the lock so a slow open does not stall every other caller. Open fails for directories
+    FAGTPositionalReaderPtr Reader = MakeShared<FAGTPositionalReader, ESPMode::ThreadSafe>();
+    if (!Reader->Open(Path))
+    {
+        return nullptr;
+    }
+
+    FScopeLock ScopeLock(&Lock);
+    if (bShutDown)
+    {
+        return Reader;
+    }
+    FEntry& Entry = Entries.FindOrAdd(Key);
+    Entry.Reader = Reader;
+    Entry.LastUse = ++UseCounter;
+    Trim();
+    return Reader;
+}
+
+void FAGTFileHandlePool::Invalidate(const FString& Path)
+{
+    const FString Key = MakeKey(Path);
+    const FString Prefix = Key.EndsWith(TEXT("/")) ? Key : Key + TEXT("/");
+    FScopeLock ScopeLock(&Lock);
+    Entries.Remove(Key);
+    // A directory that is moved or deleted takes every file below it along
+    for (auto It = Entries.CreateIterator(); It; ++It)
+    {
+        if (It->Key.StartsWith(Prefix))
+        {
+            It.RemoveCurrent();
+        }
+    }
+}
+
+void FAGTFileHandlePool::Empty()
+{
+    FScopeLock ScopeLock(&Lock);
+    for (auto It = Entries.CreateIterator(); It; ++It)
+    {
+        if (It->Value.Reader.IsUnique())
+        {
+            It.RemoveCurrent();
+        }
+    }
+}
+
+void FAGTFileHandlePool::SetMaxOpen(int32 InMaxOpen)
+{
+    FScopeLock ScopeLock(&Lock);
+    MaxOpen = FMath::Max(InMaxOpen, 0);
+    Trim();
+}
+
+int32 FAGTFileHandlePool::NumOpen() const
+{
+    FScopeLock ScopeLock(&Lock);
+    return Entries.Num();
+}
+
+void FAGTFileHandlePool::Trim()
+{
+    while (Entries.Num() > MaxOpen)
+    {
+        const FString* Oldest = nullptr;
+        const FString* OldestIdle = nullptr;
+        uint64 OldestUse = MAX_uint64;
+        uint64 OldestIdleUse = MAX_uint64;
+        for (const TPair<FString, FEntry>& Pair : Entries)
+        {
+            if (Pair.Value.LastUse < OldestUse)
+            {
+                Oldest = &Pair.Key;
+                OldestUse = Pair.Value.LastUse;
+            }
+            if (Pair.Value.Reader.IsUnique() && Pair.Value.LastUse < OldestIdleUse)
+            {
+                OldestIdle = &Pair.Key;
+                OldestIdleUse = Pair.Value.LastUse;
+            }
+        }
+        // A reader still in use only leaves the pool, it is closed once its users are done
+        const FString Key = OldestIdle ? *OldestIdle : *Oldest;
+        Entries.Remove(Key);
+    }
+}
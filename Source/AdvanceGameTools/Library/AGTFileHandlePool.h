@@ -0,0 +1,65 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AdvanceGameTools/Library/AGTPositionalReader.h"
+#include <atomic>
+
+/**
+ * @class Shared pool of open read-only files keyed by path.
+ * Acquire hands out a positional reader, so any number of callers and threads can use the same descriptor at once.
+ * The shared pointer is the reference count: an evicted reader stays open until its last user lets go.
+ * Before a pooled reader is reused, one stat call checks that size, modification time and file id still match, otherwise the file is reopened.
+ * The pool itself lives until the process exits. After Shutdown it closes what it holds and Acquire hands out readers without keeping them.
+ */
+class ADVANCEGAMETOOLS_API FAGTFileHandlePool
+{
+public:
+    /** Number of files kept open when no limit was set */
+    static constexpr int32 DefaultMaxOpen = 64;
+
+    /** @public Always valid, also on worker threads that outlive the module **/
+    static FAGTFileHandlePool& Get();
+    static void Startup();
+    static void Shutdown();
+
+    /** @public Returns an open reader for the file, or null if it cannot be opened. Thread safe **/
+    FAGTPositionalReaderPtr Acquire(const FString& Path);
+
+    /** @public Drops the pooled readers of a file or a directory tree that is about to change. Every library write, move and delete calls it **/
+    void Invalidate(const FString& Path);
+
+    /** @public Closes every pooled file that nobody holds **/
+    void Empty();
+
+    void SetMaxOpen(int32 InMaxOpen);
+
+    /** @public Acquires served by an already open file **/
+    int64 GetHits() const { return Hits.load(std::memory_order_relaxed); }
+
+    /** @public Acquires that had to open the file **/
+    int64 GetMisses() const { return Misses.load(std::memory_order_relaxed); }
+
+    int32 NumOpen() const;
+
+private:
+    struct FEntry
+    {
+        FAGTPositionalReaderPtr Reader;
+        uint64 LastUse{0};
+    };
+
+    static FString MakeKey(const FString& Path);
+
+    /** @private Removes the least recently used entries until the limit is met, idle ones first. Lock must be held **/
+    void Trim();
+
+    TMap<FString, FEntry> Entries;
+    int32 MaxOpen{DefaultMaxOpen};
+    uint64 UseCounter{0};
+    bool bShutDown{false};
+    std::atomic<int64> Hits{0};
+    std::atomic<int64> Misses{0};
+    mutable FCriticalSection Lock;
+};
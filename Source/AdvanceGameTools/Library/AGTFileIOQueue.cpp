@@ -0,0 +1,489 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTFileIOQueue.h"
+#include "AdvanceGameTools/Library/AdvanceGameToolLibrary.h"
+#include "AdvanceGameTools/Library/AGTCsvWriter.h"
+#include "AdvanceGameTools/Library/AGTFileChange.h"
+#include "Async/Async.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/FileHelper.h"
+
+static TUniquePtr<FAGTFileIOQueue> GFileIOQueue;
+
+namespace AGTFileIO
+{
+/** Guards creating and destroying the queue, the first Get may come from any thread */
+static FCriticalSection InstanceLock;
+
+/** Set while the module shuts down, the task graph may already be gone so completions are dropped instead of dispatched */
+static std::atomic<bool> bDropCompletions{false};
+
+/** Same checks as the synchronous Save* functions of the library */
+static bool CanSave(const FString& Path, bool bAppend, bool bForce, FString& Error)
+{
+    FText ErrorFilename;
+    if (!FFileHelper::IsFilenameValidForSaving(Path, ErrorFilename))
+    {
+        Error = FString("Filename is not valid");
+        return false;
+    }
+    if (FPlatformFileManager::Get().GetPlatformFile().FileExists(*Path) && !bAppend && !bForce)
+    {
+        Error = FString("File already exists");
+        return false;
+    }
+    return true;
+}
+
+void EncodeText(const FString& Text, TArray<uint8>& OutBytes)
+{
+    if (FCString::IsPureAnsi(*Text))
+    {
+        const FTCHARToUTF8 Ansi(*Text, Text.Len());
+        OutBytes.Append(reinterpret_cast<const uint8*>(Ansi.Get()), Ansi.Length());
+        return;
+    }
+    const FTCHARToUTF16 Wide(*Text, Text.Len());
+    OutBytes.Reserve(2 + Wide.Length() * sizeof(UTF16CHAR));
+    OutBytes.Add(0xFF);
+    OutBytes.Add(0xFE);
+    OutBytes.Append(reinterpret_cast<const uint8*>(Wide.Get()), Wide.Length() * sizeof(UTF16CHAR));
+}
+}  // namespace AGTFileIO
+
+#pragma region Request
+
+FAGTFileIORequest::FAGTFileIORequest(EAGTFileIOPriority InPriority, FWork&& InWork, FOnComplete&& InOnComplete)
+    : Priority(InPriority), Work(MoveTemp(InWork)), OnComplete(MoveTemp(InOnComplete))
+{
+    Future = Promise.GetFuture().Share();
+}
+
+float FAGTFileIORequest::GetProgress() const
+{
+    if (bDone)
+    {
+        return 1.0f;
+    }
+    const int64 Total = GetBytesTotal();
+    return Total > 0 ? static_cast<float>(static_cast<double>(GetBytesDone()) / Total) : 0.0f;
+}
+
+void FAGTFileIORequest::ReportProgress(int64 Done, int64 Total)
+{
+    BytesTotal.store(Total, std::memory_order_relaxed);
+    BytesDone.store(Done, std::memory_order_relaxed);
+}
+
+void FAGTFileIORequest::Execute()
+{
+    if (bCanceled)
+    {
+        Finish(EAGTFileIOResult::Canceled);
+        return;
+    }
+    const EAGTFileIOResult WorkResult = Work ? Work(*this) : EAGTFileIOResult::Failed;
+    Finish(bCanceled ? EAGTFileIOResult::Canceled : WorkResult);
+}
+
+void FAGTFileIORequest::Finish(EAGTFileIOResult InResult)
+{
+    Result = InResult;
+    // Release whatever the work function captured, the payload holds the output
+    Work = nullptr;
+    bDone = true;
+    Promise.SetValue(InResult);
+
+    if (OnComplete && AGTFileIO::bDropCompletions.load())
+    {
+        OnComplete = nullptr;
+    }
+    else if (OnComplete)
+    {
+        AsyncTask(ENamedThreads::GameThread,
+            [Self = AsShared()]()
+            {
+                Self->OnComplete(*Self);
+                Self->OnComplete = nullptr;
+            });
+    }
+}
+
+#pragma endregion
+
+#pragma region Queue
+
+void FAGTFileIOQueue::Startup()
+{
+    AGTFileIO::bDropCompletions = false;
+    Get();
+}
+
+FAGTFileIOQueue& FAGTFileIOQueue::Get()
+{
+    FScopeLock ScopeLock(&AGTFileIO::InstanceLock);
+    if (!GFileIOQueue.IsValid())
+    {
+        GFileIOQueue = TUniquePtr<FAGTFileIOQueue>(new FAGTFileIOQueue());
+    }
+    return *GFileIOQueue;
+}
+
+void FAGTFileIOQueue::Shutdown()
+{
+    AGTFileIO::bDropCompletions = true;
+    TUniquePtr<FAGTFileIOQueue> Queue;
+    {
+        FScopeLock ScopeLock(&AGTFileIO::InstanceLock);
+        Queue = MoveTemp(GFileIOQueue);
+    }
+    // Joins the I/O threads outside the lock, a running request may still call Get
+    Queue.Reset();
+}
+
+FAGTFileIOQueue::FAGTFileIOQueue()
+{
+    WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+    if (!FPlatformProcess::SupportsMultithreading())
+    {
+        return;
+    }
+    for (int32 Index = 0; Index < NumThreads; ++Index)
+    {
+        FWorker* Worker = new FWorker(*this);
+        Workers.Add(Worker);
+        Threads.Add(FRunnableThread::Create(Worker, *FString::Printf(TEXT("AGTFileIO_%d"), Index), 0, TPri_BelowNormal));
+    }
+}
+
+FAGTFileIOQueue::~FAGTFileIOQueue()
+{
+    StopThreads();
+    FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+    WakeEvent = nullptr;
+}
+
+void FAGTFileIOQueue::StopThreads()
+{
+    bStopping = true;
+    for (int32 Index = 0; Index < Threads.Num(); ++Index)
+    {
+        WakeEvent->Trigger();
+    }
+    for (FRunnableThread* Thread : Threads)
+    {
+        if (Thread)
+        {
+            Thread->WaitForCompletion();
+            delete Thread;
+        }
+    }
+    Threads.Empty();
+    for (FWorker* Worker : Workers)
+    {
+        delete Worker;
+    }
+    Workers.Empty();
+
+    // Nothing is going to serve what is left
+    while (FAGTFileIORequestPtr Request = Dequeue())
+    {
+        Request->Cancel();
+        Request->Finish(EAGTFileIOResult::Canceled);
+    }
+}
+
+FAGTFileIORequestRef FAGTFileIOQueue::Enqueue(EAGTFileIOPriority Priority, FAGTFileIORequest::FWork&& Work, FAGTFileIORequest::FOnComplete&& OnComplete)
+{
+    FAGTFileIORequestRef Request = MakeShared<FAGTFileIORequest, ESPMode::ThreadSafe>(Priority, MoveTemp(Work), MoveTemp(OnComplete));
+
+    // Without I/O threads the request runs inline so callers still get a result
+    if (Threads.Num() == 0 && !bStopping)
+    {
+        Request->Execute();
+        return Request;
+    }
+
+    bool bQueued = false;
+    {
+        FScopeLock ScopeLock(&Lock);
+        if (!bStopping && NumPending < MaxPendingRequests)
+        {
+            Pending[static_cast<int32>(Priority)].Add(Request);
+            ++NumPending;
+            bQueued = true;
+        }
+    }
+
+    if (!bQueued)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("FAGTFileIOQueue: queue is full (%d requests), request rejected"), MaxPendingRequests);
+        Request->GetPayload().Error = FString("I/O queue is full");
+        Request->Finish(EAGTFileIOResult::Failed);
+        return Request;
+    }
+
+    WakeEvent->Trigger();
+    return Request;
+}
+
+FAGTFileIORequestPtr FAGTFileIOQueue::Dequeue()
+{
+    FScopeLock ScopeLock(&Lock);
+    for (int32 Index = UE_ARRAY_COUNT(Pending) - 1; Index >= 0; --Index)
+    {
+        if (Pending[Index].Num() > 0)
+        {
+            FAGTFileIORequestPtr Request = Pending[Index][0];
+            Pending[Index].RemoveAt(0, 1, false);
+            --NumPending;
+            return Request;
+        }
+    }
+    return nullptr;
+}
+
+int32 FAGTFileIOQueue::GetNumPending() const
+{
+    FScopeLock ScopeLock(&Lock);
+    return NumPending;
+}
+
+uint32 FAGTFileIOQueue::FWorker::Run()
+{
+    while (!Owner.bStopping)
+    {
+        FAGTFileIORequestPtr Request = Owner.Dequeue();
+        if (!Request.IsValid())
+        {
+            // The timeout is only a safety net, enqueue always triggers the event
+            Owner.WakeEvent->Wait(100);
+            continue;
+        }
+
+        // Pass the wake up along so idle workers pick up the rest of the queue
+        if (Owner.GetNumPending() > 0)
+        {
+            Owner.WakeEvent->Trigger();
+        }
+        Request->Execute();
+    }
+    return 0;
+}
+
+#pragma endregion
+
+#pragma region Chunked
+
+EAGTFileIOResult FAGTFileIOQueue::ReadFileChunked(FAGTFileIORequest& Request, const FString& Path, TArray<uint8>& OutBytes)
+{
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    TUniquePtr<IFileHandle> Handle(PlatformFile.OpenRead(*Path));
+    if (!Handle.IsValid())
+    {
+        Request.GetPayload().Error = FString("Could not open file");
+        return EAGTFileIOResult::Failed;
+    }
+
+    const int64 Size = Handle->Size();
+    if (Size > MAX_int32)
+    {
+        Request.GetPayload().Error = FString("File is too large");
+        return EAGTFileIOResult::Failed;
+    }
+
+    OutBytes.SetNumUninitialized(static_cast<int32>(Size));
+    Request.ReportProgress(0, Size);
+    for (int64 Done = 0; Done < Size;)
+    {
+        if (Request.IsCanceled())
+        {
+            OutBytes.Empty();
+            return EAGTFileIOResult::Canceled;
+        }
+        const int64 ToRead = FMath::Min(ChunkSize, Size - Done);
+        if (!Handle->Read(OutBytes.GetData() + Done, ToRead))
+        {
+            OutBytes.Empty();
+            Request.GetPayload().Error = FString("Read error");
+            return EAGTFileIOResult::Failed;
+        }
+        Done += ToRead;
+        Request.ReportProgress(Done, Size);
+    }
+    return EAGTFileIOResult::Success;
+}
+
+EAGTFileIOResult FAGTFileIOQueue::WriteFileChunked(FAGTFileIORequest& Request, const FString& Path, const uint8* Data, int64 Size, bool bAppend)
+{
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Path));
+    const FAGTFileChange Change(Path);
+    TUniquePtr<IFileHandle> Handle(PlatformFile.OpenWrite(*Path, bAppend));
+    if (!Handle.IsValid())
+    {
+        Request.GetPayload().Error = FString("Could not open file for writing");
+        return EAGTFileIOResult::Failed;
+    }
+
+    Request.ReportProgress(0, Size);
+    for (int64 Done = 0; Done < Size;)
+    {
+        if (Request.IsCanceled())
+        {
+            Handle.Reset();
+            if (!bAppend)
+            {
+                PlatformFile.DeleteFile(*Path);
+            }
+            return EAGTFileIOResult::Canceled;
+        }
+        const int64 ToWrite = FMath::Min(ChunkSize, Size - Done);
+        if (!Handle->Write(Data + Done, ToWrite))
+        {
+            Request.GetPayload().Error = FString("Write error");
+            return EAGTFileIOResult::Failed;
+        }
+        Done += ToWrite;
+        Request.ReportProgress(Done, Size);
+    }
+    return Handle->Flush() ? EAGTFileIOResult::Success : EAGTFileIOResult::Failed;
+}
+
+#pragma endregion
+
+#pragma region Operations
+
+FAGTFileIORequestRef FAGTFileIOQueue::ReadText(const FString& Path, EAGTFileIOPriority Priority, FAGTFileIORequest::FOnComplete&& OnComplete)
+{
+    return Enqueue(
+        Priority,
+        [Path](FAGTFileIORequest& Request)
+        {
+            TArray<uint8> Bytes;
+            const EAGTFileIOResult ReadResult = ReadFileChunked(Request, Path, Bytes);
+            if (ReadResult == EAGTFileIOResult::Success)
+            {
+                FFileHelper::BufferToString(Request.GetPayload().Text, Bytes.GetData(), Bytes.Num());
+            }
+            return ReadResult;
+        },
+        MoveTemp(OnComplete));
+}
+
+FAGTFileIORequestRef FAGTFileIOQueue::SaveText(
+    const FString& Path, const FString& Text, bool bAppend, bool bForce, EAGTFileIOPriority Priority, FAGTFileIORequest::FOnComplete&& OnComplete)
+{
+    return Enqueue(
+        Priority,
+        [Path, Text, bAppend, bForce](FAGTFileIORequest& Request)
+        {
+            if (!AGTFileIO::CanSave(Path, bAppend, bForce, Request.GetPayload().Error))
+            {
+                return EAGTFileIOResult::Failed;
+            }
+            TArray<uint8> Bytes;
+            AGTFileIO::EncodeText(Text, Bytes);
+            return WriteFileChunked(Request, Path, Bytes.GetData(), Bytes.Num(), bAppend);
+        },
+        MoveTemp(OnComplete));
+}
+
+FAGTFileIORequestRef FAGTFileIOQueue::ReadByte(const FString& Path, EAGTFileIOPriority Priority, FAGTFileIORequest::FOnComplete&& OnComplete)
+{
+    return Enqueue(
+        Priority, [Path](FAGTFileIORequest& Request) { return ReadFileChunked(Request, Path, Request.GetPayload().Bytes); }, MoveTemp(OnComplete));
+}
+
+FAGTFileIORequestRef FAGTFileIOQueue::SaveByte(
+    const FString& Path, const TArray<uint8>& Bytes, bool bAppend, bool bForce, EAGTFileIOPriority Priority, FAGTFileIORequest::FOnComplete&& OnComplete)
+{
+    return Enqueue(
+        Priority,
+        [Path, Bytes, bAppend, bForce](FAGTFileIORequest& Request)
+        {
+            if (!AGTFileIO::CanSave(Path, bAppend, bForce, Request.GetPayload().Error))
+            {
+                return EAGTFileIOResult::Failed;
+            }
+            return WriteFileChunked(Request, Path, Bytes.GetData(), Bytes.Num(), bAppend);
+        },
+        MoveTemp(OnComplete));
+}
+
+FAGTFileIORequestRef FAGTFileIOQueue::ReadCSV(const FString& Path, bool bHeaderFirst, EAGTFileIOPriority Priority, FAGTFileIORequest::FOnComplete&& OnComplete)
+{
+    return Enqueue(
+        Priority,
+        [Path, bHeaderFirst](FAGTFileIORequest& Request)
+        {
+            TArray<uint8> Bytes;
+            const EAGTFileIOResult ReadResult = ReadFileChunked(Request, Path, Bytes);
+            if (ReadResult != EAGTFileIOResult::Success)
+            {
+                return ReadResult;
+            }
+            FString Content;
+            FFileHelper::BufferToString(Content, Bytes.GetData(), Bytes.Num());
+            Bytes.Empty();
+            FAGTFileIOPayload& Payload = Request.GetPayload();
+            return UAdvanceGameToolLibrary::StringToCSV(Content, Payload.Headers, Payload.Data, Payload.Total, bHeaderFirst) ? EAGTFileIOResult::Success : EAGTFileIOResult::Failed;
+        },
+        MoveTemp(OnComplete));
+}
+
+FAGTFileIORequestRef FAGTFileIOQueue::SaveCSV(const FString& Path, const TArray<FString>& Headers, const TArray<FString>& Data, bool bForce, EAGTFileIOPriority Priority,
+    FAGTFileIORequest::FOnComplete&& OnComplete)
+{
+    return Enqueue(
+        Priority,
+        [Path, Headers, Data, bForce](FAGTFileIORequest& Request)
+        {
+            FAGTFileIOPayload& Payload = Request.GetPayload();
+            if (!AGTFileIO::CanSave(Path, false, bForce, Payload.Error))
+            {
+                return EAGTFileIOResult::Failed;
+            }
+            if (Headers.Num() == 0 || Data.Num() % Headers.Num() != 0)
+            {
+                Payload.Error = FString("Data does not match the headers");
+                return EAGTFileIOResult::Failed;
+            }
+            FAGTCsvWriter Writer;
+            if (!Writer.Open(Path))
+            {
+                Payload.Error = FString("Could not open file for writing");
+                return EAGTFileIOResult::Failed;
+            }
+
+            const int32 NumColumns = Headers.Num();
+            const int32 NumRows = Data.Num() / NumColumns;
+            Writer.WriteRow(Headers);
+            for (int32 Row = 0; Row < NumRows; ++Row)
+            {
+                if (Request.IsCanceled())
+                {
+                    Writer.Close();
+                    const FAGTFileChange Change(Path);
+                    FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*Path);
+                    return EAGTFileIOResult::Canceled;
+                }
+                if (!Writer.WriteRow(TArrayView<const FString>(Data.GetData() + Row * NumColumns, NumColumns)))
+                {
+                    break;
+                }
+                Request.ReportProgress(Row + 1, NumRows);
+            }
+            if (!Writer.Close())
+            {
+                Payload.Error = FString("Write error");
+                return EAGTFileIOResult::Failed;
+            }
+            Payload.Total = NumRows + 1;
+            return EAGTFileIOResult::Success;
+        },
+        MoveTemp(OnComplete));
+}
+
+#pragma endregion
@@ -0,0 +1,157 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AdvanceGameTools/AGTDataTypes.h"
+#include "Async/Future.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+
+class FAGTFileIORequest;
+
+typedef TSharedRef<FAGTFileIORequest, ESPMode::ThreadSafe> FAGTFileIORequestRef;
+typedef TSharedPtr<FAGTFileIORequest, ESPMode::ThreadSafe> FAGTFileIORequestPtr;
+
+/**
+ * @class A single request on the background file I/O queue.
+ * The work function runs on an I/O thread, the future is fulfilled as soon as it returns
+ * and OnComplete is called afterwards on the game thread.
+ */
+class ADVANCEGAMETOOLS_API FAGTFileIORequest : public TSharedFromThis<FAGTFileIORequest, ESPMode::ThreadSafe>
+{
+public:
+    typedef TFunction<EAGTFileIOResult(FAGTFileIORequest&)> FWork;
+    typedef TFunction<void(FAGTFileIORequest&)> FOnComplete;
+
+    FAGTFileIORequest(EAGTFileIOPriority InPriority, FWork&& InWork, FOnComplete&& InOnComplete);
+
+    /** @public Asks the request to stop. Queued requests are dropped, running requests stop at the next chunk **/
+    void Cancel() { bCanceled = true; }
+    bool IsCanceled() const { return bCanceled; }
+    bool IsDone() const { return bDone; }
+
+    EAGTFileIOPriority GetPriority() const { return Priority; }
+    EAGTFileIOResult GetResult() const { return Result; }
+
+    /** @public Progress of the running operation in the range [0, 1] **/
+    float GetProgress() const;
+    int64 GetBytesDone() const { return BytesDone.load(std::memory_order_relaxed); }
+    int64 GetBytesTotal() const { return BytesTotal.load(std::memory_order_relaxed); }
+
+    /** @public Future fulfilled from the I/O thread once the work is done **/
+    TSharedFuture<EAGTFileIOResult> GetFuture() const { return Future; }
+
+    /** @public Output of the operation. Only safe to read once IsDone returns true **/
+    FAGTFileIOPayload& GetPayload() { return Payload; }
+    const FAGTFileIOPayload& GetPayload() const { return Payload; }
+
+    /** @public Called by the work function to publish progress **/
+    void ReportProgress(int64 Done, int64 Total);
+
+private:
+    friend class FAGTFileIOQueue;
+
+    /** @private Runs the work function on the calling I/O thread **/
+    void Execute();
+
+    /** @private Publishes the result and schedules OnComplete on the game thread **/
+    void Finish(EAGTFileIOResult InResult);
+
+    EAGTFileIOPriority Priority;
+    FWork Work;
+    FOnComplete OnComplete;
+    FAGTFileIOPayload Payload;
+
+    TPromise<EAGTFileIOResult> Promise;
+    TSharedFuture<EAGTFileIOResult> Future;
+
+    EAGTFileIOResult Result{EAGTFileIOResult::Failed};
+    FThreadSafeBool bCanceled{false};
+    FThreadSafeBool bDone{false};
+    std::atomic<int64> BytesDone{0};
+    std::atomic<int64> BytesTotal{0};
+};
+
+/**
+ * @class Bounded background queue for file I/O.
+ * A small pool of dedicated threads serves requests by priority, highest first.
+ * When the queue is full new requests fail immediately instead of blocking the caller.
+ */
+class ADVANCEGAMETOOLS_API FAGTFileIOQueue
+{
+public:
+    /** Maximum number of requests waiting to be served */
+    static constexpr int32 MaxPendingRequests = 256;
+
+    /** Number of I/O threads */
+    static constexpr int32 NumThreads = 2;
+
+    /** Size of a single read or write when streaming a file */
+    static constexpr int64 ChunkSize = 1024 * 1024;
+
+    /** @public Creates the queue. Called when the module starts up, Get still creates it on first use otherwise **/
+    static void Startup();
+
+    static FAGTFileIOQueue& Get();
+
+    /** @public Stops the I/O threads and cancels everything still queued. Called when the module shuts down, pending OnComplete callbacks are dropped **/
+    static void Shutdown();
+
+    ~FAGTFileIOQueue();
+
+    /** @public Queues custom work. The returned request is already finished with Failed if the queue is full **/
+    FAGTFileIORequestRef Enqueue(EAGTFileIOPriority Priority, FAGTFileIORequest::FWork&& Work, FAGTFileIORequest::FOnComplete&& OnComplete = nullptr);
+
+    FAGTFileIORequestRef ReadText(const FString& Path, EAGTFileIOPriority Priority = EAGTFileIOPriority::Normal, FAGTFileIORequest::FOnComplete&& OnComplete = nullptr);
+    FAGTFileIORequestRef SaveText(const FString& Path, const FString& Text, bool bAppend, bool bForce, EAGTFileIOPriority Priority = EAGTFileIOPriority::Normal,
+        FAGTFileIORequest::FOnComplete&& OnComplete = nullptr);
+    FAGTFileIORequestRef ReadByte(const FString& Path, EAGTFileIOPriority Priority = EAGTFileIOPriority::Normal, FAGTFileIORequest::FOnComplete&& OnComplete = nullptr);
+    FAGTFileIORequestRef SaveByte(const FString& Path, const TArray<uint8>& Bytes, bool bAppend, bool bForce, EAGTFileIOPriority Priority = EAGTFileIOPriority::Normal,
+        FAGTFileIORequest::FOnComplete&& OnComplete = nullptr);
+    FAGTFileIORequestRef ReadCSV(const FString& Path, bool bHeaderFirst, EAGTFileIOPriority Priority = EAGTFileIOPriority::Normal, FAGTFileIORequest::FOnComplete&& OnComplete = nullptr);
+    FAGTFileIORequestRef SaveCSV(const FString& Path, const TArray<FString>& Headers, const TArray<FString>& Data, bool bForce,
+        EAGTFileIOPriority Priority = EAGTFileIOPriority::Normal, FAGTFileIORequest::FOnComplete&& OnComplete = nullptr);
+
+    int32 GetNumPending() const;
+
+    /** @public Streams a whole file into OutBytes in ChunkSize steps, reporting progress and honouring cancellation **/
+    static EAGTFileIOResult ReadFileChunked(FAGTFileIORequest& Request, const FString& Path, TArray<uint8>& OutBytes);
+
+    /** @public Streams Data to a file in ChunkSize steps. A canceled overwrite removes the partial file **/
+    static EAGTFileIOResult WriteFileChunked(FAGTFileIORequest& Request, const FString& Path, const uint8* Data, int64 Size, bool bAppend);
+
+private:
+    class FWorker : public FRunnable
+    {
+    public:
+        explicit FWorker(FAGTFileIOQueue& InOwner) : Owner(InOwner) {}
+        virtual uint32 Run() override;
+
+    private:
+        FAGTFileIOQueue& Owner;
+    };
+
+    FAGTFileIOQueue();
+
+    /** @private Pops the oldest request of the highest non-empty priority **/
+    FAGTFileIORequestPtr Dequeue();
+
+    void StopThreads();
+
+    // One FIFO per priority, indexed by EAGTFileIOPriority
+    TArray<FAGTFileIORequestPtr> Pending[3];
+    int32 NumPending{0};
+    mutable FCriticalSection Lock;
+
+    FEvent* WakeEvent{nullptr};
+    TArray<FWorker*> Workers;
+    TArray<FRunnableThread*> Threads;
+    FThreadSafeBool bStopping{false};
+};
+
+namespace AGTFileIO
+{
+/** Encodes text the way FFileHelper::EEncodingOptions::AutoDetect does: plain ANSI if possible, UTF-16 with BOM otherwise */
+ADVANCEGAMETOOLS_API void EncodeText(const FString& Text, TArray<uint8>& OutBytes);
+}  // namespace AGTFileIO
@@ -0,0 +1,102 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTFingerprint.h"
+#include "AdvanceGameTools/Library/AGTFileHandlePool.h"
+
+THIRD_PARTY_INCLUDES_START
+// Everything static in this file, so the copy the engine links cannot clash with it
+#define XXH_INLINE_ALL
+#include <AdvanceGameTools/ThirdParty/xxHash/xxhash.h>
+THIRD_PARTY_INCLUDES_END
+
+FAGTFingerprint FAGTFingerprint::FromData(const void* Data, int64 Size)
+{
+    const XXH128_hash_t Hash = XXH3_128bits(Data, static_cast<size_t>(Size));
+    return FAGTFingerprint(Hash.low64, Hash.high64);
+}
+
+uint64 FAGTFingerprint::Hash64(const void* Data, int64 Size)
+{
+    return XXH3_64bits(Data, static_cast<size_t>(Size));
+}
+
+void FAGTFingerprint::FromString(const FString& Str)
+{
+    const FTCHARToUTF8 Utf8(*Str, Str.Len());
+    *this = FromData(Utf8.Get(), Utf8.Length());
+}
+
+void FAGTFingerprint::FromArray(const TArray<uint8>& Arr)
+{
+    *this = FromData(Arr.GetData(), Arr.Num());
+}
+
+void FAGTFingerprint::FromArray64(const TArray64<uint8>& Arr)
+{
+    *this = FromData(Arr.GetData(), Arr.Num());
+}
+
+void FAGTFingerprint::FromBytes(const uint8* Data, int64 Size)
+{
+    *this = FromData(Data, Size);
+}
+
+bool FAGTFingerprint::FromFile(const FString& File)
+{
+    const FAGTPositionalReaderPtr Reader = FAGTFileHandlePool::Get().Acquire(File);
+    if (!Reader)
+    {
+        return false;
+    }
+
+    // Large chunks, XXH3 outruns the disk and per-read overhead would dominate
+    static const int64 ChunkSize = 1024 * 1024;
+    TArray<uint8> Buffer;
+    Buffer.SetNumUninitialized(static_cast<int32>(FMath::Min<int64>(ChunkSize, FMath::Max<int64>(Reader->Size(), 1))));
+    FAGTFingerprintBuilder Builder;
+    for (int64 Offset = 0; Offset < Reader->Size();)
+    {
+        const int64 SizeToRead = FMath::Min<int64>(Reader->Size() - Offset, Buffer.Num());
+        if (Reader->ReadAt(Offset, Buffer.GetData(), SizeToRead) != SizeToRead)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Read error while fingerprinting '%s' at offset %lld."), *File, Offset);
+            return false;
+        }
+        Builder.Update(Buffer.GetData(), SizeToRead);
+        Offset += SizeToRead;
+    }
+    *this = Builder.Final();
+    return true;
+}
+
+FString FAGTFingerprint::GetHash() const
+{
+    return FString::Printf(TEXT("%016llx%016llx"), High, Low);
+}
+
+FAGTFingerprintBuilder::FAGTFingerprintBuilder() : State(XXH3_createState())
+{
+    check(State);
+    Reset();
+}
+
+FAGTFingerprintBuilder::~FAGTFingerprintBuilder()
+{
+    XXH3_freeState(static_cast<XXH3_state_t*>(State));
+}
+
+void FAGTFingerprintBuilder::Reset()
+{
+    XXH3_128bits_reset(static_cast<XXH3_state_t*>(State));
+}
+
+void FAGTFingerprintBuilder::Update(const void* Data, int64 Size)
+{
+    XXH3_128bits_update(static_cast<XXH3_state_t*>(State), Data, static_cast<size_t>(Size));
+}
+
+FAGTFingerprint FAGTFingerprintBuilder::Final() const
+{
+    const XXH128_hash_t Hash = XXH3_128bits_digest(static_cast<const XXH3_state_t*>(State));
+    return FAGTFingerprint(Hash.low64, Hash.high64);
+}
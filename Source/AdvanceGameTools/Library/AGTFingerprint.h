@@ -0,0 +1,70 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AGTFingerprint.generated.h"
+
+/**
+ * 128 bit XXH3 fingerprint of content, for change detection and cache keys where SHA-256 is more than needed.
+ * Not cryptographic: it detects accidental changes, not deliberate collisions.
+ */
+USTRUCT(BlueprintType)
+struct ADVANCEGAMETOOLS_API FAGTFingerprint
+{
+    GENERATED_BODY()
+
+public:
+    FAGTFingerprint() = default;
+    FAGTFingerprint(uint64 InLow, uint64 InHigh) : Low(InLow), High(InHigh) {}
+
+    static FAGTFingerprint FromData(const void* Data, int64 Size);
+
+    /** @public 64 bit XXH3 of the data, for hot paths that only need a 64 bit key. Not the low half of the 128 bit fingerprint **/
+    static uint64 Hash64(const void* Data, int64 Size);
+
+    void FromString(const FString& Str);
+    void FromArray(const TArray<uint8>& Arr);
+    void FromArray64(const TArray64<uint8>& Arr);
+    void FromBytes(const uint8* Data, int64 Size);
+    bool FromFile(const FString& File);
+
+    /** @public 32 lowercase hex digits, high half first like the canonical XXH128 form **/
+    FString GetHash() const;
+
+    uint64 GetLow() const { return Low; }
+    uint64 GetHigh() const { return High; }
+
+    bool operator==(const FAGTFingerprint& Other) const { return Low == Other.Low && High == Other.High; }
+    bool operator!=(const FAGTFingerprint& Other) const { return !(*this == Other); }
+
+    friend uint32 GetTypeHash(const FAGTFingerprint& Fingerprint) { return static_cast<uint32>(Fingerprint.Low); }
+
+private:
+    uint64 Low{0};
+    uint64 High{0};
+};
+
+/**
+ * @class Streaming form of FAGTFingerprint, for data that arrives in pieces.
+ * Update in any split gives the same fingerprint as hashing the whole data at once.
+ */
+class ADVANCEGAMETOOLS_API FAGTFingerprintBuilder
+{
+public:
+    FAGTFingerprintBuilder();
+    ~FAGTFingerprintBuilder();
+
+    FAGTFingerprintBuilder(const FAGTFingerprintBuilder&) = delete;
+    FAGTFingerprintBuilder& operator=(const FAGTFingerprintBuilder&) = delete;
+
+    void Reset();
+    void Update(const void* Data, int64 Size);
+
+    /** @public Fingerprint of everything so far. More data can still be added **/
+    FAGTFingerprint Final() const;
+
+private:
+    // XXH3 state, kept opaque so the xxHash header stays out of this one
+    void* State{nullptr};
+};
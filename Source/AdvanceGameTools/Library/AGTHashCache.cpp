@@ -0,0 +1,359 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTHashCache.h"
+#include "AdvanceGameTools/Library/AGTAtomicFile.h"
+#include "AdvanceGameTools/Library/AGTMappedFileView.h"
+#include "AdvanceGameTools/Library/AGTSha256.h"
+#include "AdvanceGameTools/Library/SHA256Hash.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/HideWindowsPlatformTypes.h"
+#elif PLATFORM_UNIX || PLATFORM_MAC
+#include <sys/stat.h>
+#endif
+
+namespace AGTHashCache
+{
+static const uint8 Magic[4] = {'A', 'G', 'T', 'H'};
+static constexpr uint32 Version = 1;
+static constexpr int32 HeaderSize = 12;
+/** Size, modification time, file id and digest after the path of every record */
+static constexpr int32 RecordTailSize = 8 + 8 + 8 + 32;
+/** A record with an empty path, no file can hold more records than fit at this size */
+static constexpr int32 MinRecordSize = 2 + RecordTailSize;
+
+/**
+ * A file written again within the timestamp resolution right after it was hashed would keep its key.
+ * Such files are hashed but not cached until their modification time is safely in the past.
+ */
+static constexpr int64 RacyWindow = 2 * ETimespan::TicksPerSecond;
+
+template <typename T>
+static void Append(TArray<uint8>& Bytes, T Value)
+{
+    const int32 Offset = Bytes.AddUninitialized(sizeof(T));
+    FMemory::Memcpy(Bytes.GetData() + Offset, &Value, sizeof(T));
+}
+
+template <typename T>
+static T Take(const uint8*& Cursor)
+{
+    T Value;
+    FMemory::Memcpy(&Value, Cursor, sizeof(T));
+    Cursor += sizeof(T);
+    return Value;
+}
+
+static bool HexToDigest(const FString& Hex, uint8 OutDigest[FAGTSha256::DigestSize])
+{
+    return Hex.Len() == FAGTSha256::DigestSize * 2 && HexToBytes(Hex, OutDigest) == FAGTSha256::DigestSize;
+}
+}  // namespace AGTHashCache
+
+static TUniquePtr<FAGTHashCache> GHashCache;
+static FCriticalSection GHashCacheLock;
+
+FAGTHashCache& FAGTHashCache::Get()
+{
+    FScopeLock ScopeLock(&GHashCacheLock);
+    if (!GHashCache.IsValid())
+    {
+        GHashCache = MakeUnique<FAGTHashCache>();
+    }
+    return *GHashCache;
+}
+
+void FAGTHashCache::Shutdown()
+{
+    FScopeLock ScopeLock(&GHashCacheLock);
+    if (GHashCache.IsValid())
+    {
+        GHashCache->Save();
+        GHashCache.Reset();
+    }
+}
+
+FAGTHashCache::FAGTHashCache() : CachePath(FPaths::ProjectSavedDir() / TEXT("AGT") / TEXT("FileHashes.bin")) {}
+
+int32 FAGTHashCache::Num() const
+{
+    FScopeLock ScopeLock(&Lock);
+    return Entries.Num();
+}
+
+bool FAGTHashCache::ReadKey(const FString& Path, FKey& OutKey)
+{
+#if PLATFORM_WINDOWS
+    // Attribute-only open, the file index is not part of the directory entry
+    HANDLE Handle = CreateFileW(*Path, FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (Handle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    BY_HANDLE_FILE_INFORMATION Info;
+    const bool bRead = GetFileInformationByHandle(Handle, &Info) != 0;
+    CloseHandle(Handle);
+    if (!bRead || (Info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+    {
+        return false;
+    }
+    OutKey.Size = (static_cast<int64>(Info.nFileSizeHigh) << 32) | Info.nFileSizeLow;
+    // FILETIME counts 100 ns from 1601, the same unit as FDateTime ticks
+    static const int64 FileTimeEpoch = FDateTime(1601, 1, 1).GetTicks();
+    OutKey.ModificationTime = FileTimeEpoch + ((static_cast<int64>(Info.ftLastWriteTime.dwHighDateTime) << 32) | Info.ftLastWriteTime.dwLowDateTime);
+    OutKey.FileId = (static_cast<uint64>(Info.nFileIndexHigh) << 32) | Info.nFileIndexLow;
+    return true;
+#elif PLATFORM_UNIX || PLATFORM_MAC
+    // stat keeps nanoseconds, FFileStatData rounds to seconds
+    struct stat Stat;
+    if (stat(TCHAR_TO_UTF8(*Path), &Stat) != 0 || !S_ISREG(Stat.st_mode))
+    {
+        return false;
+    }
+#if PLATFORM_MAC
+    const struct timespec& Modified = Stat.st_mtimespec;
+#else
+    const struct timespec& Modified = Stat.st_mtim;
+#endif
+    OutKey.Size = Stat.st_size;
+    OutKey.ModificationTime = FDateTime::FromUnixTimestamp(Modified.tv_sec).GetTicks() + Modified.tv_nsec / ETimespan::NanosecondsPerTick;
+    OutKey.FileId = static_cast<uint64>(Stat.st_ino);
+    return true;
+#else
+    const FFileStatData Stat = FPlatformFileManager::Get().GetPlatformFile().GetStatData(*Path);
+    if (!Stat.bIsValid || Stat.bIsDirectory)
+    {
+        return false;
+    }
+    OutKey.Size = Stat.FileSize;
+    OutKey.ModificationTime = Stat.ModificationTime.GetTicks();
+    OutKey.FileId = 0;
+    return true;
+#endif
+}
+
+bool FAGTHashCache::Hash(const TArray<FString>& Files, TArray<FString>& OutHashes)
+{
+    TArray<FString> Paths;
+    TArray<FKey> Keys;
+    TArray<bool> Found;
+    Paths.SetNum(Files.Num());
+    Keys.SetNum(Files.Num());
+    Found.SetNumZeroed(Files.Num());
+    OutHashes.Reset();
+    OutHashes.SetNum(Files.Num());
+
+    ParallelFor(Files.Num(),
+        [&](int32 Index)
+        {
+            Paths[Index] = FPaths::ConvertRelativePathToFull(Files[Index]);
+            Found[Index] = ReadKey(Paths[Index], Keys[Index]);
+        });
+
+    TArray<int32> Changed;
+    {
+        FScopeLock ScopeLock(&Lock);
+        LoadLocked();
+        for (int32 Index = 0; Index < Files.Num(); ++Index)
+        {
+            if (!Found[Index])
+            {
+                // No key on disk, a file inside a pak still hashes through the platform file, it is just not cached
+                Changed.Add(Index);
+                continue;
+            }
+            const FEntry* Entry = Entries.Find(Paths[Index]);
+            if (Entry && Entry->Key == Keys[Index])
+            {
+                OutHashes[Index] = FAGTSha256::DigestToHex(Entry->Digest);
+                ++Hits;
+            }
+            else
+            {
+                Changed.Add(Index);
+            }
+        }
+        Misses += Changed.Num();
+    }
+
+    ParallelFor(Changed.Num(),
+        [&](int32 Item)
+        {
+            const int32 Index = Changed[Item];
+            FSHA256Hash Hash;
+            if (Hash.FromFileOverlapped(Paths[Index]))
+            {
+                OutHashes[Index] = Hash.GetHash();
+            }
+        });
+
+    const int64 CacheableBefore = FDateTime::UtcNow().GetTicks() - AGTHashCache::RacyWindow;
+    bool bAllHashed = true;
+    FScopeLock ScopeLock(&Lock);
+    for (int32 Index = 0; Index < Files.Num(); ++Index)
+    {
+        if (OutHashes[Index].IsEmpty())
+        {
+            bAllHashed = false;
+            bDirty |= Entries.Remove(Paths[Index]) > 0;
+        }
+    }
+    for (const int32 Index : Changed)
+    {
+        // The file may have changed while it was read, the key is only trusted if it still matches
+        FKey After;
+        if (OutHashes[Index].IsEmpty() || !ReadKey(Paths[Index], After) || !(After == Keys[Index]) || After.ModificationTime > CacheableBefore)
+        {
+            continue;
+        }
+        FEntry& Entry = Entries.FindOrAdd(Paths[Index]);
+        Entry.Key = Keys[Index];
+        AGTHashCache::HexToDigest(OutHashes[Index], Entry.Digest);
+        bDirty = true;
+    }
+    return bAllHashed;
+}
+
+void FAGTHashCache::LoadLocked()
+{
+    if (bLoaded)
+    {
+        return;
+    }
+    bLoaded = true;
+
+    FAGTMappedFileView View;
+    if (!View.Open(CachePath))
+    {
+        return;
+    }
+    TArray<uint8> Copy;
+    TArrayView64<const uint8> Bytes;
+    if (!View.GetView(0, View.Size(), Bytes))
+    {
+        if (!View.CopyRange(0, View.Size(), Copy))
+        {
+            return;
+        }
+        Bytes = TArrayView64<const uint8>(Copy.GetData(), Copy.Num());
+    }
+
+    const uint8* Cursor = Bytes.GetData();
+    const uint8* End = Cursor + Bytes.Num();
+    if (Bytes.Num() < AGTHashCache::HeaderSize || FMemory::Memcmp(Cursor, AGTHashCache::Magic, 4) != 0)
+    {
+        return;
+    }
+    Cursor += 4;
+    if (AGTHashCache::Take<uint32>(Cursor) != AGTHashCache::Version)
+    {
+        return;
+    }
+    const uint32 Count = AGTHashCache::Take<uint32>(Cursor);
+    const int64 MaxCount = (Bytes.Num() - AGTHashCache::HeaderSize) / AGTHashCache::MinRecordSize;
+    if (Count > MaxCount)
+    {
+        // A damaged header would otherwise reserve memory for records the file cannot hold
+        UE_LOG(LogTemp, Warning, TEXT("Hash cache %s claims %u entries but has room for %lld, ignored"), *CachePath, Count, MaxCount);
+        return;
+    }
+    Entries.Reserve(static_cast<int32>(Count));
+
+    for (uint32 Record = 0; Record < Count; ++Record)
+    {
+        if (End - Cursor < 2)
+        {
+            break;
+        }
+        const uint16 PathSize = AGTHashCache::Take<uint16>(Cursor);
+        if (End - Cursor < PathSize + AGTHashCache::RecordTailSize)
+        {
+            // Truncated file, keep what was read so far
+            UE_LOG(LogTemp, Warning, TEXT("Hash cache %s is truncated after %u entries"), *CachePath, Record);
+            break;
+        }
+        const FUTF8ToTCHAR Path(reinterpret_cast<const ANSICHAR*>(Cursor), PathSize);
+        Cursor += PathSize;
+        FEntry& Entry = Entries.Add(FString(Path.Length(), Path.Get()));
+        Entry.Key.Size = AGTHashCache::Take<int64>(Cursor);
+        Entry.Key.ModificationTime = AGTHashCache::Take<int64>(Cursor);
+        Entry.Key.FileId = AGTHashCache::Take<uint64>(Cursor);
+        FMemory::Memcpy(Entry.Digest, Cursor, sizeof(Entry.Digest));
+        Cursor += sizeof(Entry.Digest);
+    }
+}
+
+bool FAGTHashCache::Save()
+{
+    FScopeLock ScopeLock(&Lock);
+    return SaveLocked();
+}
+
+bool FAGTHashCache::SaveLocked()
+{
+    if (!bDirty)
+    {
+        return true;
+    }
+
+    TArray<uint8> Bytes;
+    Bytes.Reserve(AGTHashCache::HeaderSize + Entries.Num() * (96 + AGTHashCache::RecordTailSize));
+    Bytes.Append(AGTHashCache::Magic, 4);
+    AGTHashCache::Append<uint32>(Bytes, AGTHashCache::Version);
+    const int32 CountOffset = Bytes.Num();
+    AGTHashCache::Append<uint32>(Bytes, 0);
+
+    uint32 Count = 0;
+    for (const TPair<FString, FEntry>& Pair : Entries)
+    {
+        const FTCHARToUTF8 Path(*Pair.Key, Pair.Key.Len());
+        if (Path.Length() > MAX_uint16)
+        {
+            continue;
+        }
+        AGTHashCache::Append<uint16>(Bytes, static_cast<uint16>(Path.Length()));
+        Bytes.Append(reinterpret_cast<const uint8*>(Path.Get()), Path.Length());
+        AGTHashCache::Append<int64>(Bytes, Pair.Value.Key.Size);
+        AGTHashCache::Append<int64>(Bytes, Pair.Value.Key.ModificationTime);
+        AGTHashCache::Append<uint64>(Bytes, Pair.Value.Key.FileId);
+        Bytes.Append(Pair.Value.Digest, sizeof(Pair.Value.Digest));
+        ++Count;
+    }
+    FMemory::Memcpy(Bytes.GetData() + CountOffset, &Count, sizeof(Count));
+
+    FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*FPaths::GetPath(CachePath));
+    FString Error;
+    if (!FAGTAtomicFile::Write(CachePath, Bytes, EAGTWriteMode::Atomic, Error))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Could not save hash cache: %s"), *Error);
+        return false;
+    }
+    bDirty = false;
+    return true;
+}
+
+void FAGTHashCache::SetCachePath(const FString& InCachePath)
+{
+    FScopeLock ScopeLock(&Lock);
+    if (InCachePath == CachePath)
+    {
+        return;
+    }
+    SaveLocked();
+    Entries.Reset();
+    CachePath = InCachePath;
+    bLoaded = false;
+}
+
+void FAGTHashCache::Clear()
+{
+    FScopeLock ScopeLock(&Lock);
+    bDirty = bDirty || Entries.Num() > 0 || !bLoaded;
+    Entries.Reset();
+    bLoaded = true;
+}
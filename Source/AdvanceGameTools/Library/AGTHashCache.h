@@ -0,0 +1,77 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ * @class Persistent SHA-256 cache keyed by path, size, modification time and file id (inode or NTFS file index).
+ * The cache file is mapped and parsed on first use, files whose key still matches are answered without being read.
+ * New or changed files are hashed in parallel. The cache is written back atomically on Save and on module shutdown.
+ */
+class ADVANCEGAMETOOLS_API FAGTHashCache
+{
+public:
+    static FAGTHashCache& Get();
+
+    /** @public Saves pending changes and releases the cache **/
+    static void Shutdown();
+
+    /**
+     * @public Hashes follow the order of Files, a file that could not be hashed gets an empty string.
+     * Returns true if every file was hashed. Thread safe
+     */
+    bool Hash(const TArray<FString>& Files, TArray<FString>& OutHashes);
+
+    /** @public Writes the cache if anything changed since it was loaded **/
+    bool Save();
+
+    /** @public Uses another cache file. Pending changes go to the old file first **/
+    void SetCachePath(const FString& InCachePath);
+    const FString& GetCachePath() const { return CachePath; }
+
+    /** @public Forgets every entry, the file is rewritten on the next Save **/
+    void Clear();
+
+    /** @public Files answered from the cache **/
+    int64 GetHits() const { return Hits.load(std::memory_order_relaxed); }
+
+    /** @public Files that had to be hashed **/
+    int64 GetMisses() const { return Misses.load(std::memory_order_relaxed); }
+
+    int32 Num() const;
+
+    FAGTHashCache();
+
+private:
+    struct FKey
+    {
+        int64 Size{-1};
+        int64 ModificationTime{0};
+        uint64 FileId{0};
+
+        bool operator==(const FKey& Other) const { return Size == Other.Size && ModificationTime == Other.ModificationTime && FileId == Other.FileId; }
+    };
+
+    struct FEntry
+    {
+        FKey Key;
+        uint8 Digest[32];
+    };
+
+    /** @private Size, modification time and file id in one call where the platform allows it. False if the file is missing **/
+    static bool ReadKey(const FString& Path, FKey& OutKey);
+
+    /** @private Lock must be held **/
+    void LoadLocked();
+    bool SaveLocked();
+
+    TMap<FString, FEntry> Entries;
+    FString CachePath;
+    bool bLoaded{false};
+    bool bDirty{false};
+    std::atomic<int64> Hits{0};
+    std::atomic<int64> Misses{0};
+    mutable FCriticalSection Lock;
+};
@@ -0,0 +1,129 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTMappedFileView.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+
+FAGTMappedFileView::~FAGTMappedFileView()
+{
+    Close();
+}
+
+bool FAGTMappedFileView::Open(const FString& FilePath, bool bAllowFallback)
+{
+    Close();
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    if (!PlatformFile.FileExists(*FilePath))
+    {
+        return false;
+    }
+
+    Path = FilePath;
+    MappedHandle = PlatformFile.OpenMapped(*FilePath);
+    if (MappedHandle)
+    {
+        FileSize = MappedHandle->GetFileSize();
+        // An empty file has nothing to map, the handle alone is enough to answer Size()
+        if (FileSize > 0)
+        {
+            MappedRegion = MappedHandle->MapRegion(0, FileSize);
+            if (!MappedRegion)
+            {
+                delete MappedHandle;
+                MappedHandle = nullptr;
+            }
+        }
+    }
+
+    if (!MappedHandle && bAllowFallback)
+    {
+        FallbackHandle = PlatformFile.OpenRead(*FilePath);
+        if (FallbackHandle)
+        {
+            FileSize = FallbackHandle->Size();
+        }
+    }
+
+    if (!IsOpen())
+    {
+        Path.Reset();
+        FileSize = 0;
+        return false;
+    }
+    return true;
+}
+
+void FAGTMappedFileView::Close()
+{
+    // The region must be released before the handle that owns the mapping
+    if (MappedRegion)
+    {
+        delete MappedRegion;
+        MappedRegion = nullptr;
+    }
+    if (MappedHandle)
+    {
+        delete MappedHandle;
+        MappedHandle = nullptr;
+    }
+    if (FallbackHandle)
+    {
+        delete FallbackHandle;
+        FallbackHandle = nullptr;
+    }
+    FileSize = 0;
+    Path.Reset();
+}
+
+bool FAGTMappedFileView::ClampRange(int64 Offset, int64& Length) const
+{
+    if (Offset < 0 || Length <= 0 || Offset >= FileSize)
+    {
+        return false;
+    }
+    Length = FMath::Min(FileSize - Offset, Length);
+    return true;
+}
+
+bool FAGTMappedFileView::GetView(int64 Offset, int64 Length, TArrayView64<const uint8>& OutView) const
+{
+    if (!MappedRegion || !ClampRange(Offset, Length))
+    {
+        return false;
+    }
+    OutView = TArrayView64<const uint8>(MappedRegion->GetMappedPtr() + Offset, Length);
+    return true;
+}
+
+bool FAGTMappedFileView::CopyRange(int64 Offset, int64 Length, TArray<uint8>& OutBytes) const
+{
+    if (!ClampRange(Offset, Length) || Length > MAX_int32)
+    {
+        return false;
+    }
+    OutBytes.SetNumUninitialized(static_cast<int32>(Length));
+    return CopyRange(Offset, Length, OutBytes.GetData()) == Length;
+}
+
+int64 FAGTMappedFileView::CopyRange(int64 Offset, int64 Length, uint8* Dest) const
+{
+    if (!Dest || !ClampRange(Offset, Length))
+    {
+        return -1;
+    }
+    if (MappedRegion)
+    {
+        FMemory::Memcpy(Dest, MappedRegion->GetMappedPtr() + Offset, Length);
+        return Length;
+    }
+    if (FallbackHandle)
+    {
+        FScopeLock Lock(&FallbackLock);
+        if (FallbackHandle->Seek(Offset) && FallbackHandle->Read(Dest, Length))
+        {
+            return Length;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,61 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * @class Read-only view of a file on disk.
+ * The file is mapped into memory when the platform supports it, so slices can be read without copying the whole file.
+ * Where mapping is unavailable the view keeps a regular read handle open and serves slices with buffered reads.
+ */
+class ADVANCEGAMETOOLS_API FAGTMappedFileView
+{
+public:
+    FAGTMappedFileView() = default;
+    ~FAGTMappedFileView();
+
+    FAGTMappedFileView(const FAGTMappedFileView&) = delete;
+    FAGTMappedFileView& operator=(const FAGTMappedFileView&) = delete;
+
+    /** @public Opens the file. Tries to map it first and falls back to a read handle if bAllowFallback is set **/
+    bool Open(const FString& FilePath, bool bAllowFallback = true);
+
+    /** @public Releases the mapping or the fallback handle **/
+    void Close();
+
+    bool IsOpen() const { return MappedHandle != nullptr || FallbackHandle != nullptr; }
+    bool IsMapped() const { return MappedRegion != nullptr; }
+    int64 Size() const { return FileSize; }
+    const FString& GetPath() const { return Path; }
+
+    /**
+     * @public Returns a zero-copy view of [Offset, Offset + Length) clamped to the file size.
+     * Only available when the file is mapped. The view stays valid until Close is called.
+     */
+    bool GetView(int64 Offset, int64 Length, TArrayView64<const uint8>& OutView) const;
+
+    /** @public Copies [Offset, Offset + Length) clamped to the file size into OutBytes. Works for both mapped and fallback modes **/
+    bool CopyRange(int64 Offset, int64 Length, TArray<uint8>& OutBytes) const;
+
+    /** @public Copies up to Length bytes at Offset into Dest. Returns the number of bytes copied or -1 on error **/
+    int64 CopyRange(int64 Offset, int64 Length, uint8* Dest) const;
+
+private:
+    /** @private Clamps the requested range to the file. Returns false if nothing is left to read **/
+    bool ClampRange(int64 Offset, int64& Length) const;
+
+    FString Path;
+    int64 FileSize{0};
+
+    IMappedFileHandle* MappedHandle{nullptr};
+    IMappedFileRegion* MappedRegion{nullptr};
+
+    // Used only when the file could not be mapped. Seek + Read is not atomic so reads are serialized.
+    IFileHandle* FallbackHandle{nullptr};
+    mutable FCriticalSection FallbackLock;
+};
@@ -0,0 +1,533 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTPositionalReader.h"
+#include "HAL/PlatformFileManager.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/HideWindowsPlatformTypes.h"
+#elif PLATFORM_UNIX || PLATFORM_MAC
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if PLATFORM_LINUX
+#include <limits.h>
+#include <sys/uio.h>
+#endif
+#endif
+
+namespace AGTFileIdentity
+{
+#if PLATFORM_WINDOWS
+static bool FromHandle(HANDLE Handle, FAGTFileIdentity& OutIdentity)
+{
+    BY_HANDLE_FILE_INFORMATION Info;
+    if (!::GetFileInformationByHandle(Handle, &Info) || (Info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+    {
+        return false;
+    }
+    // FILETIME counts 100 ns from 1601, the same unit as FDateTime ticks
+    static const int64 FileTimeEpoch = FDateTime(1601, 1, 1).GetTicks();
+    OutIdentity.Size = (static_cast<int64>(Info.nFileSizeHigh) << 32) | Info.nFileSizeLow;
+    OutIdentity.ModificationTime = FileTimeEpoch + ((static_cast<int64>(Info.ftLastWriteTime.dwHighDateTime) << 32) | Info.ftLastWriteTime.dwLowDateTime);
+    OutIdentity.FileId = (static_cast<uint64>(Info.nFileIndexHigh) << 32) | Info.nFileIndexLow;
+    return true;
+}
+#elif PLATFORM_UNIX || PLATFORM_MAC
+static bool FromStat(const struct stat& Stat, FAGTFileIdentity& OutIdentity)
+{
+    if (!S_ISREG(Stat.st_mode))
+    {
+        return false;
+    }
+#if PLATFORM_MAC
+    const struct timespec& Modified = Stat.st_mtimespec;
+#else
+    const struct timespec& Modified = Stat.st_mtim;
+#endif
+    OutIdentity.Size = Stat.st_size;
+    OutIdentity.ModificationTime = FDateTime::FromUnixTimestamp(Modified.tv_sec).GetTicks() + Modified.tv_nsec / ETimespan::NanosecondsPerTick;
+    OutIdentity.FileId = static_cast<uint64>(Stat.st_ino);
+    return true;
+}
+#endif
+
+/** Platform file stats only have the time and no id, good enough for pak entries that do not change while mounted */
+static bool FromStatData(const FFileStatData& Stat, FAGTFileIdentity& OutIdentity)
+{
+    if (!Stat.bIsValid || Stat.bIsDirectory)
+    {
+        return false;
+    }
+    OutIdentity.Size = Stat.FileSize;
+    OutIdentity.ModificationTime = Stat.ModificationTime.GetTicks();
+    OutIdentity.FileId = 0;
+    return true;
+}
+}  // namespace AGTFileIdentity
+
+namespace AGTBatchRead
+{
+/** Sorted ranges that touch or overlap, read with one call */
+struct FRun
+{
+    int64 Offset{0};
+    int64 End{0};
+    int32 First{0};
+    int32 Last{0};
+    /** No two ranges of the run overlap, each starts where the previous ended */
+    bool bChained{true};
+};
+
+static void BuildRuns(TArrayView<const FAGTReadRange> Ranges, int64 FileSize, TArray<FAGTReadRange>& OutClamped, TArray<int32>& OutSorted, TArray<FRun>& OutRuns)
+{
+    OutClamped.SetNum(Ranges.Num());
+    OutSorted.SetNum(Ranges.Num());
+    for (int32 Index = 0; Index < Ranges.Num(); ++Index)
+    {
+        FAGTReadRange& Range = OutClamped[Index];
+        Range.Offset = FMath::Clamp<int64>(Ranges[Index].Offset, 0, FileSize);
+        Range.Length = FMath::Clamp<int64>(Ranges[Index].Length, 0, FileSize - Range.Offset);
+        OutSorted[Index] = Index;
+    }
+    OutSorted.Sort([&OutClamped](int32 A, int32 B) { return OutClamped[A].Offset < OutClamped[B].Offset; });
+
+    for (int32 SortedIndex = 0; SortedIndex < OutSorted.Num(); ++SortedIndex)
+    {
+        const FAGTReadRange& Range = OutClamped[OutSorted[SortedIndex]];
+        if (OutRuns.Num() == 0 || Range.Offset > OutRuns.Last().End)
+        {
+            FRun& Run = OutRuns.AddDefaulted_GetRef();
+            Run.Offset = Range.Offset;
+            Run.End = Range.Offset + Range.Length;
+            Run.First = SortedIndex;
+            Run.Last = SortedIndex;
+            continue;
+        }
+        FRun& Run = OutRuns.Last();
+        Run.bChained = Run.bChained && Range.Offset == Run.End;
+        Run.End = FMath::Max(Run.End, Range.Offset + Range.Length);
+        Run.Last = SortedIndex;
+    }
+}
+}  // namespace AGTBatchRead
+
+FAGTPositionalReader::~FAGTPositionalReader()
+{
+    Close();
+}
+
+bool FAGTPositionalReader::Open(const FString& FilePath)
+{
+    Close();
+    Path = FilePath;
+
+    // A file the physical layer does not have lives in a pak or a sandbox, only the platform file chain can read it
+    IPlatformFile& Physical = IPlatformFile::GetPlatformPhysical();
+    NativePath = Physical.ConvertToAbsolutePathForExternalAppForRead(*FilePath);
+    if (!Physical.FileExists(*FilePath) || !OpenNative(NativePath))
+    {
+        FallbackHandle = FPlatformFileManager::Get().GetPlatformFile().OpenRead(*FilePath, true);
+    }
+    if (!IsOpen() || !ReadOpenIdentity(OpenIdentity))
+    {
+        Close();
+        return false;
+    }
+    RefreshSize();
+    return true;
+}
+
+bool FAGTPositionalReader::OpenNative(const FString& InNativePath)
+{
+#if PLATFORM_WINDOWS
+    // Overlapped so concurrent reads are not serialized on the file object
+    HANDLE Handle = ::CreateFileW(*InNativePath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
+    NativeHandle = Handle != INVALID_HANDLE_VALUE ? Handle : nullptr;
+#elif PLATFORM_UNIX || PLATFORM_MAC
+    Descriptor = ::open(TCHAR_TO_UTF8(*InNativePath), O_RDONLY | O_CLOEXEC);
+#endif
+    return IsNative();
+}
+
+void FAGTPositionalReader::Close()
+{
+#if PLATFORM_WINDOWS
+    if (NativeHandle)
+    {
+        ::CloseHandle(NativeHandle);
+        NativeHandle = nullptr;
+    }
+#elif PLATFORM_UNIX || PLATFORM_MAC
+    if (Descriptor >= 0)
+    {
+        ::close(Descriptor);
+        Descriptor = -1;
+    }
+#endif
+    if (FallbackHandle)
+    {
+        delete FallbackHandle;
+        FallbackHandle = nullptr;
+    }
+    FileSize = 0;
+    OpenIdentity = FAGTFileIdentity();
+}
+
+bool FAGTPositionalReader::ReadOpenIdentity(FAGTFileIdentity& OutIdentity) const
+{
+#if PLATFORM_WINDOWS
+    if (NativeHandle)
+    {
+        return AGTFileIdentity::FromHandle(NativeHandle, OutIdentity);
+    }
+#elif PLATFORM_UNIX || PLATFORM_MAC
+    struct stat Stat;
+    if (Descriptor >= 0)
+    {
+        return ::fstat(Descriptor, &Stat) == 0 && AGTFileIdentity::FromStat(Stat, OutIdentity);
+    }
+#endif
+    return AGTFileIdentity::FromStatData(FPlatformFileManager::Get().GetPlatformFile().GetStatData(*Path), OutIdentity);
+}
+
+bool FAGTPositionalReader::ReadPathIdentity(FAGTFileIdentity& OutIdentity) const
+{
+#if PLATFORM_WINDOWS
+    if (NativeHandle)
+    {
+        // Attribute-only open, the file index is not part of the directory entry
+        HANDLE Handle = ::CreateFileW(*NativePath, FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (Handle == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+        const bool bRead = AGTFileIdentity::FromHandle(Handle, OutIdentity);
+        ::CloseHandle(Handle);
+        return bRead;
+    }
+#elif PLATFORM_UNIX || PLATFORM_MAC
+    struct stat Stat;
+    if (Descriptor >= 0)
+    {
+        return ::stat(TCHAR_TO_UTF8(*NativePath), &Stat) == 0 && AGTFileIdentity::FromStat(Stat, OutIdentity);
+    }
+#endif
+    return AGTFileIdentity::FromStatData(FPlatformFileManager::Get().GetPlatformFile().GetStatData(*Path), OutIdentity);
+}
+
+int64 FAGTPositionalReader::RefreshSize() const
+{
+    int64 NewSize = -1;
+#if PLATFORM_WINDOWS
+    LARGE_INTEGER Native;
+    if (NativeHandle && ::GetFileSizeEx(NativeHandle, &Native))
+    {
+        NewSize = Native.QuadPart;
+    }
+#elif PLATFORM_UNIX || PLATFORM_MAC
+    struct stat Stat;
+    if (Descriptor >= 0 && ::fstat(Descriptor, &Stat) == 0)
+    {
+        NewSize = Stat.st_size;
+    }
+#endif
+    if (FallbackHandle)
+    {
+        FScopeLock ScopeLock(&FallbackLock);
+        NewSize = FallbackHandle->Size();
+    }
+    if (NewSize >= 0)
+    {
+        FileSize.store(NewSize, std::memory_order_relaxed);
+    }
+    return Size();
+}
+
+int64 FAGTPositionalReader::SizeForRead(int64 Offset, int64 Length) const
+{
+    // Only a read past the known end asks the file, a handle that is also written may have grown since
+    const int64 Known = Size();
+    return Offset >= Known || Length > Known - Offset ? RefreshSize() : Known;
+}
+
+bool FAGTPositionalReader::IsNative() const
+{
+#if PLATFORM_WINDOWS
+    return NativeHandle != nullptr;
+#elif PLATFORM_UNIX || PLATFORM_MAC
+    return Descriptor >= 0;
+#else
+    return false;
+#endif
+}
+
+bool FAGTPositionalReader::IsOpen() const
+{
+    return IsNative() || FallbackHandle != nullptr;
+}
+
+int64 FAGTPositionalReader::ReadAt(int64 Offset, void* Dest, int64 Length) const
+{
+    if (!IsOpen() || Offset < 0 || Length < 0)
+    {
+        return -1;
+    }
+
+    uint8* Out = static_cast<uint8*>(Dest);
+    int64 Total = 0;
+    if (FallbackHandle)
+    {
+        FScopeLock ScopeLock(&FallbackLock);
+        const int64 ToRead = FMath::Min(Length, FallbackHandle->Size() - Offset);
+        if (ToRead > 0 && FallbackHandle->Seek(Offset) && FallbackHandle->Read(Out, ToRead))
+        {
+            Total = ToRead;
+        }
+        return Total;
+    }
+
+#if PLATFORM_WINDOWS
+    HANDLE Event = ::CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!Event)
+    {
+        return -1;
+    }
+    while (Total < Length)
+    {
+        OVERLAPPED Overlapped = {};
+        const uint64 Position = static_cast<uint64>(Offset + Total);
+        Overlapped.Offset = static_cast<DWORD>(Position & 0xFFFFFFFF);
+        Overlapped.OffsetHigh = static_cast<DWORD>(Position >> 32);
+        Overlapped.hEvent = Event;
+
+        const DWORD ToRead = static_cast<DWORD>(FMath::Min<int64>(Length - Total, MAX_int32));
+        DWORD NumRead = 0;
+        if (!::ReadFile(NativeHandle, Out + Total, ToRead, nullptr, &Overlapped) && ::GetLastError() != ERROR_IO_PENDING)
+        {
+            break;
+        }
+        if (!::GetOverlappedResult(NativeHandle, &Overlapped, &NumRead, TRUE) || NumRead == 0)
+        {
+            break;
+        }
+        Total += NumRead;
+    }
+    ::CloseHandle(Event);
+#elif PLATFORM_UNIX || PLATFORM_MAC
+    while (Total < Length)
+    {
+        const ssize_t NumRead = ::pread(Descriptor, Out + Total, static_cast<size_t>(Length - Total), static_cast<off_t>(Offset + Total));
+        if (NumRead < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (NumRead <= 0)
+        {
+            // 0 is the end of the file
+            if (NumRead < 0)
+            {
+                return -1;
+            }
+            break;
+        }
+        Total += NumRead;
+    }
+#endif
+    return Total;
+}
+
+bool FAGTPositionalReader::ReadAt(int64 Offset, int64 Length, TArray<uint8>& Out) const
+{
+    const int64 ToRead = FMath::Min(Length, SizeForRead(Offset, Length) - Offset);
+    if (ToRead <= 0 || ToRead > MAX_int32)
+    {
+        return false;
+    }
+    Out.SetNumUninitialized(static_cast<int32>(ToRead));
+    const int64 NumRead = ReadAt(Offset, Out.GetData(), ToRead);
+    if (NumRead < 0)
+    {
+        Out.Reset();
+        return false;
+    }
+    Out.SetNum(static_cast<int32>(NumRead), false);
+    return true;
+}
+
+bool FAGTPositionalReader::ReadRanges(TArrayView<const FAGTReadRange> Ranges, TArray<uint8>& OutBuffer, TArray<FAGTReadRange>& OutSlices) const
+{
+    OutBuffer.Reset();
+    OutSlices.Reset();
+    if (!IsOpen())
+    {
+        return false;
+    }
+
+    // One refresh covers every range that reaches past the known end
+    int64 CurrentSize = Size();
+    for (const FAGTReadRange& Range : Ranges)
+    {
+        if (Range.Offset >= CurrentSize || Range.Length > CurrentSize - Range.Offset)
+        {
+            CurrentSize = RefreshSize();
+            break;
+        }
+    }
+
+    TArray<FAGTReadRange> Clamped;
+    TArray<int32> Sorted;
+    TArray<AGTBatchRead::FRun> Runs;
+    AGTBatchRead::BuildRuns(Ranges, CurrentSize, Clamped, Sorted, Runs);
+
+    int64 Total = 0;
+    for (const AGTBatchRead::FRun& Run : Runs)
+    {
+        Total += Run.End - Run.Offset;
+    }
+    if (Total > MAX_int32)
+    {
+        return false;
+    }
+
+    OutBuffer.SetNumUninitialized(static_cast<int32>(Total));
+    OutSlices.SetNum(Ranges.Num());
+    int64 Base = 0;
+    for (const AGTBatchRead::FRun& Run : Runs)
+    {
+        const int64 RunLength = Run.End - Run.Offset;
+        if (ReadAt(Run.Offset, OutBuffer.GetData() + Base, RunLength) != RunLength)
+        {
+            OutBuffer.Reset();
+            OutSlices.Reset();
+            return false;
+        }
+        for (int32 SortedIndex = Run.First; SortedIndex <= Run.Last; ++SortedIndex)
+        {
+            const int32 Index = Sorted[SortedIndex];
+            OutSlices[Index].Offset = Base + (Clamped[Index].Offset - Run.Offset);
+            OutSlices[Index].Length = Clamped[Index].Length;
+        }
+        Base += RunLength;
+    }
+    return true;
+}
+
+bool FAGTPositionalReader::ReadRanges(TArrayView<const FAGTReadRange> Ranges, TArray<TArray<uint8>>& OutChunks) const
+{
+    OutChunks.Reset();
+    if (!IsOpen())
+    {
+        return false;
+    }
+
+    // One refresh covers every range that reaches past the known end
+    int64 CurrentSize = Size();
+    for (const FAGTReadRange& Range : Ranges)
+    {
+        if (Range.Offset >= CurrentSize || Range.Length > CurrentSize - Range.Offset)
+        {
+            CurrentSize = RefreshSize();
+            break;
+        }
+    }
+
+    TArray<FAGTReadRange> Clamped;
+    TArray<int32> Sorted;
+    TArray<AGTBatchRead::FRun> Runs;
+    AGTBatchRead::BuildRuns(Ranges, CurrentSize, Clamped, Sorted, Runs);
+
+    OutChunks.SetNum(Ranges.Num());
+    for (int32 Index = 0; Index < Ranges.Num(); ++Index)
+    {
+        if (Clamped[Index].Length > MAX_int32)
+        {
+            return false;
+        }
+        OutChunks[Index].SetNumUninitialized(static_cast<int32>(Clamped[Index].Length));
+    }
+
+    TArray<uint8> Scratch;
+    for (const AGTBatchRead::FRun& Run : Runs)
+    {
+        const int64 RunLength = Run.End - Run.Offset;
+        if (Run.First == Run.Last)
+        {
+            TArray<uint8>& Chunk = OutChunks[Sorted[Run.First]];
+            if (ReadAt(Run.Offset, Chunk.GetData(), Chunk.Num()) != Chunk.Num())
+            {
+                return false;
+            }
+            continue;
+        }
+#if PLATFORM_LINUX
+        if (Run.bChained && Descriptor >= 0)
+        {
+            // Adjacent ranges, the kernel scatters the run straight into the output arrays
+            TArray<struct iovec, TInlineAllocator<64>> Vectors;
+            int64 Position = Run.Offset;
+            for (int32 SortedIndex = Run.First; SortedIndex <= Run.Last + 1; ++SortedIndex)
+            {
+                if (SortedIndex > Run.Last || Vectors.Num() == IOV_MAX)
+                {
+                    int32 Vector = 0;
+                    while (Vector < Vectors.Num())
+                    {
+                        const ssize_t NumRead = ::preadv(Descriptor, Vectors.GetData() + Vector, Vectors.Num() - Vector, static_cast<off_t>(Position));
+                        if (NumRead < 0 && errno == EINTR)
+                        {
+                            continue;
+                        }
+                        if (NumRead <= 0)
+                        {
+                            return false;
+                        }
+                        Position += NumRead;
+                        // Skip the vectors that were filled completely and trim the one that was filled in part
+                        for (size_t Remaining = static_cast<size_t>(NumRead); Remaining > 0 && Vector < Vectors.Num();)
+                        {
+                            struct iovec& Current = Vectors[Vector];
+                            const size_t Used = FMath::Min(Remaining, Current.iov_len);
+                            Current.iov_base = static_cast<uint8*>(Current.iov_base) + Used;
+                            Current.iov_len -= Used;
+                            Remaining -= Used;
+                            if (Current.iov_len == 0)
+                            {
+                                ++Vector;
+                            }
+                        }
+                    }
+                    Vectors.Reset();
+                }
+                if (SortedIndex <= Run.Last)
+                {
+                    TArray<uint8>& Chunk = OutChunks[Sorted[SortedIndex]];
+                    if (Chunk.Num() > 0)
+                    {
+                        Vectors.Add({Chunk.GetData(), static_cast<size_t>(Chunk.Num())});
+                    }
+                }
+            }
+            continue;
+        }
+#endif
+        // Overlapping ranges, read the run once and copy the pieces out
+        if (RunLength > MAX_int32)
+        {
+            return false;
+        }
+        Scratch.SetNumUninitialized(static_cast<int32>(RunLength), false);
+        if (ReadAt(Run.Offset, Scratch.GetData(), RunLength) != RunLength)
+        {
+            return false;
+        }
+        for (int32 SortedIndex = Run.First; SortedIndex <= Run.Last; ++SortedIndex)
+        {
+            const int32 Index = Sorted[SortedIndex];
+            FMemory::Memcpy(OutChunks[Index].GetData(), Scratch.GetData() + (Clamped[Index].Offset - Run.Offset), OutChunks[Index].Num());
+        }
+    }
+    return true;
+}
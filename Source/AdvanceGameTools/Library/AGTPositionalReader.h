@@ -0,0 +1,94 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AdvanceGameTools/AGTDataTypes.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include <atomic>
+
+/** @struct Size, modification time at full precision and file id (inode or NTFS file index). A file replaced under the same name gets a new id **/
+struct FAGTFileIdentity
+{
+    int64 Size{-1};
+    int64 ModificationTime{0};
+    uint64 FileId{0};
+
+    bool operator==(const FAGTFileIdentity& Other) const { return Size == Other.Size && ModificationTime == Other.ModificationTime && FileId == Other.FileId; }
+};
+
+/**
+ * @class Read-only file that is read at explicit offsets.
+ * There is no shared cursor, so any number of threads can read from one instance at the same time.
+ * Uses pread on POSIX and offset reads on Windows for files on disk.
+ * Files the physical layer does not have, such as those inside a pak, and every file on other platforms go through a regular handle shared behind a lock.
+ */
+class ADVANCEGAMETOOLS_API FAGTPositionalReader
+{
+public:
+    FAGTPositionalReader() = default;
+    ~FAGTPositionalReader();
+
+    FAGTPositionalReader(const FAGTPositionalReader&) = delete;
+    FAGTPositionalReader& operator=(const FAGTPositionalReader&) = delete;
+
+    bool Open(const FString& FilePath);
+    void Close();
+    bool IsOpen() const;
+
+    /** @public Identity of the file this reader has open, taken from the handle when it was opened **/
+    const FAGTFileIdentity& GetOpenIdentity() const { return OpenIdentity; }
+
+    /** @public Identity of what the path names now, through the layer the reader was opened from. False if it is gone or not a file **/
+    bool ReadPathIdentity(FAGTFileIdentity& OutIdentity) const;
+
+    /** @public Size of the file as last seen. Reads that reach past it ask the file again, so bytes appended after Open are still found **/
+    int64 Size() const { return FileSize.load(std::memory_order_relaxed); }
+
+    /** @public Takes the size from the open file again and returns it **/
+    int64 RefreshSize() const;
+    const FString& GetPath() const { return Path; }
+
+    /** @public Reads up to Length bytes at Offset into Dest. Returns the number of bytes read, or -1 on error. Thread safe **/
+    int64 ReadAt(int64 Offset, void* Dest, int64 Length) const;
+
+    /** @public Reads Length bytes at Offset, clamped to the end of the file. Resizes Out **/
+    bool ReadAt(int64 Offset, int64 Length, TArray<uint8>& Out) const;
+
+    /**
+     * @public Reads many ranges in one pass.
+     * Ranges are sorted and overlapping or adjacent ones are merged, so every merged run costs one read.
+     * The runs are stored back to back in OutBuffer, OutSlices[i] tells where range i ended up. Ranges are clamped to the end of the file.
+     */
+    bool ReadRanges(TArrayView<const FAGTReadRange> Ranges, TArray<uint8>& OutBuffer, TArray<FAGTReadRange>& OutSlices) const;
+
+    /** @public Same as above with one array per range. On Linux a run of adjacent ranges is scattered into the arrays by a single preadv **/
+    bool ReadRanges(TArrayView<const FAGTReadRange> Ranges, TArray<TArray<uint8>>& OutChunks) const;
+
+private:
+    /** @private Cached size, or the refreshed one when [Offset, Offset + Length) reaches past it **/
+    int64 SizeForRead(int64 Offset, int64 Length) const;
+
+    /** @private Opens the file on disk directly. Returns false when the platform has no offset reads **/
+    bool OpenNative(const FString& InNativePath);
+
+    bool IsNative() const;
+
+    /** @private Identity of the open handle, false if it is not a regular file **/
+    bool ReadOpenIdentity(FAGTFileIdentity& OutIdentity) const;
+
+    FString Path;
+    FString NativePath;
+    FAGTFileIdentity OpenIdentity;
+    mutable std::atomic<int64> FileSize{0};
+
+#if PLATFORM_WINDOWS
+    void* NativeHandle{nullptr};
+#elif PLATFORM_UNIX || PLATFORM_MAC
+    int32 Descriptor{-1};
+#endif
+    IFileHandle* FallbackHandle{nullptr};
+    mutable FCriticalSection FallbackLock;
+};
+
+typedef TSharedPtr<FAGTPositionalReader, ESPMode::ThreadSafe> FAGTPositionalReaderPtr;
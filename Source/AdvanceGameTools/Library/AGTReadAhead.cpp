@@ -0,0 +1,135 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTReadAhead.h"
+#include "Async/Async.h"
+
+FAGTReadAhead::FAGTReadAhead(const FAGTPositionalReaderPtr& InReader, int32 InChunkSize, int32 InNumChunks)
+    : Reader(InReader), ChunkSize(FMath::Max(InChunkSize, 4096))
+{
+    Slots.SetNum(FMath::Max(InNumChunks, 2));
+}
+
+FAGTReadAhead::~FAGTReadAhead()
+{
+    Invalidate();
+}
+
+void FAGTReadAhead::Invalidate()
+{
+    for (FSlot& Slot : Slots)
+    {
+        if (Slot.Pending.IsValid())
+        {
+            Slot.Pending.Wait();
+            Slot.Pending.Reset();
+        }
+        Slot.Chunk = INDEX_NONE;
+        Slot.NumBytes = 0;
+    }
+}
+
+void FAGTReadAhead::Prefetch(int64 Chunk)
+{
+    const int64 Offset = Chunk * ChunkSize;
+    if (Offset >= Reader->Size())
+    {
+        return;
+    }
+
+    FSlot& Slot = Slots[Chunk % Slots.Num()];
+    if (Slot.Chunk == Chunk)
+    {
+        return;
+    }
+    if (Slot.Pending.IsValid())
+    {
+        // Still loading an older chunk, the buffer cannot be reused before it is done
+        Slot.Pending.Wait();
+        Slot.Pending.Reset();
+    }
+
+    Slot.Chunk = Chunk;
+    Slot.NumBytes = 0;
+    Slot.Data.SetNumUninitialized(ChunkSize, false);
+    const int64 Length = FMath::Min<int64>(ChunkSize, Reader->Size() - Offset);
+    uint8* Dest = Slot.Data.GetData();
+    Slot.Pending = Async(EAsyncExecution::ThreadPool, [Reader = Reader, Offset, Dest, Length]() { return Reader->ReadAt(Offset, Dest, Length); });
+}
+
+FAGTReadAhead::FSlot* FAGTReadAhead::Acquire(int64 Chunk, bool& bOutWaited)
+{
+    FSlot& Slot = Slots[Chunk % Slots.Num()];
+    if (Slot.Chunk != Chunk)
+    {
+        return nullptr;
+    }
+    if (Slot.Pending.IsValid())
+    {
+        bOutWaited = bOutWaited || !Slot.Pending.IsReady();
+        Slot.NumBytes = Slot.Pending.Get();
+        Slot.Pending.Reset();
+    }
+    if (Slot.NumBytes < 0)
+    {
+        // Failed read, let the next attempt load it again
+        Slot.Chunk = INDEX_NONE;
+        Slot.NumBytes = 0;
+        return nullptr;
+    }
+    return &Slot;
+}
+
+int64 FAGTReadAhead::Read(int64 Offset, uint8* Dest, int64 Length)
+{
+    if (!Reader.IsValid() || Offset < 0)
+    {
+        return -1;
+    }
+
+    int64 Copied = 0;
+    bool bWaited = false;
+    while (Copied < Length)
+    {
+        const int64 Position = Offset + Copied;
+        const int64 Chunk = Position / ChunkSize;
+
+        FSlot* Slot = Acquire(Chunk, bWaited);
+        if (!Slot)
+        {
+            // Not prefetched, the consumer jumped or just started
+            bWaited = true;
+            Prefetch(Chunk);
+            Slot = Acquire(Chunk, bWaited);
+            if (!Slot)
+            {
+                return Copied > 0 ? Copied : -1;
+            }
+        }
+
+        // Keep the ring filled with the chunks that follow
+        for (int32 Ahead = 1; Ahead < Slots.Num(); ++Ahead)
+        {
+            Prefetch(Chunk + Ahead);
+        }
+
+        const int64 InChunk = Position - Chunk * ChunkSize;
+        const int64 ToCopy = FMath::Min(Length - Copied, Slot->NumBytes - InChunk);
+        if (ToCopy <= 0)
+        {
+            // End of the file
+            break;
+        }
+        FMemory::Memcpy(Dest + Copied, Slot->Data.GetData() + InChunk, ToCopy);
+        Copied += ToCopy;
+    }
+
+    if (bWaited)
+    {
+        ++Misses;
+    }
+    else
+    {
+        ++Hits;
+    }
+    return Copied;
+}
@@ -0,0 +1,56 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "AdvanceGameTools/Library/AGTPositionalReader.h"
+
+/**
+ * @class Sequential read-ahead on top of a positional reader.
+ * The file is split into fixed chunks. A ring of buffers holds the chunk being consumed and prefetches the following ones on the thread pool,
+ * so a reader walking through the file usually finds its data already in memory. A jump elsewhere restarts the ring at the new position.
+ * Meant for a single consumer thread.
+ */
+class ADVANCEGAMETOOLS_API FAGTReadAhead
+{
+public:
+    FAGTReadAhead(const FAGTPositionalReaderPtr& InReader, int32 InChunkSize, int32 InNumChunks);
+    ~FAGTReadAhead();
+
+    FAGTReadAhead(const FAGTReadAhead&) = delete;
+    FAGTReadAhead& operator=(const FAGTReadAhead&) = delete;
+
+    /** @public Copies Length bytes at Offset into Dest. Returns the number of bytes copied, or -1 on error **/
+    int64 Read(int64 Offset, uint8* Dest, int64 Length);
+
+    /** @public Drops every prefetched chunk, for example after the file was written to **/
+    void Invalidate();
+
+    /** @public Reads served from a chunk that was ready **/
+    int64 GetHits() const { return Hits; }
+
+    /** @public Reads that had to wait for the disk **/
+    int64 GetMisses() const { return Misses; }
+
+private:
+    struct FSlot
+    {
+        int64 Chunk{INDEX_NONE};
+        TArray<uint8> Data;
+        TFuture<int64> Pending;
+        int64 NumBytes{0};
+    };
+
+    /** @private Starts loading a chunk into its slot unless it is there already **/
+    void Prefetch(int64 Chunk);
+
+    /** @private Waits for the slot and returns it if it holds the chunk **/
+    FSlot* Acquire(int64 Chunk, bool& bOutWaited);
+
+    FAGTPositionalReaderPtr Reader;
+    int32 ChunkSize;
+    TArray<FSlot> Slots;
+    int64 Hits{0};
+    int64 Misses{0};
+};
@@ -0,0 +1,711 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTSha256.h"
+#include "HAL/IConsoleManager.h"
+#include <AdvanceGameTools/ThirdParty/SHA/picosha2.h>
+
+#if PLATFORM_CPU_X86_FAMILY
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define AGT_SHA_TARGET
+#define AGT_AVX2_TARGET
+#else
+#include <cpuid.h>
+#define AGT_SHA_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+#define AGT_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#define AGT_SHA_X86 1
+#elif PLATFORM_CPU_ARM_FAMILY && PLATFORM_64BITS
+#include <arm_neon.h>
+#define AGT_SHA_NEON 1
+#if defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO)
+#define AGT_SHA_ARM 1
+#endif
+#endif
+
+#ifndef AGT_SHA_X86
+#define AGT_SHA_X86 0
+#endif
+#ifndef AGT_SHA_ARM
+#define AGT_SHA_ARM 0
+#endif
+#ifndef AGT_SHA_NEON
+#define AGT_SHA_NEON 0
+#endif
+
+namespace AGTSha256
+{
+static const uint32 InitialState[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+alignas(16) static const uint32 K[64] = {0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be,
+    0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
+    0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e,
+    0x92722c85, 0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3,
+    0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+static void CompressPortable(uint32* State, const uint8* Blocks, int64 NumBlocks)
+{
+    picosha2::word_t Digest[8];
+    for (int32 Index = 0; Index < 8; ++Index)
+    {
+        Digest[Index] = State[Index];
+    }
+    for (; NumBlocks > 0; --NumBlocks, Blocks += FAGTSha256::BlockSize)
+    {
+        picosha2::detail::hash256_block(Digest, Blocks, Blocks + FAGTSha256::BlockSize);
+    }
+    for (int32 Index = 0; Index < 8; ++Index)
+    {
+        // picosha2 words can be wider than 32 bits, only the low half is the state
+        State[Index] = static_cast<uint32>(Digest[Index] & 0xffffffff);
+    }
+}
+
+#if AGT_SHA_X86
+static bool HasShaNi()
+{
+    int32 Leaf1[4] = {0};
+    int32 Leaf7[4] = {0};
+#if defined(_MSC_VER) && !defined(__clang__)
+    __cpuid(Leaf1, 1);
+    __cpuidex(Leaf7, 7, 0);
+#else
+    unsigned int A, B, C, D;
+    if (!__get_cpuid(1, &A, &B, &C, &D))
+    {
+        return false;
+    }
+    Leaf1[2] = static_cast<int32>(C);
+    if (!__get_cpuid_count(7, 0, &A, &B, &C, &D))
+    {
+        return false;
+    }
+    Leaf7[1] = static_cast<int32>(B);
+#endif
+    const bool bSsse3 = (Leaf1[2] & (1 << 9)) != 0;
+    const bool bSse41 = (Leaf1[2] & (1 << 19)) != 0;
+    const bool bSha = (Leaf7[1] & (1 << 29)) != 0;
+    return bSsse3 && bSse41 && bSha;
+}
+
+AGT_SHA_TARGET static void CompressShaNi(uint32* State, const uint8* Blocks, int64 NumBlocks)
+{
+    const __m128i ByteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // The instructions want the state as ABEF and CDGH
+    __m128i Tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&State[0])), 0xB1);
+    __m128i State1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&State[4])), 0x1B);
+    __m128i State0 = _mm_alignr_epi8(Tmp, State1, 8);
+    State1 = _mm_blend_epi16(State1, Tmp, 0xF0);
+
+    for (; NumBlocks > 0; --NumBlocks, Blocks += FAGTSha256::BlockSize)
+    {
+        const __m128i SavedAbef = State0;
+        const __m128i SavedCdgh = State1;
+
+        // Ring of the last 16 message words, four per register
+        __m128i Words[4];
+        for (int32 Index = 0; Index < 4; ++Index)
+        {
+            Words[Index] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Blocks + Index * 16)), ByteSwap);
+        }
+
+        for (int32 Group = 0; Group < 16; ++Group)
+        {
+            __m128i& Current = Words[Group & 3];
+            if (Group >= 4)
+            {
+                const __m128i& Next = Words[(Group + 1) & 3];
+                const __m128i& Third = Words[(Group + 2) & 3];
+                const __m128i& Last = Words[(Group + 3) & 3];
+                Current = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(Current, Next), _mm_alignr_epi8(Last, Third, 4)), Last);
+            }
+            __m128i Message = _mm_add_epi32(Current, _mm_load_si128(reinterpret_cast<const __m128i*>(&K[Group * 4])));
+            State1 = _mm_sha256rnds2_epu32(State1, State0, Message);
+            Message = _mm_shuffle_epi32(Message, 0x0E);
+            State0 = _mm_sha256rnds2_epu32(State0, State1, Message);
+        }
+
+        State0 = _mm_add_epi32(State0, SavedAbef);
+        State1 = _mm_add_epi32(State1, SavedCdgh);
+    }
+
+    Tmp = _mm_shuffle_epi32(State0, 0x1B);
+    State1 = _mm_shuffle_epi32(State1, 0xB1);
+    State0 = _mm_blend_epi16(Tmp, State1, 0xF0);
+    State1 = _mm_alignr_epi8(State1, Tmp, 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&State[0]), State0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&State[4]), State1);
+}
+#endif
+
+#if AGT_SHA_ARM
+static void CompressArmSha2(uint32* State, const uint8* Blocks, int64 NumBlocks)
+{
+    uint32x4_t State0 = vld1q_u32(&State[0]);
+    uint32x4_t State1 = vld1q_u32(&State[4]);
+
+    for (; NumBlocks > 0; --NumBlocks, Blocks += FAGTSha256::BlockSize)
+    {
+        const uint32x4_t SavedAbcd = State0;
+        const uint32x4_t SavedEfgh = State1;
+
+        uint32x4_t Words[4];
+        for (int32 Index = 0; Index < 4; ++Index)
+        {
+            Words[Index] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(Blocks + Index * 16)));
+        }
+
+        for (int32 Group = 0; Group < 16; ++Group)
+        {
+            uint32x4_t& Current = Words[Group & 3];
+            if (Group >= 4)
+            {
+                Current = vsha256su1q_u32(vsha256su0q_u32(Current, Words[(Group + 1) & 3]), Words[(Group + 2) & 3], Words[(Group + 3) & 3]);
+            }
+            const uint32x4_t Message = vaddq_u32(Current, vld1q_u32(&K[Group * 4]));
+            const uint32x4_t Previous = State0;
+            State0 = vsha256hq_u32(State0, State1, Message);
+            State1 = vsha256h2q_u32(State1, Previous, Message);
+        }
+
+        State0 = vaddq_u32(State0, SavedAbcd);
+        State1 = vaddq_u32(State1, SavedEfgh);
+    }
+
+    vst1q_u32(&State[0], State0);
+    vst1q_u32(&State[4], State1);
+}
+#endif
+
+static FAGTSha256::FCompressFunction GetCompress(FAGTSha256::EBackend Backend)
+{
+    switch (Backend)
+    {
+#if AGT_SHA_X86
+        case FAGTSha256::EBackend::ShaNi: return &CompressShaNi;
+#endif
+#if AGT_SHA_ARM
+        case FAGTSha256::EBackend::ArmSha2: return &CompressArmSha2;
+#endif
+        default: return &CompressPortable;
+    }
+}
+
+static FORCEINLINE uint32 LoadBigEndian(const uint8* Data)
+{
+    return (static_cast<uint32>(Data[0]) << 24) | (static_cast<uint32>(Data[1]) << 16) | (static_cast<uint32>(Data[2]) << 8) | static_cast<uint32>(Data[3]);
+}
+
+static void HashBatchSingle(const TArrayView<const uint8>* Messages, int32 Num, uint8* OutDigests)
+{
+    FAGTSha256 Hasher;
+    for (int32 Index = 0; Index < Num; ++Index)
+    {
+        Hasher.Update(Messages[Index].GetData(), Messages[Index].Num());
+        Hasher.Final(OutDigests + static_cast<int64>(Index) * FAGTSha256::DigestSize);
+    }
+}
+
+#if AGT_SHA_X86
+static bool HasAvx2()
+{
+    int32 Leaf1[4] = {0};
+    int32 Leaf7[4] = {0};
+#if defined(_MSC_VER) && !defined(__clang__)
+    __cpuid(Leaf1, 1);
+    __cpuidex(Leaf7, 7, 0);
+#else
+    unsigned int A, B, C, D;
+    if (!__get_cpuid(1, &A, &B, &C, &D))
+    {
+        return false;
+    }
+    Leaf1[2] = static_cast<int32>(C);
+    if (!__get_cpuid_count(7, 0, &A, &B, &C, &D))
+    {
+        return false;
+    }
+    Leaf7[1] = static_cast<int32>(B);
+#endif
+    const bool bOsXSave = (Leaf1[2] & (1 << 27)) != 0;
+    const bool bAvx = (Leaf1[2] & (1 << 28)) != 0;
+    const bool bAvx2 = (Leaf7[1] & (1 << 5)) != 0;
+    if (!bOsXSave || !bAvx || !bAvx2)
+    {
+        return false;
+    }
+
+    // The OS has to save the upper halves of the YMM registers on context switches
+#if defined(_MSC_VER) && !defined(__clang__)
+    const uint64 Enabled = _xgetbv(0);
+#else
+    uint32 Low, High;
+    __asm__ volatile("xgetbv" : "=a"(Low), "=d"(High) : "c"(0));
+    const uint64 Enabled = (static_cast<uint64>(High) << 32) | Low;
+#endif
+    return (Enabled & 0x6) == 0x6;
+}
+
+namespace Sse2
+{
+struct FLanes
+{
+    typedef __m128i V;
+    static constexpr int32 Width = 4;
+
+    static FORCEINLINE V Add(V A, V B) { return _mm_add_epi32(A, B); }
+    static FORCEINLINE V Xor(V A, V B) { return _mm_xor_si128(A, B); }
+    static FORCEINLINE V And(V A, V B) { return _mm_and_si128(A, B); }
+    static FORCEINLINE V Or(V A, V B) { return _mm_or_si128(A, B); }
+    /** ~A & B */
+    static FORCEINLINE V AndNot(V A, V B) { return _mm_andnot_si128(A, B); }
+    static FORCEINLINE V Set1(uint32 Value) { return _mm_set1_epi32(static_cast<int32>(Value)); }
+    static FORCEINLINE V Load(const uint32* Data) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(Data)); }
+    static FORCEINLINE void Store(uint32* Data, V Value) { _mm_storeu_si128(reinterpret_cast<__m128i*>(Data), Value); }
+
+    template <int32 Bits>
+    static FORCEINLINE V Rotr(V Value)
+    {
+        return _mm_or_si128(_mm_srli_epi32(Value, Bits), _mm_slli_epi32(Value, 32 - Bits));
+    }
+
+    template <int32 Bits>
+    static FORCEINLINE V Shr(V Value)
+    {
+        return _mm_srli_epi32(Value, Bits);
+    }
+
+    /** Word of every lane's block, lane 0 in the lowest element */
+    static FORCEINLINE V Gather(const uint8* const* Blocks, int32 Word)
+    {
+        const int32 Offset = Word * 4;
+        return _mm_set_epi32(static_cast<int32>(LoadBigEndian(Blocks[3] + Offset)), static_cast<int32>(LoadBigEndian(Blocks[2] + Offset)),
+            static_cast<int32>(LoadBigEndian(Blocks[1] + Offset)), static_cast<int32>(LoadBigEndian(Blocks[0] + Offset)));
+    }
+};
+
+#define AGT_LANES_TARGET
+#include "AdvanceGameTools/Library/AGTSha256Lanes.inl"
+#undef AGT_LANES_TARGET
+}  // namespace Sse2
+
+namespace Avx2
+{
+struct FLanes
+{
+    typedef __m256i V;
+    static constexpr int32 Width = 8;
+
+    AGT_AVX2_TARGET static FORCEINLINE V Add(V A, V B) { return _mm256_add_epi32(A, B); }
+    AGT_AVX2_TARGET static FORCEINLINE V Xor(V A, V B) { return _mm256_xor_si256(A, B); }
+    AGT_AVX2_TARGET static FORCEINLINE V And(V A, V B) { return _mm256_and_si256(A, B); }
+    AGT_AVX2_TARGET static FORCEINLINE V Or(V A, V B) { return _mm256_or_si256(A, B); }
+    /** ~A & B */
+    AGT_AVX2_TARGET static FORCEINLINE V AndNot(V A, V B) { return _mm256_andnot_si256(A, B); }
+    AGT_AVX2_TARGET static FORCEINLINE V Set1(uint32 Value) { return _mm256_set1_epi32(static_cast<int32>(Value)); }
+    AGT_AVX2_TARGET static FORCEINLINE V Load(const uint32* Data) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Data)); }
+    AGT_AVX2_TARGET static FORCEINLINE void Store(uint32* Data, V Value) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(Data), Value); }
+
+    template <int32 Bits>
+    AGT_AVX2_TARGET static FORCEINLINE V Rotr(V Value)
+    {
+        return _mm256_or_si256(_mm256_srli_epi32(Value, Bits), _mm256_slli_epi32(Value, 32 - Bits));
+    }
+
+    template <int32 Bits>
+    AGT_AVX2_TARGET static FORCEINLINE V Shr(V Value)
+    {
+        return _mm256_srli_epi32(Value, Bits);
+    }
+
+    /** Word of every lane's block, lane 0 in the lowest element */
+    AGT_AVX2_TARGET static FORCEINLINE V Gather(const uint8* const* Blocks, int32 Word)
+    {
+        const int32 Offset = Word * 4;
+        return _mm256_set_epi32(static_cast<int32>(LoadBigEndian(Blocks[7] + Offset)), static_cast<int32>(LoadBigEndian(Blocks[6] + Offset)),
+            static_cast<int32>(LoadBigEndian(Blocks[5] + Offset)), static_cast<int32>(LoadBigEndian(Blocks[4] + Offset)),
+            static_cast<int32>(LoadBigEndian(Blocks[3] + Offset)), static_cast<int32>(LoadBigEndian(Blocks[2] + Offset)),
+            static_cast<int32>(LoadBigEndian(Blocks[1] + Offset)), static_cast<int32>(LoadBigEndian(Blocks[0] + Offset)));
+    }
+};
+
+#define AGT_LANES_TARGET AGT_AVX2_TARGET
+#include "AdvanceGameTools/Library/AGTSha256Lanes.inl"
+#undef AGT_LANES_TARGET
+}  // namespace Avx2
+#endif
+
+#if AGT_SHA_NEON
+namespace Neon
+{
+struct FLanes
+{
+    typedef uint32x4_t V;
+    static constexpr int32 Width = 4;
+
+    static FORCEINLINE V Add(V A, V B) { return vaddq_u32(A, B); }
+    static FORCEINLINE V Xor(V A, V B) { return veorq_u32(A, B); }
+    static FORCEINLINE V And(V A, V B) { return vandq_u32(A, B); }
+    static FORCEINLINE V Or(V A, V B) { return vorrq_u32(A, B); }
+    /** ~A & B */
+    static FORCEINLINE V AndNot(V A, V B) { return vbicq_u32(B, A); }
+    static FORCEINLINE V Set1(uint32 Value) { return vdupq_n_u32(Value); }
+    static FORCEINLINE V Load(const uint32* Data) { return vld1q_u32(Data); }
+    static FORCEINLINE void Store(uint32* Data, V Value) { vst1q_u32(Data, Value); }
+
+    template <int32 Bits>
+    static FORCEINLINE V Rotr(V Value)
+    {
+        return vsriq_n_u32(vshlq_n_u32(Value, 32 - Bits), Value, Bits);
+    }
+
+    template <int32 Bits>
+    static FORCEINLINE V Shr(V Value)
+    {
+        return vshrq_n_u32(Value, Bits);
+    }
+
+    static FORCEINLINE V Gather(const uint8* const* Blocks, int32 Word)
+    {
+        const int32 Offset = Word * 4;
+        const uint32 Words[4] = {LoadBigEndian(Blocks[0] + Offset), LoadBigEndian(Blocks[1] + Offset), LoadBigEndian(Blocks[2] + Offset), LoadBigEndian(Blocks[3] + Offset)};
+        return vld1q_u32(Words);
+    }
+};
+
+#define AGT_LANES_TARGET
+#include "AdvanceGameTools/Library/AGTSha256Lanes.inl"
+#undef AGT_LANES_TARGET
+}  // namespace Neon
+#endif
+}  // namespace AGTSha256
+
+bool FAGTSha256::IsSupported(EBackend InBackend)
+{
+    switch (InBackend)
+    {
+        case EBackend::Portable: return true;
+#if AGT_SHA_X86
+        case EBackend::ShaNi:
+        {
+            static const bool bHasShaNi = AGTSha256::HasShaNi();
+            return bHasShaNi;
+        }
+#endif
+#if AGT_SHA_ARM
+        case EBackend::ArmSha2: return true;
+#endif
+        default: return false;
+    }
+}
+
+FAGTSha256::EBackend FAGTSha256::GetBestBackend()
+{
+    if (IsSupported(EBackend::ShaNi))
+    {
+        return EBackend::ShaNi;
+    }
+    if (IsSupported(EBackend::ArmSha2))
+    {
+        return EBackend::ArmSha2;
+    }
+    return EBackend::Portable;
+}
+
+const TCHAR* FAGTSha256::GetBackendName(EBackend InBackend)
+{
+    switch (InBackend)
+    {
+        case EBackend::ShaNi: return TEXT("SHA-NI");
+        case EBackend::ArmSha2: return TEXT("ARMv8 SHA2");
+        default: return TEXT("picosha2");
+    }
+}
+
+FAGTSha256::FAGTSha256()
+{
+    static const FCompressFunction Best = AGTSha256::GetCompress(GetBestBackend());
+    Compress = Best;
+    Reset();
+}
+
+FAGTSha256::FAGTSha256(EBackend InBackend)
+{
+    Compress = AGTSha256::GetCompress(IsSupported(InBackend) ? InBackend : EBackend::Portable);
+    Reset();
+}
+
+void FAGTSha256::Reset()
+{
+    FMemory::Memcpy(State, AGTSha256::InitialState, sizeof(State));
+    BufferSize = 0;
+    TotalSize = 0;
+}
+
+void FAGTSha256::Update(const void* Data, int64 Size)
+{
+    const uint8* Bytes = static_cast<const uint8*>(Data);
+    TotalSize += static_cast<uint64>(Size);
+
+    if (BufferSize > 0)
+    {
+        const int32 ToCopy = static_cast<int32>(FMath::Min<int64>(Size, BlockSize - BufferSize));
+        FMemory::Memcpy(Buffer + BufferSize, Bytes, ToCopy);
+        BufferSize += ToCopy;
+        Bytes += ToCopy;
+        Size -= ToCopy;
+        if (BufferSize < BlockSize)
+        {
+            return;
+        }
+        Compress(State, Buffer, 1);
+        BufferSize = 0;
+    }
+
+    // Whole blocks are hashed straight from the input
+    const int64 NumBlocks = Size / BlockSize;
+    if (NumBlocks > 0)
+    {
+        Compress(State, Bytes, NumBlocks);
+        Bytes += NumBlocks * BlockSize;
+        Size -= NumBlocks * BlockSize;
+    }
+    if (Size > 0)
+    {
+        FMemory::Memcpy(Buffer, Bytes, Size);
+        BufferSize = static_cast<int32>(Size);
+    }
+}
+
+void FAGTSha256::Final(uint8 OutDigest[DigestSize])
+{
+    const uint64 BitSize = TotalSize * 8;
+    uint8 Padding[BlockSize * 2] = {0x80};
+    const int32 PaddingSize = (BufferSize < 56 ? 56 : 120) - BufferSize;
+    for (int32 Index = 0; Index < 8; ++Index)
+    {
+        Padding[PaddingSize + Index] = static_cast<uint8>(BitSize >> (56 - Index * 8));
+    }
+    Update(Padding, PaddingSize + 8);
+    check(BufferSize == 0);
+
+    for (int32 Index = 0; Index < 8; ++Index)
+    {
+        OutDigest[Index * 4 + 0] = static_cast<uint8>(State[Index] >> 24);
+        OutDigest[Index * 4 + 1] = static_cast<uint8>(State[Index] >> 16);
+        OutDigest[Index * 4 + 2] = static_cast<uint8>(State[Index] >> 8);
+        OutDigest[Index * 4 + 3] = static_cast<uint8>(State[Index]);
+    }
+    Reset();
+}
+
+FString FAGTSha256::DigestToHex(const uint8 Digest[DigestSize])
+{
+    static const TCHAR* Digits = TEXT("0123456789abcdef");
+    FString Hex;
+    Hex.Reserve(DigestSize * 2);
+    for (int32 Index = 0; Index < DigestSize; ++Index)
+    {
+        Hex.AppendChar(Digits[Digest[Index] >> 4]);
+        Hex.AppendChar(Digits[Digest[Index] & 0xf]);
+    }
+    return Hex;
+}
+
+FString FAGTSha256::FinalHex()
+{
+    uint8 Digest[DigestSize];
+    Final(Digest);
+    return DigestToHex(Digest);
+}
+
+FString FAGTSha256::HashHex(const void* Data, int64 Size)
+{
+    FAGTSha256 Hasher;
+    Hasher.Update(Data, Size);
+    return Hasher.FinalHex();
+}
+
+bool FAGTSha256::IsBatchSupported(EBatchBackend InBackend)
+{
+    switch (InBackend)
+    {
+        case EBatchBackend::Single: return true;
+#if AGT_SHA_X86
+        case EBatchBackend::Sse2x4: return true;
+        case EBatchBackend::Avx2x8:
+        {
+            static const bool bHasAvx2 = AGTSha256::HasAvx2();
+            return bHasAvx2;
+        }
+#endif
+#if AGT_SHA_NEON
+        case EBatchBackend::Neonx4: return true;
+#endif
+        default: return false;
+    }
+}
+
+FAGTSha256::EBatchBackend FAGTSha256::GetBestBatchBackend()
+{
+    if (IsBatchSupported(EBatchBackend::Avx2x8))
+    {
+        return EBatchBackend::Avx2x8;
+    }
+    // The SHA instructions on one message beat four lanes of plain SIMD
+    if (GetBestBackend() != EBackend::Portable)
+    {
+        return EBatchBackend::Single;
+    }
+    if (IsBatchSupported(EBatchBackend::Sse2x4))
+    {
+        return EBatchBackend::Sse2x4;
+    }
+    if (IsBatchSupported(EBatchBackend::Neonx4))
+    {
+        return EBatchBackend::Neonx4;
+    }
+    return EBatchBackend::Single;
+}
+
+const TCHAR* FAGTSha256::GetBatchBackendName(EBatchBackend InBackend)
+{
+    switch (InBackend)
+    {
+        case EBatchBackend::Sse2x4: return TEXT("SSE2 x4");
+        case EBatchBackend::Avx2x8: return TEXT("AVX2 x8");
+        case EBatchBackend::Neonx4: return TEXT("NEON x4");
+        default: return TEXT("single");
+    }
+}
+
+void FAGTSha256::HashBatch(TArrayView<const TArrayView<const uint8>> Messages, TArrayView<uint8> OutDigests)
+{
+    static const EBatchBackend Best = GetBestBatchBackend();
+    HashBatch(Messages, OutDigests, Best);
+}
+
+void FAGTSha256::HashBatch(TArrayView<const TArrayView<const uint8>> Messages, TArrayView<uint8> OutDigests, EBatchBackend InBackend)
+{
+    check(static_cast<int64>(OutDigests.Num()) >= static_cast<int64>(Messages.Num()) * DigestSize);
+    if (Messages.Num() == 0)
+    {
+        return;
+    }
+
+    switch (IsBatchSupported(InBackend) ? InBackend : EBatchBackend::Single)
+    {
+#if AGT_SHA_X86
+        case EBatchBackend::Sse2x4: AGTSha256::Sse2::HashBatchLanes(Messages.GetData(), Messages.Num(), OutDigests.GetData()); break;
+        case EBatchBackend::Avx2x8: AGTSha256::Avx2::HashBatchLanes(Messages.GetData(), Messages.Num(), OutDigests.GetData()); break;
+#endif
+#if AGT_SHA_NEON
+        case EBatchBackend::Neonx4: AGTSha256::Neon::HashBatchLanes(Messages.GetData(), Messages.Num(), OutDigests.GetData()); break;
+#endif
+        default: AGTSha256::HashBatchSingle(Messages.GetData(), Messages.Num(), OutDigests.GetData()); break;
+    }
+}
+
+void FAGTSha256::HashStrings(TArrayView<const FString> Strings, TArrayView<uint8> OutDigests)
+{
+    // Short ids fit the inline storage, larger batches allocate once
+    TArray<int32, TInlineAllocator<256>> Offsets;
+    Offsets.SetNumUninitialized(Strings.Num() + 1);
+    int64 TotalSize = 0;
+    for (int32 Index = 0; Index < Strings.Num(); ++Index)
+    {
+        Offsets[Index] = static_cast<int32>(TotalSize);
+        TotalSize += FPlatformString::ConvertedLength<UTF8CHAR>(*Strings[Index], Strings[Index].Len());
+    }
+    check(TotalSize <= MAX_int32);
+    Offsets[Strings.Num()] = static_cast<int32>(TotalSize);
+
+    TArray<uint8, TInlineAllocator<4096>> Utf8;
+    Utf8.SetNumUninitialized(static_cast<int32>(TotalSize));
+    TArray<TArrayView<const uint8>, TInlineAllocator<256>> Messages;
+    Messages.SetNumUninitialized(Strings.Num());
+    for (int32 Index = 0; Index < Strings.Num(); ++Index)
+    {
+        const int32 Length = Offsets[Index + 1] - Offsets[Index];
+        FPlatformString::Convert(reinterpret_cast<UTF8CHAR*>(Utf8.GetData() + Offsets[Index]), Length, *Strings[Index], Strings[Index].Len());
+        Messages[Index] = TArrayView<const uint8>(Utf8.GetData() + Offsets[Index], Length);
+    }
+    HashBatch(Messages, OutDigests);
+}
+
+static FAutoConsoleCommand AGTBenchmarkSHA256(TEXT("AGT.BenchmarkSHA256"), TEXT("Compares SHA-256 throughput of every supported backend on 1 KB, 64 KB and 1 GB inputs and of every batch backend on short messages"),
+    FConsoleCommandDelegate::CreateLambda(
+        []()
+        {
+            // 1 GB is streamed through a 64 MB buffer, the hash sees the same bytes as one large input
+            TArray<uint8> Data;
+            Data.SetNumUninitialized(64 * 1024 * 1024);
+            for (int32 Index = 0; Index < Data.Num(); ++Index)
+            {
+                Data[Index] = static_cast<uint8>(Index * 31 + (Index >> 8));
+            }
+
+            struct FCase
+            {
+                const TCHAR* Name;
+                int64 Size;
+                int32 Repeat;
+            };
+            const FCase Cases[] = {{TEXT("1 KB"), 1024, 65536}, {TEXT("64 KB"), 64 * 1024, 2048}, {TEXT("1 GB"), 1024ll * 1024 * 1024, 1}};
+            const FAGTSha256::EBackend Backends[] = {FAGTSha256::EBackend::Portable, FAGTSha256::EBackend::ShaNi, FAGTSha256::EBackend::ArmSha2};
+
+            for (const FAGTSha256::EBackend Backend : Backends)
+            {
+                if (!FAGTSha256::IsSupported(Backend))
+                {
+                    continue;
+                }
+                for (const FCase& Case : Cases)
+                {
+                    FAGTSha256 Hasher(Backend);
+                    uint8 Digest[FAGTSha256::DigestSize];
+                    const double Start = FPlatformTime::Seconds();
+                    for (int32 Run = 0; Run < Case.Repeat; ++Run)
+                    {
+                        for (int64 Done = 0; Done < Case.Size;)
+                        {
+                            const int64 Chunk = FMath::Min<int64>(Case.Size - Done, Data.Num());
+                            Hasher.Update(Data.GetData(), Chunk);
+                            Done += Chunk;
+                        }
+                        Hasher.Final(Digest);
+                    }
+                    const double Seconds = FMath::Max(FPlatformTime::Seconds() - Start, 1e-9);
+                    const double Megabytes = static_cast<double>(Case.Size) * Case.Repeat / (1024.0 * 1024.0);
+                    UE_LOG(LogTemp, Display, TEXT("SHA-256 %-10s %-6s %10.1f MB/s"), FAGTSha256::GetBackendName(Backend), Case.Name, Megabytes / Seconds);
+                }
+            }
+
+            // Cache key sized messages, the case HashBatch is for
+            constexpr int32 NumMessages = 65536;
+            constexpr int32 MessageSize = 40;
+            TArray<TArrayView<const uint8>> Messages;
+            Messages.Reserve(NumMessages);
+            for (int32 Index = 0; Index < NumMessages; ++Index)
+            {
+                Messages.Add(TArrayView<const uint8>(Data.GetData() + Index * MessageSize, MessageSize));
+            }
+            TArray<uint8> Digests;
+            Digests.SetNumUninitialized(NumMessages * FAGTSha256::DigestSize);
+            const FAGTSha256::EBatchBackend BatchBackends[] = {
+                FAGTSha256::EBatchBackend::Single, FAGTSha256::EBatchBackend::Sse2x4, FAGTSha256::EBatchBackend::Avx2x8, FAGTSha256::EBatchBackend::Neonx4};
+            for (const FAGTSha256::EBatchBackend Backend : BatchBackends)
+            {
+                if (!FAGTSha256::IsBatchSupported(Backend))
+                {
+                    continue;
+                }
+                const double Start = FPlatformTime::Seconds();
+                FAGTSha256::HashBatch(Messages, Digests, Backend);
+                const double Seconds = FMath::Max(FPlatformTime::Seconds() - Start, 1e-9);
+                UE_LOG(LogTemp, Display, TEXT("SHA-256 batch %-10s %d x %d bytes %10.1f M messages/s"), FAGTSha256::GetBatchBackendName(Backend), NumMessages, MessageSize,
+                    NumMessages / Seconds / 1e6);
+            }
+        }));
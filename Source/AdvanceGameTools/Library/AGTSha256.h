@@ -0,0 +1,78 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * @class Streaming SHA-256.
+ * The block function is picked once at startup: the SHA extensions on x86 CPUs that report them through CPUID,
+ * the ARMv8 SHA2 instructions when the target is built with them, picosha2 everywhere else.
+ * HashBatch hashes many short messages side by side, one message per SIMD lane.
+ */
+class ADVANCEGAMETOOLS_API FAGTSha256
+{
+public:
+    enum class EBackend : uint8
+    {
+        Portable,
+        ShaNi,
+        ArmSha2
+    };
+
+    enum class EBatchBackend : uint8
+    {
+        Single,
+        Sse2x4,
+        Avx2x8,
+        Neonx4
+    };
+
+    static constexpr int32 DigestSize = 32;
+    static constexpr int32 BlockSize = 64;
+
+    /** @public Uses the fastest backend the CPU supports **/
+    FAGTSha256();
+
+    /** @public Uses the given backend, or the portable one if the CPU lacks it. Meant for benchmarks **/
+    explicit FAGTSha256(EBackend InBackend);
+
+    void Reset();
+    void Update(const void* Data, int64 Size);
+    void Final(uint8 OutDigest[DigestSize]);
+
+    /** @public Lowercase hex form of the digest, the format FSHA256Hash stores **/
+    FString FinalHex();
+
+    static FString HashHex(const void* Data, int64 Size);
+
+    static EBackend GetBestBackend();
+    static bool IsSupported(EBackend InBackend);
+    static const TCHAR* GetBackendName(EBackend InBackend);
+
+    static FString DigestToHex(const uint8 Digest[DigestSize]);
+
+    /**
+     * @public Hashes every message into OutDigests, DigestSize bytes per message in the order of Messages.
+     * OutDigests must hold Messages.Num() * DigestSize bytes. Nothing is allocated
+     */
+    static void HashBatch(TArrayView<const TArrayView<const uint8>> Messages, TArrayView<uint8> OutDigests);
+    static void HashBatch(TArrayView<const TArrayView<const uint8>> Messages, TArrayView<uint8> OutDigests, EBatchBackend InBackend);
+
+    /** @public Hashes the UTF-8 form of every string, the same bytes FSHA256Hash::FromString hashes. Converts into one buffer for the whole call **/
+    static void HashStrings(TArrayView<const FString> Strings, TArrayView<uint8> OutDigests);
+
+    /** @public AVX2 when the CPU has it, otherwise SHA-NI one message at a time when available, otherwise the widest SIMD lanes **/
+    static EBatchBackend GetBestBatchBackend();
+    static bool IsBatchSupported(EBatchBackend InBackend);
+    static const TCHAR* GetBatchBackendName(EBatchBackend InBackend);
+
+    typedef void (*FCompressFunction)(uint32* State, const uint8* Blocks, int64 NumBlocks);
+
+private:
+    FCompressFunction Compress;
+    uint32 State[8];
+    uint8 Buffer[BlockSize];
+    int32 BufferSize{0};
+    uint64 TotalSize{0};
+};
@@ -0,0 +1,157 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+// Multi-buffer SHA-256 kernel, included once per instruction set by AGTSha256.cpp.
+// The including file defines FLanes in the surrounding namespace, Width lanes of 32 bit words and the operations on them,
+// and AGT_LANES_TARGET, the instruction set the functions are compiled for.
+
+/** One block for every lane. State is stored word major, State[Word][Lane] */
+AGT_LANES_TARGET static void CompressLanes(uint32 (*State)[FLanes::Width], const uint8* const* Blocks)
+{
+    typedef FLanes::V V;
+
+    V W[16];
+    for (int32 Word = 0; Word < 16; ++Word)
+    {
+        W[Word] = FLanes::Gather(Blocks, Word);
+    }
+
+    V A = FLanes::Load(State[0]);
+    V B = FLanes::Load(State[1]);
+    V C = FLanes::Load(State[2]);
+    V D = FLanes::Load(State[3]);
+    V E = FLanes::Load(State[4]);
+    V F = FLanes::Load(State[5]);
+    V G = FLanes::Load(State[6]);
+    V H = FLanes::Load(State[7]);
+
+    for (int32 Round = 0; Round < 64; ++Round)
+    {
+        if (Round >= 16)
+        {
+            const V W15 = W[(Round - 15) & 15];
+            const V W2 = W[(Round - 2) & 15];
+            const V Sigma0 = FLanes::Xor(FLanes::Xor(FLanes::Rotr<7>(W15), FLanes::Rotr<18>(W15)), FLanes::Shr<3>(W15));
+            const V Sigma1 = FLanes::Xor(FLanes::Xor(FLanes::Rotr<17>(W2), FLanes::Rotr<19>(W2)), FLanes::Shr<10>(W2));
+            W[Round & 15] = FLanes::Add(FLanes::Add(W[Round & 15], Sigma0), FLanes::Add(W[(Round - 7) & 15], Sigma1));
+        }
+        const V Sum1 = FLanes::Xor(FLanes::Xor(FLanes::Rotr<6>(E), FLanes::Rotr<11>(E)), FLanes::Rotr<25>(E));
+        const V Choose = FLanes::Xor(FLanes::And(E, F), FLanes::AndNot(E, G));
+        const V T1 = FLanes::Add(FLanes::Add(FLanes::Add(H, Sum1), FLanes::Add(Choose, FLanes::Set1(K[Round]))), W[Round & 15]);
+        const V Sum0 = FLanes::Xor(FLanes::Xor(FLanes::Rotr<2>(A), FLanes::Rotr<13>(A)), FLanes::Rotr<22>(A));
+        const V Majority = FLanes::Or(FLanes::And(A, B), FLanes::And(C, FLanes::Or(A, B)));
+        const V T2 = FLanes::Add(Sum0, Majority);
+        H = G;
+        G = F;
+        F = E;
+        E = FLanes::Add(D, T1);
+        D = C;
+        C = B;
+        B = A;
+        A = FLanes::Add(T1, T2);
+    }
+
+    FLanes::Store(State[0], FLanes::Add(A, FLanes::Load(State[0])));
+    FLanes::Store(State[1], FLanes::Add(B, FLanes::Load(State[1])));
+    FLanes::Store(State[2], FLanes::Add(C, FLanes::Load(State[2])));
+    FLanes::Store(State[3], FLanes::Add(D, FLanes::Load(State[3])));
+    FLanes::Store(State[4], FLanes::Add(E, FLanes::Load(State[4])));
+    FLanes::Store(State[5], FLanes::Add(F, FLanes::Load(State[5])));
+    FLanes::Store(State[6], FLanes::Add(G, FLanes::Load(State[6])));
+    FLanes::Store(State[7], FLanes::Add(H, FLanes::Load(State[7])));
+}
+
+/** Lanes take the next message as soon as theirs is done, so messages of different lengths keep every lane busy */
+AGT_LANES_TARGET static void HashBatchLanes(const TArrayView<const uint8>* Messages, int32 Num, uint8* OutDigests)
+{
+    constexpr int32 Width = FLanes::Width;
+    alignas(32) uint32 State[8][Width];
+    uint8 Padded[Width][FAGTSha256::BlockSize];
+    const uint8* Blocks[Width];
+    int32 Message[Width];
+    int64 Block[Width];
+    int64 NumBlocks[Width];
+    int32 NextMessage = 0;
+    int32 Active = 0;
+
+    auto Assign = [&](int32 Lane)
+    {
+        if (NextMessage >= Num)
+        {
+            Message[Lane] = INDEX_NONE;
+            Blocks[Lane] = Padded[Lane];
+            return;
+        }
+        Message[Lane] = NextMessage++;
+        Block[Lane] = 0;
+        // The 0x80 marker and the 64 bit length need 9 bytes after the data
+        NumBlocks[Lane] = (static_cast<int64>(Messages[Message[Lane]].Num()) + 72) / FAGTSha256::BlockSize;
+        for (int32 Word = 0; Word < 8; ++Word)
+        {
+            State[Word][Lane] = InitialState[Word];
+        }
+        ++Active;
+    };
+
+    for (int32 Lane = 0; Lane < Width; ++Lane)
+    {
+        FMemory::Memzero(Padded[Lane], FAGTSha256::BlockSize);
+        Assign(Lane);
+    }
+
+    while (Active > 0)
+    {
+        for (int32 Lane = 0; Lane < Width; ++Lane)
+        {
+            if (Message[Lane] == INDEX_NONE)
+            {
+                continue;
+            }
+            const TArrayView<const uint8>& Data = Messages[Message[Lane]];
+            const int64 Offset = Block[Lane] * FAGTSha256::BlockSize;
+            const int64 Size = Data.Num();
+            if (Offset + FAGTSha256::BlockSize <= Size)
+            {
+                Blocks[Lane] = Data.GetData() + Offset;
+                continue;
+            }
+
+            // Tail of the message with its padding
+            uint8* Tail = Padded[Lane];
+            FMemory::Memzero(Tail, FAGTSha256::BlockSize);
+            if (Offset <= Size)
+            {
+                FMemory::Memcpy(Tail, Data.GetData() + Offset, Size - Offset);
+                Tail[Size - Offset] = 0x80;
+            }
+            if (Block[Lane] == NumBlocks[Lane] - 1)
+            {
+                const uint64 BitSize = static_cast<uint64>(Size) * 8;
+                for (int32 Index = 0; Index < 8; ++Index)
+                {
+                    Tail[56 + Index] = static_cast<uint8>(BitSize >> (56 - Index * 8));
+                }
+            }
+            Blocks[Lane] = Tail;
+        }
+
+        CompressLanes(State, Blocks);
+
+        for (int32 Lane = 0; Lane < Width; ++Lane)
+        {
+            if (Message[Lane] == INDEX_NONE || ++Block[Lane] < NumBlocks[Lane])
+            {
+                continue;
+            }
+            uint8* Digest = OutDigests + static_cast<int64>(Message[Lane]) * FAGTSha256::DigestSize;
+            for (int32 Word = 0; Word < 8; ++Word)
+            {
+                Digest[Word * 4 + 0] = static_cast<uint8>(State[Word][Lane] >> 24);
+                Digest[Word * 4 + 1] = static_cast<uint8>(State[Word][Lane] >> 16);
+                Digest[Word * 4 + 2] = static_cast<uint8>(State[Word][Lane] >> 8);
+                Digest[Word * 4 + 3] = static_cast<uint8>(State[Word][Lane]);
+            }
+            --Active;
+            Assign(Lane);
+        }
+    }
+}
@@ -0,0 +1,277 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#include "AdvanceGameTools/Library/AGTTreeHash.h"
+#include "AdvanceGameTools/Library/AGTAtomicFile.h"
+#include "AdvanceGameTools/Library/AGTFileHandlePool.h"
+#include "AdvanceGameTools/Library/AGTSha256.h"
+#include "Async/ParallelFor.h"
+#include "Misc/FileHelper.h"
+#include <atomic>
+
+namespace AGTTreeHash
+{
+static const uint8 Magic[4] = {'A', 'G', 'T', 'T'};
+static constexpr uint32 Version = 1;
+static constexpr int32 HeaderSize = 4 + 4 + 8 + 8 + 4;
+static constexpr uint8 LeafPrefix = 0x00;
+static constexpr uint8 NodePrefix = 0x01;
+/** Leaves are read in pieces of this size, so big leaves do not need big buffers */
+static constexpr int64 ReadSize = 1024 * 1024;
+
+template <typename T>
+static void Append(TArray<uint8>& Bytes, T Value)
+{
+    const int32 Offset = Bytes.AddUninitialized(sizeof(T));
+    FMemory::Memcpy(Bytes.GetData() + Offset, &Value, sizeof(T));
+}
+
+template <typename T>
+static T Take(const uint8*& Cursor)
+{
+    T Value;
+    FMemory::Memcpy(&Value, Cursor, sizeof(T));
+    Cursor += sizeof(T);
+    return Value;
+}
+}  // namespace AGTTreeHash
+
+int32 FAGTTreeHash::CountLeaves(int64 Size, int64 InLeafSize)
+{
+    // An empty file still has one empty leaf, so every tree has a root
+    const int64 Count = FMath::Max<int64>(1, (Size + InLeafSize - 1) / InLeafSize);
+    return Count <= MAX_int32 ? static_cast<int32>(Count) : -1;
+}
+
+bool FAGTTreeHash::HashLeaves(const FString& File, int64 Base, int64 End, int64 InLeafSize, int32 First, int32 Last, TArray<FDigest>& OutLeaves)
+{
+    const FAGTPositionalReaderPtr Reader = FAGTFileHandlePool::Get().Acquire(File);
+    if (!Reader || Reader->Size() < End)
+    {
+        return false;
+    }
+
+    std::atomic<bool> bFailed{false};
+    ParallelFor(Last - First,
+        [&](int32 Item)
+        {
+            const int32 Leaf = First + Item;
+            const int64 Start = Base + Leaf * InLeafSize;
+            const int64 Stop = FMath::Min(Start + InLeafSize, End);
+            TArray<uint8> Buffer;
+            Buffer.SetNumUninitialized(static_cast<int32>(FMath::Clamp<int64>(Stop - Start, 1, AGTTreeHash::ReadSize)));
+
+            FAGTSha256 Hasher;
+            Hasher.Update(&AGTTreeHash::LeafPrefix, 1);
+            for (int64 Offset = Start; Offset < Stop && !bFailed;)
+            {
+                const int64 SizeToRead = FMath::Min<int64>(Stop - Offset, Buffer.Num());
+                if (Reader->ReadAt(Offset, Buffer.GetData(), SizeToRead) != SizeToRead)
+                {
+                    UE_LOG(LogTemp, Error, TEXT("Read error while tree hashing '%s' at offset %lld."), *File, Offset);
+                    bFailed = true;
+                    return;
+                }
+                Hasher.Update(Buffer.GetData(), SizeToRead);
+                Offset += SizeToRead;
+            }
+            Hasher.Final(OutLeaves[Leaf].Bytes);
+        });
+    return !bFailed;
+}
+
+FAGTTreeHash::FDigest FAGTTreeHash::ComputeRoot(const TArray<FDigest>& InLeaves)
+{
+    TArray<FDigest> Level = InLeaves;
+    FAGTSha256 Hasher;
+    while (Level.Num() > 1)
+    {
+        const int32 NumPairs = Level.Num() / 2;
+        for (int32 Pair = 0; Pair < NumPairs; ++Pair)
+        {
+            Hasher.Update(&AGTTreeHash::NodePrefix, 1);
+            Hasher.Update(Level[Pair * 2].Bytes, sizeof(FDigest::Bytes));
+            Hasher.Update(Level[Pair * 2 + 1].Bytes, sizeof(FDigest::Bytes));
+            Hasher.Final(Level[Pair].Bytes);
+        }
+        if (Level.Num() % 2 != 0)
+        {
+            Level[NumPairs] = Level.Last();
+        }
+        Level.SetNum(NumPairs + Level.Num() % 2);
+    }
+    return Level[0];
+}
+
+bool FAGTTreeHash::Build(const FString& File, int64 InLeafSize)
+{
+    const FAGTPositionalReaderPtr Reader = FAGTFileHandlePool::Get().Acquire(File);
+    const int64 ClampedLeafSize = FMath::Max(InLeafSize, MinLeafSize);
+    const int32 Count = Reader ? CountLeaves(Reader->Size(), ClampedLeafSize) : -1;
+    if (Count < 0)
+    {
+        return false;
+    }
+
+    LeafSize = ClampedLeafSize;
+    FileSize = Reader->Size();
+    Leaves.SetNumUninitialized(Count);
+    if (!HashLeaves(File, 0, FileSize, LeafSize, 0, Leaves.Num(), Leaves))
+    {
+        Leaves.Reset();
+        FileSize = 0;
+        return false;
+    }
+    return true;
+}
+
+bool FAGTTreeHash::Save(const FString& Path, FString& OutError) const
+{
+    TArray<uint8> Bytes;
+    Bytes.Reserve(AGTTreeHash::HeaderSize + Leaves.Num() * sizeof(FDigest));
+    Bytes.Append(AGTTreeHash::Magic, 4);
+    AGTTreeHash::Append<uint32>(Bytes, AGTTreeHash::Version);
+    AGTTreeHash::Append<int64>(Bytes, FileSize);
+    AGTTreeHash::Append<int64>(Bytes, LeafSize);
+    AGTTreeHash::Append<uint32>(Bytes, static_cast<uint32>(Leaves.Num()));
+    Bytes.Append(reinterpret_cast<const uint8*>(Leaves.GetData()), Leaves.Num() * sizeof(FDigest));
+    return FAGTAtomicFile::Write(Path, Bytes, EAGTWriteMode::Atomic, OutError);
+}
+
+bool FAGTTreeHash::Load(const FString& Path)
+{
+    TArray<uint8> Bytes;
+    if (!FFileHelper::LoadFileToArray(Bytes, *Path, FILEREAD_Silent) || Bytes.Num() < AGTTreeHash::HeaderSize ||
+        FMemory::Memcmp(Bytes.GetData(), AGTTreeHash::Magic, 4) != 0)
+    {
+        return false;
+    }
+
+    const uint8* Cursor = Bytes.GetData() + 4;
+    if (AGTTreeHash::Take<uint32>(Cursor) != AGTTreeHash::Version)
+    {
+        return false;
+    }
+    const int64 InFileSize = AGTTreeHash::Take<int64>(Cursor);
+    const int64 InLeafSize = AGTTreeHash::Take<int64>(Cursor);
+    const uint32 Count = AGTTreeHash::Take<uint32>(Cursor);
+    const int32 Expected = InFileSize >= 0 && InLeafSize >= MinLeafSize ? CountLeaves(InFileSize, InLeafSize) : -1;
+    if (Expected < 0 || Count != static_cast<uint32>(Expected) ||
+        Bytes.Num() - AGTTreeHash::HeaderSize != static_cast<int64>(Count) * sizeof(FDigest))
+    {
+        return false;
+    }
+
+    FileSize = InFileSize;
+    LeafSize = InLeafSize;
+    Leaves.SetNumUninitialized(static_cast<int32>(Count));
+    FMemory::Memcpy(Leaves.GetData(), Cursor, Count * sizeof(FDigest));
+    return true;
+}
+
+bool FAGTTreeHash::Verify(const FString& File, int64 Offset, int64 Length, TArray<int32>& OutChanged) const
+{
+    OutChanged.Reset();
+    const FAGTPositionalReaderPtr Reader = FAGTFileHandlePool::Get().Acquire(File);
+    if (!Reader || Leaves.Num() == 0)
+    {
+        return false;
+    }
+
+    const int64 CurrentSize = Reader->Size();
+    const int32 CurrentLeaves = CountLeaves(CurrentSize, LeafSize);
+    if (CurrentLeaves < 0)
+    {
+        return false;
+    }
+    const int64 End = Length < 0 ? FMath::Max(FileSize, CurrentSize) : Offset + Length;
+    const int32 First = static_cast<int32>(FMath::Clamp<int64>(Offset / LeafSize, 0, FMath::Max(Leaves.Num(), CurrentLeaves) - 1));
+    const int32 Last = static_cast<int32>(FMath::Clamp<int64>((End + LeafSize - 1) / LeafSize, First + 1, FMath::Max(Leaves.Num(), CurrentLeaves)));
+
+    // Only leaves that exist in both the tree and the file can be compared
+    const int32 Common = FMath::Min(Leaves.Num(), CurrentLeaves);
+    TArray<FDigest> Current;
+    Current.SetNumUninitialized(Common);
+    if (First < Common && !HashLeaves(File, 0, CurrentSize, LeafSize, First, FMath::Min(Last, Common), Current))
+    {
+        return false;
+    }
+
+    for (int32 Leaf = First; Leaf < Last; ++Leaf)
+    {
+        if (Leaf >= Common || !(Current[Leaf] == Leaves[Leaf]))
+        {
+            OutChanged.Add(Leaf);
+        }
+    }
+    return true;
+}
+
+bool FAGTTreeHash::Update(const FString& File, int64 Offset, int64 Length)
+{
+    const FAGTPositionalReaderPtr Reader = FAGTFileHandlePool::Get().Acquire(File);
+    if (!Reader || Leaves.Num() == 0)
+    {
+        return false;
+    }
+
+    const int64 NewSize = Reader->Size();
+    const int32 NewLeaves = CountLeaves(NewSize, LeafSize);
+    if (NewLeaves < 0)
+    {
+        return false;
+    }
+    const int32 OldLeaves = Leaves.Num();
+    Leaves.SetNum(NewLeaves);
+
+    TArray<TPair<int32, int32>, TInlineAllocator<2>> Spans;
+    if (Length > 0)
+    {
+        const int32 First = static_cast<int32>(FMath::Clamp<int64>(Offset / LeafSize, 0, NewLeaves - 1));
+        const int32 Last = static_cast<int32>(FMath::Clamp<int64>((Offset + Length + LeafSize - 1) / LeafSize, First + 1, NewLeaves));
+        Spans.Emplace(First, Last);
+    }
+    if (NewSize != FileSize)
+    {
+        // The old last leaf changed length, everything from it on is new
+        Spans.Emplace(FMath::Min(OldLeaves, NewLeaves) - 1, NewLeaves);
+    }
+
+    FileSize = NewSize;
+    for (const TPair<int32, int32>& Span : Spans)
+    {
+        if (!HashLeaves(File, 0, FileSize, LeafSize, Span.Key, Span.Value, Leaves))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FAGTTreeHash::HashRange(const FString& File, int64 Offset, int64 Length, FString& OutRootHex, int64 InLeafSize)
+{
+    const int64 ClampedLeafSize = FMath::Max(InLeafSize, MinLeafSize);
+    const int32 Count = CountLeaves(Length, ClampedLeafSize);
+    if (Offset < 0 || Length < 0 || Count < 0)
+    {
+        return false;
+    }
+    TArray<FDigest> RangeLeaves;
+    RangeLeaves.SetNumUninitialized(Count);
+    if (!HashLeaves(File, Offset, Offset + Length, ClampedLeafSize, 0, RangeLeaves.Num(), RangeLeaves))
+    {
+        return false;
+    }
+    OutRootHex = FAGTSha256::DigestToHex(ComputeRoot(RangeLeaves).Bytes);
+    return true;
+}
+
+FString FAGTTreeHash::GetRootHex() const
+{
+    return Leaves.Num() > 0 ? FAGTSha256::DigestToHex(ComputeRoot(Leaves).Bytes) : FString();
+}
+
+void FAGTTreeHash::GetLeafRange(int32 Leaf, int64& OutOffset, int64& OutSize) const
+{
+    OutOffset = FMath::Min(Leaf * LeafSize, FileSize);
+    OutSize = FMath::Clamp<int64>(FileSize - OutOffset, 0, LeafSize);
+}
@@ -0,0 +1,65 @@
+﻿/** Copyright Mark Veligod. Published in 2023. **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * @class SHA-256 Merkle tree of a file.
+ * The file is cut into fixed-size leaves that are hashed in parallel on the task graph and combined pairwise into a root.
+ * Leaves are hashed as SHA-256(0x00 | data) and inner nodes as SHA-256(0x01 | left | right), an odd node moves up unchanged.
+ * The leaf hashes can be saved next to the file, so later checks re-hash only the ranges they care about.
+ */
+class ADVANCEGAMETOOLS_API FAGTTreeHash
+{
+public:
+    static constexpr int64 DefaultLeafSize = 4 * 1024 * 1024;
+    /** Smaller leaf sizes are raised to this, tiny leaves would only make the tree huge */
+    static constexpr int64 MinLeafSize = 1024;
+
+    /** @public Hashes every leaf of the file. Fails if the file has more than MAX_int32 leaves of that size **/
+    bool Build(const FString& File, int64 InLeafSize = DefaultLeafSize);
+
+    /** @public Writes the leaf hashes atomically **/
+    bool Save(const FString& Path, FString& OutError) const;
+    bool Load(const FString& Path);
+
+    /**
+     * @public Re-hashes the leaves that overlap [Offset, Offset + Length) and compares them with the stored ones.
+     * A negative Length runs to the end of the file. OutChanged gets the indices of leaves that differ, leaves past either end count as changed.
+     * Returns false if the file could not be read
+     */
+    bool Verify(const FString& File, int64 Offset, int64 Length, TArray<int32>& OutChanged) const;
+
+    /** @public Re-hashes the leaves that overlap a range that was written, and every leaf from the old end on if the size changed **/
+    bool Update(const FString& File, int64 Offset, int64 Length);
+
+    /** @public Root of a tree built over [Offset, Offset + Length) only, leaves counted from Offset **/
+    static bool HashRange(const FString& File, int64 Offset, int64 Length, FString& OutRootHex, int64 InLeafSize = DefaultLeafSize);
+
+    FString GetRootHex() const;
+    int32 NumLeaves() const { return Leaves.Num(); }
+    int64 GetLeafSize() const { return LeafSize; }
+    int64 GetFileSize() const { return FileSize; }
+
+    /** @public Byte range covered by a leaf **/
+    void GetLeafRange(int32 Leaf, int64& OutOffset, int64& OutSize) const;
+
+private:
+    struct FDigest
+    {
+        uint8 Bytes[32];
+
+        bool operator==(const FDigest& Other) const { return FMemory::Memcmp(Bytes, Other.Bytes, sizeof(Bytes)) == 0; }
+    };
+
+    /** @private Hashes leaves [First, Last) of the range starting at Base into OutLeaves, in parallel **/
+    static bool HashLeaves(const FString& File, int64 Base, int64 End, int64 InLeafSize, int32 First, int32 Last, TArray<FDigest>& OutLeaves);
+    static FDigest ComputeRoot(const TArray<FDigest>& InLeaves);
+    /** @private Number of leaves, or -1 if it does not fit an int32 **/
+    static int32 CountLeaves(int64 Size, int64 InLeafSize);
+
+    TArray<FDigest> Leaves;
+    int64 FileSize{0};
+    int64 LeafSize{DefaultLeafSize};
+};
@@ -6,157 +6,849 @@
 #include "XmlFile.h"
 #include "Engine/DataTable.h"
 #include "Misc/FileHelper.h"
+#include "Serialization/MemoryWriter.h"
 #include "Serialization/Csv/CsvParser.h"
+#include "AdvanceGameTools/Library/AGTCsvReader.h"
+#include "AdvanceGameTools/Library/AGTCsvWriter.h"
+#include "AdvanceGameTools/Library/AGTDirectoryScanner.h"
+#include "AdvanceGameTools/Library/AGTDirectoryIndex.h"
+#include "AdvanceGameTools/Library/AGTAtomicFile.h"
+#include "AdvanceGameTools/Library/AGTAppendLog.h"
+#include "AdvanceGameTools/Library/AGTFileHandlePool.h"
+#include "AdvanceGameTools/Library/AGTFileChange.h"
+#include "AdvanceGameTools/Library/AGTCompressedFile.h"
+#include "AdvanceGameTools/Library/AGTBlobStore.h"
+#include "AdvanceGameTools/Library/AGTBase64.h"
+#include "AdvanceGameTools/Library/AGTChunkedExport.h"
 
-class FCustomFileVisitor : public IPlatformFile::FDirectoryVisitor
+#pragma region ActionFiles
+
+bool UAdvanceGameToolLibrary::FileSaveString(FString Text, FString FileName)
 {
-public:
-    FString BasePath;
-    TArray<FString>& Nodes;
-    FString Filter;
-    FRegexPattern CustomPattern;
-    bool bFile = true;
-    bool bDirectory = true;
+    const FString Path = FPaths::ProjectLogDir() + FileName;
+    const FAGTFileChange Change(Path);
+    return FFileHelper::SaveStringToFile(Text, *Path, FFileHelper::EEncodingOptions::ForceUTF8);
+}
 
-    FCustomFileVisitor(FString& Path, TArray<FString>& Paths, const FString& Pattern, bool File, bool Directory)
-        : BasePath(Path), Nodes(Paths), Filter(Pattern), CustomPattern(Pattern), bFile(File), bDirectory(Directory){};
+bool UAdvanceGameToolLibrary::FileLoadString(FString FileName, FString& Text)
+{
+    return FFileHelper::LoadFileToString(Text, *(FPaths::ProjectLogDir() + FileName));
+}
 
-    virtual bool Visit(const TCHAR* FilenameOrDirectory, bool bIsDirectory)
+void UAdvanceGameToolLibrary::FileAppendString(FString Text, FString FileName, const bool addNewLine)
+{
+    static const FString LogDir = FPaths::ProjectLogDir();
+    if (addNewLine)
     {
-        if ((bFile && !bIsDirectory) || (bDirectory && bIsDirectory))
+        Text.AppendChar(TEXT('\n'));
+    }
+    FAGTAppendLog::Get().Append(LogDir + FileName, MoveTemp(Text));
+}
+
+void UAdvanceGameToolLibrary::FlushAppendedStrings()
+{
+    FAGTAppendLog::Get().Flush();
+}
+
+void UAdvanceGameToolLibrary::SetAppendRotation(const int64 maxFileSize, const float maxFileAge, const int32 maxBackups)
+{
+    FAGTAppendLog::Get().SetRotation(maxFileSize, maxFileAge, maxBackups);
+}
+
+UAGTFileHandle* UAdvanceGameToolLibrary::OpenFileHandle(UObject* outer, const FString filePath, const bool forRead, const bool forWrite, bool& success)
+{
+    IFileHandle* fileHandle = nullptr;
+    IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+    // Pooled readers would keep the file open while this handle changes it
+    TOptional<FAGTFileChange> change;
+    if (forWrite)
+    {
+        change.Emplace(filePath);
+    }
+    if (forRead)
+    {
+        fileHandle = platformFile.OpenRead(*filePath, forWrite);
+    }
+    else if (forWrite)
+    {
+        fileHandle = platformFile.OpenWrite(*filePath, false, forRead);
+    }
+
+    UAGTFileHandle* handle = nullptr;
+    if (fileHandle)
+    {
+        handle = NewObject<UAGTFileHandle>(outer);
+        if (handle)
         {
-            FString RelativePath = FString(FilenameOrDirectory);
-            FPaths::MakePathRelativeTo(RelativePath, *BasePath);
-            if (!Filter.IsEmpty())
+            handle->Handle = fileHandle;
+            handle->CanRead = forRead;
+            handle->CanWrite = forWrite;
+            if (forWrite)
+            {
+                handle->Path = filePath;
+            }
+            if (forRead)
             {
-                FRegexMatcher CustomMatcher(CustomPattern, RelativePath);
-                if (CustomMatcher.FindNext())
+                FAGTPositionalReaderPtr reader = MakeShared<FAGTPositionalReader, ESPMode::ThreadSafe>();
+                if (reader->Open(filePath))
                 {
-                    Nodes.Add(RelativePath);
+                    handle->Reader = reader;
                 }
             }
-            else
+            success = true;
+        }
+    }
+
+    return handle;
+}
+
+bool UAdvanceGameToolLibrary::WriteBytesToFile(const FString filePath, const bool allowOverwrite, const TArray<uint8>& bytesOut, const EAGTWriteMode writeMode)
+{
+    if (FPaths::FileExists(filePath) && !allowOverwrite)
+    {
+        return false;
+    }
+
+    if (writeMode != EAGTWriteMode::Direct)
+    {
+        FString error;
+        return FAGTAtomicFile::Write(filePath, bytesOut, writeMode, error);
+    }
+
+    IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+    const FAGTFileChange change(filePath);
+    IFileHandle* fileHandle = platformFile.OpenWrite(*filePath);
+    if (fileHandle)
+    {
+        const bool writeSuccess = fileHandle->Write(bytesOut.GetData(), bytesOut.Num());
+        delete fileHandle;
+        return writeSuccess;
+    }
+
+    return false;
+}
+
+bool UAdvanceGameToolLibrary::ReadAllBytesFromFile(const FString filePath, TArray<uint8>& bytesIn)
+{
+    const FAGTPositionalReaderPtr reader = FAGTFileHandlePool::Get().Acquire(filePath);
+    if (!reader.IsValid())
+    {
+        return false;
+    }
+
+    bytesIn.SetNum(reader->Size());
+    return reader->ReadAt(0, bytesIn.GetData(), bytesIn.Num()) == bytesIn.Num();
+}
+
+bool UAdvanceGameToolLibrary::ReadBytesFromFile(const FString filePath, TArray<uint8>& bytesIn, const int64 offset, const int64 numBytes)
+{
+    const FAGTPositionalReaderPtr reader = FAGTFileHandlePool::Get().Acquire(filePath);
+    if (!reader.IsValid() || offset < 0 || offset > reader->Size())
+    {
+        return false;
+    }
+
+    const int64 numToRead = FMath::Min(reader->Size() - offset, numBytes);
+    if (numToRead <= 0)
+    {
+        return false;
+    }
+
+    bytesIn.SetNum(numToRead);
+    return reader->ReadAt(offset, bytesIn.GetData(), bytesIn.Num()) == bytesIn.Num();
+}
+
+void UAdvanceGameToolLibrary::GetFileHandlePoolStats(int64& reused, int64& opened, int32& openFiles)
+{
+    const FAGTFileHandlePool& pool = FAGTFileHandlePool::Get();
+    reused = pool.GetHits();
+    opened = pool.GetMisses();
+    openFiles = pool.NumOpen();
+}
+
+void UAdvanceGameToolLibrary::SetFileHandlePoolLimit(const int32 maxOpenFiles)
+{
+    FAGTFileHandlePool::Get().SetMaxOpen(maxOpenFiles);
+}
+
+bool UAdvanceGameToolLibrary::ReadRangesFromFile(const FString& filePath, const TArray<FAGTReadRange>& ranges, TArray<uint8>& bytesIn, TArray<FAGTReadRange>& slices)
+{
+    FAGTPositionalReader reader;
+    if (!reader.Open(filePath))
+    {
+        return false;
+    }
+    return reader.ReadRanges(ranges, bytesIn, slices);
+}
+
+bool UAdvanceGameToolLibrary::ReadRangesFromFileSeparate(const FString& filePath, const TArray<FAGTReadRange>& ranges, TArray<FAGTByteArray>& chunks)
+{
+    FAGTPositionalReader reader;
+    if (!reader.Open(filePath))
+    {
+        return false;
+    }
+    TArray<TArray<uint8>> bytes;
+    if (!reader.ReadRanges(ranges, bytes))
+    {
+        return false;
+    }
+    chunks.SetNum(bytes.Num());
+    for (int32 index = 0; index < bytes.Num(); ++index)
+    {
+        chunks[index].Bytes = MoveTemp(bytes[index]);
+    }
+    return true;
+}
+
+UAGTMappedFile* UAdvanceGameToolLibrary::OpenMappedFile(UObject* outer, const FString filePath, bool& success)
+{
+    success = false;
+    UAGTMappedFile* mappedFile = NewObject<UAGTMappedFile>(outer);
+    if (mappedFile && mappedFile->View.Open(filePath))
+    {
+        success = true;
+        return mappedFile;
+    }
+
+    return nullptr;
+}
+
+UAGTLineReader* UAdvanceGameToolLibrary::OpenLineReader(UObject* outer, const FString filePath, const FString pattern, bool& success, const int32 bufferSize)
+{
+    success = false;
+    IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+    IFileHandle* fileHandle = platformFile.OpenRead(*filePath);
+    if (!fileHandle)
+    {
+        return nullptr;
+    }
+
+    UAGTLineReader* reader = NewObject<UAGTLineReader>(outer);
+    reader->Handle = fileHandle;
+    reader->FileSize = fileHandle->Size();
+    // Keep the buffer even so UTF-16 code units never straddle two reads
+    reader->Buffer.SetNumUninitialized(FMath::Max(bufferSize, 4096) & ~1);
+    if (!pattern.IsEmpty())
+    {
+        reader->Pattern = MakeUnique<FRegexPattern>(pattern);
+    }
+
+    uint8 bom[3] = {0, 0, 0};
+    const int64 bomSize = FMath::Min<int64>(3, reader->FileSize);
+    if (bomSize > 0 && fileHandle->Read(bom, bomSize))
+    {
+        if (bomSize >= 2 && bom[0] == 0xFF && bom[1] == 0xFE)
+        {
+            reader->bUTF16 = true;
+            reader->ContentStart = 2;
+        }
+        else if (bomSize == 3 && bom[0] == 0xEF && bom[1] == 0xBB && bom[2] == 0xBF)
+        {
+            reader->ContentStart = 3;
+        }
+    }
+    if (!reader->SeekToOffset(reader->ContentStart))
+    {
+        reader->Close();
+        return nullptr;
+    }
+
+    success = true;
+    return reader;
+}
+
+#pragma region LineReader
+
+void UAGTLineReader::Close()
+{
+    if (Handle)
+    {
+        delete Handle;
+        Handle = nullptr;
+    }
+    Buffer.Empty();
+    PendingLine.Empty();
+    BufferLen = 0;
+    Cursor = 0;
+    bEndOfFile = true;
+}
+
+bool UAGTLineReader::SeekToOffset(const int64 offset)
+{
+    if (!Handle || offset < ContentStart || offset > FileSize || !Handle->Seek(offset))
+    {
+        return false;
+    }
+    BufferStart = offset;
+    BufferLen = 0;
+    Cursor = 0;
+    PendingLine.Reset();
+    bEndOfFile = offset == FileSize;
+    return true;
+}
+
+bool UAGTLineReader::FillBuffer()
+{
+    BufferStart += BufferLen;
+    BufferLen = 0;
+    Cursor = 0;
+
+    const int64 numToRead = FMath::Min<int64>(Buffer.Num(), FileSize - BufferStart);
+    if (!Handle || numToRead <= 0 || !Handle->Read(Buffer.GetData(), numToRead))
+    {
+        return false;
+    }
+    BufferLen = static_cast<int32>(numToRead);
+    return true;
+}
+
+bool UAGTLineReader::EmitLine(const uint8* Data, int32 NumBytes, const int64 Offset, TArray<FString>& Lines, TArray<int64>& Offsets) const
+{
+    FString Line;
+    if (bUTF16)
+    {
+        int32 NumUnits = NumBytes / 2;
+        const UTF16CHAR* Units = reinterpret_cast<const UTF16CHAR*>(Data);
+        if (NumUnits > 0 && Units[NumUnits - 1] == '\r')
+        {
+            --NumUnits;
+        }
+        const FUTF16ToTCHAR Converted(Units, NumUnits);
+        Line = FString(Converted.Length(), Converted.Get());
+    }
+    else
+    {
+        if (NumBytes > 0 && Data[NumBytes - 1] == '\r')
+        {
+            --NumBytes;
+        }
+        const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Data), NumBytes);
+        Line = FString(Converted.Length(), Converted.Get());
+    }
+
+    if (Pattern.IsValid())
+    {
+        FRegexMatcher Matcher(*Pattern, Line);
+        if (!Matcher.FindNext())
+        {
+            return false;
+        }
+    }
+    Lines.Add(MoveTemp(Line));
+    Offsets.Add(Offset);
+    return true;
+}
+
+bool UAGTLineReader::ReadLines(TArray<FString>& lines, TArray<int64>& lineOffsets, const int32 maxLines)
+{
+    lines.Reset();
+    lineOffsets.Reset();
+    if (!Handle || bEndOfFile)
+    {
+        return false;
+    }
+
+    const int32 UnitSize = bUTF16 ? 2 : 1;
+    while (lines.Num() < maxLines)
+    {
+        if (Cursor >= BufferLen && !FillBuffer())
+        {
+            // The last line has no terminator
+            if (PendingLine.Num() > 0)
+            {
+                EmitLine(PendingLine.GetData(), PendingLine.Num(), PendingOffset, lines, lineOffsets);
+                PendingLine.Reset();
+            }
+            bEndOfFile = true;
+            break;
+        }
+
+        const uint8* Start = Buffer.GetData() + Cursor;
+        const int32 Available = BufferLen - Cursor;
+        int32 LineEnd = INDEX_NONE;
+        if (bUTF16)
+        {
+            for (int32 Index = 0; Index + 1 < Available; Index += 2)
             {
-                Nodes.Add(RelativePath);
+                if (Start[Index] == '\n' && Start[Index + 1] == 0)
+                {
+                    LineEnd = Index;
+                    break;
+                }
             }
         }
+        else if (const void* Found = memchr(Start, '\n', Available))
+        {
+            LineEnd = static_cast<int32>(static_cast<const uint8*>(Found) - Start);
+        }
+
+        if (LineEnd == INDEX_NONE)
+        {
+            if (PendingLine.Num() == 0)
+            {
+                PendingOffset = BufferStart + Cursor;
+            }
+            PendingLine.Append(Start, Available);
+            Cursor = BufferLen;
+            continue;
+        }
+
+        if (PendingLine.Num() == 0)
+        {
+            EmitLine(Start, LineEnd, BufferStart + Cursor, lines, lineOffsets);
+        }
+        else
+        {
+            PendingLine.Append(Start, LineEnd);
+            EmitLine(PendingLine.GetData(), PendingLine.Num(), PendingOffset, lines, lineOffsets);
+            PendingLine.Reset();
+        }
+        Cursor += LineEnd + UnitSize;
+    }
+
+    if (!bEndOfFile && Cursor >= BufferLen && PendingLine.Num() == 0 && BufferStart + BufferLen >= FileSize)
+    {
+        bEndOfFile = true;
+    }
+    return lines.Num() > 0;
+}
+
+#pragma endregion
+
+#pragma region AsyncFile
+
+UAGTAsyncFileIO* UAGTAsyncFileIO::Create(UObject* WorldContextObject, FStartRequest&& InStartRequest)
+{
+    UAGTAsyncFileIO* BlueprintNode = NewObject<UAGTAsyncFileIO>();
+    BlueprintNode->StartRequest = MoveTemp(InStartRequest);
+    BlueprintNode->RegisterWithGameInstance(WorldContextObject);
+    return BlueprintNode;
+}
+
+UAGTAsyncFileIO* UAGTAsyncFileIO::ReadTextAsync(UObject* WorldContextObject, const FString& Path, EAGTFileIOPriority Priority)
+{
+    return Create(WorldContextObject, [Path, Priority](FAGTFileIORequest::FOnComplete&& OnComplete) { return FAGTFileIOQueue::Get().ReadText(Path, Priority, MoveTemp(OnComplete)); });
+}
+
+UAGTAsyncFileIO* UAGTAsyncFileIO::SaveTextAsync(UObject* WorldContextObject, const FString& Path, const FString& Text, bool Append, bool Force, EAGTFileIOPriority Priority)
+{
+    return Create(WorldContextObject,
+        [Path, Text, Append, Force, Priority](FAGTFileIORequest::FOnComplete&& OnComplete) { return FAGTFileIOQueue::Get().SaveText(Path, Text, Append, Force, Priority, MoveTemp(OnComplete)); });
+}
+
+UAGTAsyncFileIO* UAGTAsyncFileIO::ReadByteAsync(UObject* WorldContextObject, const FString& Path, EAGTFileIOPriority Priority)
+{
+    return Create(WorldContextObject, [Path, Priority](FAGTFileIORequest::FOnComplete&& OnComplete) { return FAGTFileIOQueue::Get().ReadByte(Path, Priority, MoveTemp(OnComplete)); });
+}
+
+UAGTAsyncFileIO* UAGTAsyncFileIO::SaveByteAsync(UObject* WorldContextObject, const FString& Path, const TArray<uint8>& Bytes, bool Append, bool Force, EAGTFileIOPriority Priority)
+{
+    return Create(WorldContextObject,
+        [Path, Bytes, Append, Force, Priority](FAGTFileIORequest::FOnComplete&& OnComplete) { return FAGTFileIOQueue::Get().SaveByte(Path, Bytes, Append, Force, Priority, MoveTemp(OnComplete)); });
+}
+
+UAGTAsyncFileIO* UAGTAsyncFileIO::ReadCSVAsync(UObject* WorldContextObject, const FString& Path, bool HeaderFirst, EAGTFileIOPriority Priority)
+{
+    return Create(
+        WorldContextObject, [Path, HeaderFirst, Priority](FAGTFileIORequest::FOnComplete&& OnComplete) { return FAGTFileIOQueue::Get().ReadCSV(Path, HeaderFirst, Priority, MoveTemp(OnComplete)); });
+}
+
+UAGTAsyncFileIO* UAGTAsyncFileIO::SaveCSVAsync(UObject* WorldContextObject, const FString& Path, const TArray<FString>& Headers, const TArray<FString>& Data, bool Force, EAGTFileIOPriority Priority)
+{
+    return Create(WorldContextObject,
+        [Path, Headers, Data, Force, Priority](FAGTFileIORequest::FOnComplete&& OnComplete) { return FAGTFileIOQueue::Get().SaveCSV(Path, Headers, Data, Force, Priority, MoveTemp(OnComplete)); });
+}
+
+void UAGTAsyncFileIO::Activate()
+{
+    if (!StartRequest)
+    {
+        SetReadyToDestroy();
+        return;
+    }
+
+    TWeakObjectPtr<UAGTAsyncFileIO> WeakThis(this);
+    Request = StartRequest(
+        [WeakThis](FAGTFileIORequest& InRequest)
+        {
+            if (UAGTAsyncFileIO* Action = WeakThis.Get())
+            {
+                Action->OnRequestComplete(InRequest);
+            }
+        });
+    StartRequest = nullptr;
+
+    if (Request.IsValid() && !Request->IsDone())
+    {
+        TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UAGTAsyncFileIO::TickProgress));
+    }
+}
+
+void UAGTAsyncFileIO::Cancel()
+{
+    if (Request.IsValid())
+    {
+        Request->Cancel();
+    }
+}
+
+bool UAGTAsyncFileIO::TickProgress(float DeltaTime)
+{
+    if (!Request.IsValid() || Request->IsDone())
+    {
+        TickerHandle.Reset();
+        return false;
+    }
+    const float CurrentProgress = Request->GetProgress();
+    if (CurrentProgress != LastProgress)
+    {
+        LastProgress = CurrentProgress;
+        Progress.Broadcast(CurrentProgress);
+    }
+    return true;
+}
+
+void UAGTAsyncFileIO::OnRequestComplete(FAGTFileIORequest& InRequest)
+{
+    if (TickerHandle.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+        TickerHandle.Reset();
+    }
+
+    const EAGTFileIOResult Result = InRequest.GetResult();
+    if (Result == EAGTFileIOResult::Success)
+    {
+        Progress.Broadcast(1.0f);
+        Completed.Broadcast(Result, InRequest.GetPayload());
+    }
+    else
+    {
+        Failed.Broadcast(Result, InRequest.GetPayload());
+    }
+    Request.Reset();
+    SetReadyToDestroy();
+}
+
+UAGTAsyncFileOperation* UAGTAsyncFileOperation::Create(UObject* WorldContextObject, const TArray<FAGTFileOperationJob>& Jobs, int32 Concurrency, bool Resume)
+{
+    UAGTAsyncFileOperation* BlueprintNode = NewObject<UAGTAsyncFileOperation>();
+    BlueprintNode->Operation = MakeShared<FAGTBulkFileOperation, ESPMode::ThreadSafe>(Jobs, Concurrency, Resume);
+    BlueprintNode->RegisterWithGameInstance(WorldContextObject);
+    return BlueprintNode;
+}
+
+UAGTAsyncFileOperation* UAGTAsyncFileOperation::RunFileOperationsAsync(UObject* WorldContextObject, const TArray<FAGTFileOperationJob>& Jobs, int32 Concurrency, bool Resume)
+{
+    return Create(WorldContextObject, Jobs, Concurrency, Resume);
+}
+
+UAGTAsyncFileOperation* UAGTAsyncFileOperation::CopyDirectoryAsync(UObject* WorldContextObject, const FString& Source, const FString& Dest, int32 Concurrency, bool Resume)
+{
+    FAGTFileOperationJob Job;
+    Job.Operation = EAGTFileOperation::Copy;
+    Job.Source = Source;
+    Job.Dest = Dest;
+    return Create(WorldContextObject, {Job}, Concurrency, Resume);
+}
+
+UAGTAsyncFileOperation* UAGTAsyncFileOperation::MoveDirectoryAsync(UObject* WorldContextObject, const FString& Source, const FString& Dest, int32 Concurrency, bool Resume)
+{
+    FAGTFileOperationJob Job;
+    Job.Operation = EAGTFileOperation::Move;
+    Job.Source = Source;
+    Job.Dest = Dest;
+    return Create(WorldContextObject, {Job}, Concurrency, Resume);
+}
+
+UAGTAsyncFileOperation* UAGTAsyncFileOperation::RemoveDirectoryAsync(UObject* WorldContextObject, const FString& Path, int32 Concurrency)
+{
+    FAGTFileOperationJob Job;
+    Job.Operation = EAGTFileOperation::Delete;
+    Job.Source = Path;
+    return Create(WorldContextObject, {Job}, Concurrency, false);
+}
+
+void UAGTAsyncFileOperation::Activate()
+{
+    if (!Operation.IsValid())
+    {
+        SetReadyToDestroy();
+        return;
+    }
+
+    TWeakObjectPtr<UAGTAsyncFileOperation> WeakThis(this);
+    Operation->Start(
+        [WeakThis](FAGTBulkFileOperation& InOperation)
+        {
+            if (UAGTAsyncFileOperation* Action = WeakThis.Get())
+            {
+                Action->OnOperationComplete(InOperation);
+            }
+        });
+    TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UAGTAsyncFileOperation::TickProgress));
+}
+
+void UAGTAsyncFileOperation::Cancel()
+{
+    if (Operation.IsValid())
+    {
+        Operation->Cancel();
+    }
+}
+
+bool UAGTAsyncFileOperation::TickProgress(float DeltaTime)
+{
+    if (!Operation.IsValid() || !Operation->IsRunning())
+    {
+        TickerHandle.Reset();
+        return false;
+    }
+    const FAGTFileOperationProgress Current = Operation->GetProgress();
+    if (Current.BytesDone != LastBytesDone || Current.FilesDone != LastFilesDone)
+    {
+        LastBytesDone = Current.BytesDone;
+        LastFilesDone = Current.FilesDone;
+        Progress.Broadcast(Current);
+    }
+    return true;
+}
+
+void UAGTAsyncFileOperation::OnOperationComplete(FAGTBulkFileOperation& InOperation)
+{
+    if (TickerHandle.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+        TickerHandle.Reset();
+    }
+
+    const EAGTFileIOResult Result = InOperation.GetResult();
+    const FAGTFileOperationProgress Current = InOperation.GetProgress();
+    if (Result == EAGTFileIOResult::Success)
+    {
+        Progress.Broadcast(Current);
+        Completed.Broadcast(Result, Current, InOperation.GetErrors());
+    }
+    else
+    {
+        Failed.Broadcast(Result, Current, InOperation.GetErrors());
+    }
+    Operation.Reset();
+    SetReadyToDestroy();
+}
+
+#pragma endregion
+
+#pragma region FileHandle
+
+namespace AGTFileHandle
+{
+/** Object pointers have no binary form outside a package, a plain memory writer asserts on them */
+static bool FindObjectReference(const FProperty* Property, FString& OutName)
+{
+    if (Property->IsA<FObjectPropertyBase>() || Property->IsA<FInterfaceProperty>() || Property->IsA<FDelegateProperty>() ||
+        Property->IsA<FMulticastDelegateProperty>())
+    {
+        OutName = Property->GetName();
         return true;
     }
-};
+    if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+    {
+        for (TFieldIterator<FProperty> It(StructProperty->Struct); It; ++It)
+        {
+            if (FindObjectReference(*It, OutName))
+            {
+                return true;
+            }
+        }
+    }
+    else if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+    {
+        return FindObjectReference(ArrayProperty->Inner, OutName);
+    }
+    else if (const FSetProperty* SetProperty = CastField<FSetProperty>(Property))
+    {
+        return FindObjectReference(SetProperty->ElementProp, OutName);
+    }
+    else if (const FMapProperty* MapProperty = CastField<FMapProperty>(Property))
+    {
+        return FindObjectReference(MapProperty->KeyProp, OutName) || FindObjectReference(MapProperty->ValueProp, OutName);
+    }
+    return false;
+}
+}  // namespace AGTFileHandle
 
-#pragma region ActionFiles
+bool UAGTFileHandle::SetWriteBuffer(const int32 bufferSize, const float flushInterval)
+{
+    if (!Handle || !CanWrite || !Flush())
+    {
+        return false;
+    }
 
-bool UAdvanceGameToolLibrary::FileSaveString(FString Text, FString FileName)
+    WriteBufferSize = FMath::Max(bufferSize, 0);
+    WriteBuffer.Empty(WriteBufferSize);
+
+    if (FlushTicker.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(FlushTicker);
+        FlushTicker.Reset();
+    }
+    if (WriteBufferSize > 0 && flushInterval > 0.0f)
+    {
+        FlushTicker = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UAGTFileHandle::TickFlush), flushInterval);
+    }
+    return true;
+}
+
+bool UAGTFileHandle::SetReadAhead(const int32 chunkSize, const int32 numChunks)
 {
-    return FFileHelper::SaveStringToFile(Text, *(FPaths::ProjectLogDir() + FileName), FFileHelper::EEncodingOptions::ForceUTF8);
+    if (!Handle || !CanRead || !Reader.IsValid())
+    {
+        return false;
+    }
+
+    ReadAhead.Reset();
+    if (numChunks > 0)
+    {
+        ReadAhead = MakeUnique<FAGTReadAhead>(Reader, chunkSize, numChunks);
+    }
+    return true;
 }
 
-bool UAdvanceGameToolLibrary::FileLoadString(FString FileName, FString& Text)
+bool UAGTFileHandle::ReadRangesSeparate(const TArray<FAGTReadRange>& ranges, TArray<FAGTByteArray>& chunks)
 {
-    return FFileHelper::LoadFileToString(Text, *(FPaths::ProjectLogDir() + FileName));
+    if (!Reader.IsValid() || !CanRead)
+    {
+        return false;
+    }
+    TArray<TArray<uint8>> bytes;
+    if (!Reader->ReadRanges(ranges, bytes))
+    {
+        return false;
+    }
+    chunks.SetNum(bytes.Num());
+    for (int32 index = 0; index < bytes.Num(); ++index)
+    {
+        chunks[index].Bytes = MoveTemp(bytes[index]);
+    }
+    return true;
 }
 
-UAGTFileHandle* UAdvanceGameToolLibrary::OpenFileHandle(UObject* outer, const FString filePath, const bool forRead, const bool forWrite, bool& success)
+bool UAGTFileHandle::Flush(const bool toDisk)
 {
-    IFileHandle* fileHandle = nullptr;
-    IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
-    if (forRead)
+    if (!Handle)
+    {
+        return false;
+    }
+    bool success = true;
+    if (WriteBuffer.Num() > 0)
     {
-        fileHandle = platformFile.OpenRead(*filePath, forWrite);
+        InvalidateReadAhead();
+        success = Handle->Write(WriteBuffer.GetData(), WriteBuffer.Num());
+        WriteBuffer.Reset();
     }
-    else if (forWrite)
+    if (toDisk)
     {
-        fileHandle = platformFile.OpenWrite(*filePath, false, forRead);
+        success = Handle->Flush(true) && success;
     }
+    return success;
+}
 
-    UAGTFileHandle* handle = nullptr;
-    if (fileHandle)
+bool UAGTFileHandle::TickFlush(float deltaTime)
+{
+    if (WriteBuffer.Num() > 0)
     {
-        handle = NewObject<UAGTFileHandle>(outer);
-        if (handle)
-        {
-            handle->Handle = fileHandle;
-            handle->CanRead = forRead;
-            handle->CanWrite = forWrite;
-            success = true;
-        }
+        Flush();
     }
-
-    return handle;
+    return true;
 }
 
-bool UAdvanceGameToolLibrary::WriteBytesToFile(const FString filePath, const bool allowOverwrite, const TArray<uint8>& bytesOut)
+bool UAGTFileHandle::Append(const uint8* data, const int64 num)
 {
-    if (FPaths::FileExists(filePath) && !allowOverwrite)
+    if (WriteBufferSize <= 0)
+    {
+        InvalidateReadAhead();
+        return Handle->Write(data, num);
+    }
+    if (WriteBuffer.Num() + num > WriteBufferSize && !Flush())
     {
         return false;
     }
-
-    IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
-    IFileHandle* fileHandle = platformFile.OpenWrite(*filePath);
-    if (fileHandle)
+    if (num >= WriteBufferSize)
     {
-        const bool writeSuccess = fileHandle->Write(bytesOut.GetData(), bytesOut.Num());
-        delete fileHandle;
-        return writeSuccess;
+        InvalidateReadAhead();
+        // Too large to be worth copying, it already is one big write
+        return Handle->Write(data, num);
     }
-
-    return false;
+    WriteBuffer.Append(data, static_cast<int32>(num));
+    return true;
 }
 
-bool UAdvanceGameToolLibrary::ReadAllBytesFromFile(const FString filePath, TArray<uint8>& bytesIn)
+bool UAGTFileHandle::WriteString(const FString& value, const bool addNewLine)
 {
-    if (!FPaths::FileExists(filePath))
+    if (!Handle || !CanWrite)
     {
         return false;
     }
 
-    IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
-    IFileHandle* fileHandle = platformFile.OpenRead(*filePath);
-    if (fileHandle)
+    const int32 length = FPlatformString::ConvertedLength<UTF8CHAR>(*value, value.Len());
+    const int32 total = length + (addNewLine ? 1 : 0);
+    if (WriteBufferSize <= 0 || total >= WriteBufferSize)
     {
-        bytesIn.SetNum(fileHandle->Size());
-        const bool readSuccess = fileHandle->Read(bytesIn.GetData(), bytesIn.Num());
-        delete fileHandle;
-        return readSuccess;
+        InvalidateReadAhead();
+        const FTCHARToUTF8 converted(*value, value.Len());
+        return Handle->Write(reinterpret_cast<const uint8*>(converted.Get()), converted.Length()) && (!addNewLine || Handle->Write(reinterpret_cast<const uint8*>("\n"), 1));
+    }
+    if (WriteBuffer.Num() + total > WriteBufferSize && !Flush())
+    {
+        return false;
     }
 
-    return false;
+    // Encode straight into the spare capacity of the buffer
+    const int32 offset = WriteBuffer.Num();
+    WriteBuffer.AddUninitialized(total);
+    FPlatformString::Convert(reinterpret_cast<UTF8CHAR*>(WriteBuffer.GetData() + offset), length, *value, value.Len());
+    if (addNewLine)
+    {
+        WriteBuffer[offset + length] = '\n';
+    }
+    return true;
 }
 
-bool UAdvanceGameToolLibrary::ReadBytesFromFile(const FString filePath, TArray<uint8>& bytesIn, const int64 offset, const int64 numBytes)
+bool UAGTFileHandle::AppendStruct(FStructProperty* property, void* data)
 {
-    if (!FPaths::FileExists(filePath))
+    if (!Handle || !CanWrite || !property || !data)
     {
         return false;
     }
-
-    IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
-    IFileHandle* fileHandle = platformFile.OpenRead(*filePath);
-    if (fileHandle)
+    FString reference;
+    if (AGTFileHandle::FindObjectReference(property, reference))
     {
-        if (!fileHandle->Seek(offset))
-        {
-            delete fileHandle;
-            return false;
-        }
+        UE_LOG(LogTemp, Error, TEXT("WriteStruct: %s holds the object reference %s, which has no binary form"), *property->Struct->GetName(), *reference);
+        return false;
+    }
 
-        const int64 numToRead = FMath::Min(fileHandle->Size() - fileHandle->Tell(), numBytes);
-        if (numToRead <= 0)
-        {
-            delete fileHandle;
-            return false;
-        }
+    // The writer appends to the end of the buffer, so the struct is serialized in place
+    const int32 start = WriteBuffer.Num();
+    FMemoryWriter writer(WriteBuffer, false, true);
+    property->Struct->SerializeBin(writer, data);
 
-        bytesIn.SetNum(numToRead);
-        const bool readSuccess = fileHandle->Read(bytesIn.GetData(), bytesIn.Num());
-        delete fileHandle;
-        return readSuccess;
+    if (writer.IsError())
+    {
+        WriteBuffer.SetNum(start, false);
+        return false;
     }
-
-    return false;
+    if (WriteBufferSize <= 0 || WriteBuffer.Num() > WriteBufferSize)
+    {
+        // Unbuffered or over the threshold: everything pending goes out now, the struct included
+        return Flush();
+    }
+    return true;
 }
 
+#pragma endregion
+
 #pragma region Paths
 
 FEnginePath UAdvanceGameToolLibrary::GetEngineDirectories()
@@ -206,7 +898,7 @@ bool UAdvanceGameToolLibrary::ReadText(FString Path, FString& Output)
     return false;
 }
 
-bool UAdvanceGameToolLibrary::SaveText(FString Path, FString Text, FString& Error, bool Append, bool Force)
+bool UAdvanceGameToolLibrary::SaveText(FString Path, FString Text, FString& Error, bool Append, bool Force, EAGTWriteMode Mode)
 {
     IPlatformFile& file = FPlatformFileManager::Get().GetPlatformFile();
     FText ErrorFilename;
@@ -217,6 +909,19 @@ bool UAdvanceGameToolLibrary::SaveText(FString Path, FString Text, FString& Erro
     }
     if (!file.FileExists(*Path) || Append || Force)
     {
+        if (Mode != EAGTWriteMode::Direct)
+        {
+            TArray<uint8> Bytes;
+            // Appending atomically means replacing the file with its old content plus the new text
+            if (Append && file.FileExists(*Path) && !FFileHelper::LoadFileToArray(Bytes, *Path))
+            {
+                Error = FString("Could not read the existing file");
+                return false;
+            }
+            AGTFileIO::EncodeText(Text, Bytes);
+            return FAGTAtomicFile::Write(Path, Bytes, Mode, Error);
+        }
+        const FAGTFileChange Change(Path);
         return FFileHelper::SaveStringToFile(Text, *Path, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), Append ? FILEWRITE_Append : FILEWRITE_None);
     }
     else
@@ -257,6 +962,7 @@ bool UAdvanceGameToolLibrary::SaveLine(FString Path, const TArray<FString>& Text
     }
     if (!file.FileExists(*Path) || Append || Force)
     {
+        const FAGTFileChange Change(Path);
         return FFileHelper::SaveStringArrayToFile(Text, *Path, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), Append ? FILEWRITE_Append : FILEWRITE_None);
     }
     Error = FString("File already exists");
@@ -273,7 +979,7 @@ bool UAdvanceGameToolLibrary::ReadByte(FString Path, TArray<uint8>& Bytes)
     return FFileHelper::LoadFileToArray(Bytes, *Path);
 }
 
-bool UAdvanceGameToolLibrary::SaveByte(FString Path, const TArray<uint8>& Bytes, FString& Error, bool Append, bool Force)
+bool UAdvanceGameToolLibrary::SaveByte(FString Path, const TArray<uint8>& Bytes, FString& Error, bool Append, bool Force, EAGTWriteMode Mode)
 {
     IPlatformFile& file = FPlatformFileManager::Get().GetPlatformFile();
     FText ErrorFilename;
@@ -284,49 +990,152 @@ bool UAdvanceGameToolLibrary::SaveByte(FString Path, const TArray<uint8>& Bytes,
     }
     if (!file.FileExists(*Path) || Append || Force)
     {
+        if (Mode != EAGTWriteMode::Direct)
+        {
+            if (Append && file.FileExists(*Path))
+            {
+                TArray<uint8> Combined;
+                if (!FFileHelper::LoadFileToArray(Combined, *Path))
+                {
+                    Error = FString("Could not read the existing file");
+                    return false;
+                }
+                Combined.Append(Bytes);
+                return FAGTAtomicFile::Write(Path, Combined, Mode, Error);
+            }
+            return FAGTAtomicFile::Write(Path, Bytes, Mode, Error);
+        }
+        const FAGTFileChange Change(Path);
         return FFileHelper::SaveArrayToFile(Bytes, *Path, &IFileManager::Get(), Append ? FILEWRITE_Append : FILEWRITE_None);
     }
     Error = FString("File already exists");
     return false;
 }
 
+bool UAdvanceGameToolLibrary::SaveByteCompressed(FString Path, const TArray<uint8>& Bytes, FString& Error, bool Force, EAGTCompression Codec, int32 BlockSize, EAGTWriteMode Mode)
+{
+    IPlatformFile& file = FPlatformFileManager::Get().GetPlatformFile();
+    FText ErrorFilename;
+    if (!FFileHelper::IsFilenameValidForSaving(Path, ErrorFilename))
+    {
+        Error = FString("Filename is not valid");
+        return false;
+    }
+    if (file.FileExists(*Path) && !Force)
+    {
+        Error = FString("File already exists");
+        return false;
+    }
+
+    if (Mode != EAGTWriteMode::Direct)
+    {
+        // The atomic writer needs the whole file, compressed data is collected in memory first
+        TArray<uint8> Compressed;
+        FAGTCompressedWriter Writer(
+            [&Compressed](const uint8* Data, int64 Size)
+            {
+                Compressed.Append(Data, static_cast<int32>(Size));
+                return true;
+            },
+            Codec, BlockSize);
+        if (!Writer.Write(Bytes.GetData(), Bytes.Num()) || !Writer.Finish())
+        {
+            Error = FString("Compression failed");
+            return false;
+        }
+        return FAGTAtomicFile::Write(Path, Compressed, Mode, Error);
+    }
+
+    file.CreateDirectoryTree(*FPaths::GetPath(Path));
+    const FAGTFileChange Change(Path);
+    TUniquePtr<IFileHandle> Handle(file.OpenWrite(*Path));
+    if (!Handle.IsValid())
+    {
+        Error = FString("Could not open file for writing");
+        return false;
+    }
+    FAGTCompressedWriter Writer([&Handle](const uint8* Data, int64 Size) { return Handle->Write(Data, Size); }, Codec, BlockSize);
+    if (!Writer.Write(Bytes.GetData(), Bytes.Num()) || !Writer.Finish())
+    {
+        Error = FString("Write error");
+        return false;
+    }
+    return true;
+}
+
+bool UAdvanceGameToolLibrary::ReadByteCompressed(FString Path, TArray<uint8>& Bytes)
+{
+    FAGTCompressedReader Reader;
+    return Reader.Open(Path) && Reader.ReadAll(Bytes);
+}
+
+bool UAdvanceGameToolLibrary::ReadByteCompressedRange(FString Path, const int64 Offset, const int64 Length, TArray<uint8>& Bytes)
+{
+    FAGTCompressedReader Reader;
+    return Reader.Open(Path) && Reader.Read(Offset, Length, Bytes);
+}
+
 #pragma endregion
 
 #pragma region Base64
 
-FString UAdvanceGameToolLibrary::StringToBase64(const FString Source)
+FString UAdvanceGameToolLibrary::StringToBase64(const FString& Source)
+{
+    // UTF-8, so text outside of ASCII survives the round trip
+    const FTCHARToUTF8 Utf8(*Source, Source.Len());
+    return FAGTBase64::Encode(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+}
+
+bool UAdvanceGameToolLibrary::StringFromBase64(const FString& Base64Str, FString& Result)
+{
+    TArray<uint8> Bytes;
+    if (!FAGTBase64::Decode(Base64Str, Bytes))
+    {
+        return false;
+    }
+    const FUTF8ToTCHAR Text(reinterpret_cast<const ANSICHAR*>(Bytes.GetData()), Bytes.Num());
+    Result = FString(Text.Length(), Text.Get());
+    return true;
+}
+
+FString UAdvanceGameToolLibrary::BytesToBase64(const TArray<uint8>& Bytes)
 {
-    return FBase64::Encode(Source);
+    return FAGTBase64::Encode(Bytes.GetData(), Bytes.Num());
 }
 
-bool UAdvanceGameToolLibrary::StringFromBase64(FString Base64Str, FString& Result)
+bool UAdvanceGameToolLibrary::BytesFromBase64(const FString& Source, TArray<uint8>& Out)
 {
-    return FBase64::Decode(Base64Str, Result);
+    return FAGTBase64::Decode(Source, Out);
 }
 
-FString UAdvanceGameToolLibrary::BytesToBase64(const TArray<uint8> Bytes)
+bool UAdvanceGameToolLibrary::Base64EncodeFile(const FString& SourcePath, const FString& DestPath, FString& Error)
 {
-    return FBase64::Encode(Bytes);
+    return FAGTBase64::EncodeFile(SourcePath, DestPath, Error);
 }
 
-bool UAdvanceGameToolLibrary::BytesFromBase64(const FString Source, TArray<uint8>& Out)
+bool UAdvanceGameToolLibrary::Base64DecodeFile(const FString& SourcePath, const FString& DestPath, FString& Error)
 {
-    return FBase64::Decode(Source, Out);
+    return FAGTBase64::DecodeFile(SourcePath, DestPath, Error);
 }
 
 #pragma endregion
 
 #pragma region CSVFile
 
-bool UAdvanceGameToolLibrary::SaveCSV(FString Path, TArray<FString> Headers, TArray<FString> Data, int32& Total, bool Force)
+bool UAdvanceGameToolLibrary::SaveCSV(const FString& Path, const TArray<FString>& Headers, const TArray<FString>& Data, int32& Total, bool Force)
 {
-    FString Output;
-    if (!UAdvanceGameToolLibrary::CSVToString(Output, Headers, Data, Total))
+    Total = 0;
+    IPlatformFile& file = FPlatformFileManager::Get().GetPlatformFile();
+    FText ErrorFilename;
+    if (!FFileHelper::IsFilenameValidForSaving(Path, ErrorFilename))
+    {
+        return false;
+    }
+    if (file.FileExists(*Path) && !Force)
     {
         return false;
     }
-    FString Error;
-    return UAdvanceGameToolLibrary::SaveText(Path, Output, Error, false, Force);
+    return FAGTCsvWriter::ToFile(Path, Headers, Data, Total);
 }
 
 bool UAdvanceGameToolLibrary::ReadCSV(FString Path, TArray<FString>& Headers, TArray<FString>& Data, int32& Total, bool HeaderFirst)
@@ -345,6 +1154,11 @@ bool UAdvanceGameToolLibrary::ReadCSV(FString Path, TArray<FString>& Headers, TA
     return UAdvanceGameToolLibrary::StringToCSV(Result, Headers, Data, Total, HeaderFirst);
 }
 
+bool UAdvanceGameToolLibrary::ReadCSVColumns(const FString& Path, const TArray<EAGTCsvColumnType>& ColumnTypes, TArray<FAGTCsvColumn>& Columns, int32& Rows, bool HeaderFirst)
+{
+    return FAGTCsvReader::ReadColumns(Path, ColumnTypes, HeaderFirst, Columns, Rows);
+}
+
 #pragma endregion
 
 #pragma region CSVConvert
@@ -371,49 +1185,9 @@ bool UAdvanceGameToolLibrary::StringToCSV(FString Content, TArray<FString>& Head
     return true;
 }
 
-bool UAdvanceGameToolLibrary::CSVToString(FString& Result, TArray<FString> Headers, TArray<FString> Data, int32& Total)
+bool UAdvanceGameToolLibrary::CSVToString(FString& Result, const TArray<FString>& Headers, const TArray<FString>& Data, int32& Total)
 {
-    Total = 0;
-    FString Delimiter = ",";
-    if (Headers.Num() == 0)
-    {
-        return false;
-    }
-    if (Data.Num() % Headers.Num() != 0)
-    {
-        return false;
-    }
-    Result = TEXT("");
-    // Header row
-    for (FString Col : Headers)
-    {
-        if (Result.Len() > 0)
-        {
-            Result += Delimiter;
-        }
-        Result += (TEXT("\"") + Col.Replace(TEXT("\""), TEXT("\"\"")) + TEXT("\""));
-    }
-    Result += LINE_TERMINATOR;
-    FString Row = TEXT("");
-    int32 Count = 0;
-    // Data row
-    for (FString Col : Data)
-    {
-        Count++;
-        if (Row.Len() > 0)
-        {
-            Row += Delimiter;
-        }
-        Row += (TEXT("\"") + Col.Replace(TEXT("\""), TEXT("\"\"")) + TEXT("\""));
-        if (Count % Headers.Num() == 0)
-        {
-            Row += LINE_TERMINATOR;
-            Result += Row;
-            Row = "";
-        }
-    }
-    Total = (Data.Num() / Headers.Num()) + 1;
-    return true;
+    return FAGTCsvWriter::ToString(Headers, Data, Result, Total);
 }
 
 #pragma endregion
@@ -814,13 +1588,12 @@ bool UAdvanceGameToolLibrary::ListDirectory(FString Path, FString Pattern, TArra
     {
         return true;
     }
-    FString BasePath = FPaths::Combine(Path, TEXT("/"));
-    FCustomFileVisitor CustomFileVisitor(BasePath, Nodes, Pattern, ShowFile, ShowDirectory);
-    if (Recursive)
-    {
-        return File.IterateDirectoryRecursively(*Path, CustomFileVisitor);
-    }
-    return File.IterateDirectory(*Path, CustomFileVisitor);
+    FAGTDirectoryScanOptions Options;
+    Options.Pattern = Pattern;
+    Options.bFiles = ShowFile;
+    Options.bDirectories = ShowDirectory;
+    Options.bRecursive = Recursive;
+    return FAGTDirectoryScanner::Scan(Path, Options, Nodes);
 }
 
 bool UAdvanceGameToolLibrary::MakeDirectory(FString Path, bool Recursive)
@@ -830,6 +1603,7 @@ bool UAdvanceGameToolLibrary::MakeDirectory(FString Path, bool Recursive)
     {
         return true;
     }
+    const FAGTFileChange Change(Path);
     if (Recursive)
     {
         return File.CreateDirectoryTree(*Path);
@@ -844,6 +1618,7 @@ bool UAdvanceGameToolLibrary::RemoveDirectory(FString Path, bool Recursive)
     {
         return true;
     }
+    const FAGTFileChange Change(Path);
     if (Recursive)
     {
         return File.DeleteDirectoryRecursively(*Path);
@@ -863,6 +1638,7 @@ bool UAdvanceGameToolLibrary::CopyDirectory(FString Source, FString Dest)
     {
         return false;
     }
+    const FAGTFileChange Change(Dest);
     return File.CopyDirectoryTree(*Dest, *Source, true);
 }
 
@@ -913,6 +1689,7 @@ bool UAdvanceGameToolLibrary::RemoveFile(FString Path)
     {
         return true;
     }
+    const FAGTFileChange Change(Path);
     return File.DeleteFile(*Path);
 }
 
@@ -939,6 +1716,7 @@ bool UAdvanceGameToolLibrary::CopyFile(FString Source, FString Dest, bool Force)
         return false;
     }
     UAdvanceGameToolLibrary::RemoveFile(Dest);
+    const FAGTFileChange Change(Dest);
     return File.CopyFile(*Dest, *Source);
 }
 
@@ -965,6 +1743,8 @@ bool UAdvanceGameToolLibrary::MoveFile(FString Source, FString Dest, bool Force)
         return false;
     }
     UAdvanceGameToolLibrary::RemoveFile(Dest);
+    const FAGTFileChange SourceChange(Source);
+    const FAGTFileChange DestChange(Dest);
     return File.MoveFile(*Dest, *Source);
 }
 
@@ -987,6 +1767,8 @@ bool UAdvanceGameToolLibrary::RenameFile(FString Path, FString NewName)
     {
         return false;
     }
+    const FAGTFileChange SourceChange(Path);
+    const FAGTFileChange DestChange(Output);
     return File.MoveFile(*Output, *Path);
 }
 
@@ -1000,6 +1782,78 @@ void UAdvanceGameToolLibrary::GetPathParts(FString Path, FString& PathPart, FStr
 
 #pragma endregion
 
+#pragma region DirectoryIndex
+
+bool UAdvanceGameToolLibrary::WatchDirectory(const FString& Path)
+{
+    return FAGTDirectoryIndex::Get().Watch(Path);
+}
+
+void UAdvanceGameToolLibrary::UnwatchDirectory(const FString& Path)
+{
+    FAGTDirectoryIndex::Get().Unwatch(Path);
+}
+
+void UAdvanceGameToolLibrary::InvalidateDirectoryIndex(const FString& Path)
+{
+    FAGTDirectoryIndex::Get().Invalidate(Path);
+}
+
+bool UAdvanceGameToolLibrary::CachedListDirectory(
+    const FString& Path, const FString& Pattern, TArray<FString>& Nodes, bool ShowFile, bool ShowDirectory, bool Recursive, EAGTCachePolicy Policy)
+{
+    FAGTDirectoryScanOptions Options;
+    Options.Pattern = Pattern;
+    Options.bFiles = ShowFile;
+    Options.bDirectories = ShowDirectory;
+    Options.bRecursive = Recursive;
+    return FAGTDirectoryIndex::Get().List(Path, Options, Nodes, Policy);
+}
+
+bool UAdvanceGameToolLibrary::CachedIsFile(const FString& Path, EAGTCachePolicy Policy)
+{
+    const FFileStatData Stat = FAGTDirectoryIndex::Get().GetStat(Path, Policy);
+    return Stat.bIsValid && !Stat.bIsDirectory;
+}
+
+bool UAdvanceGameToolLibrary::CachedIsDirectory(const FString& Path, EAGTCachePolicy Policy)
+{
+    const FFileStatData Stat = FAGTDirectoryIndex::Get().GetStat(Path, Policy);
+    return Stat.bIsValid && Stat.bIsDirectory;
+}
+
+int64 UAdvanceGameToolLibrary::CachedGetFileSize(const FString& Path, EAGTCachePolicy Policy)
+{
+    const FFileStatData Stat = FAGTDirectoryIndex::Get().GetStat(Path, Policy);
+    return Stat.bIsValid && !Stat.bIsDirectory ? Stat.FileSize : -1;
+}
+
+#pragma endregion
+
+#pragma region BlobStore
+
+bool UAdvanceGameToolLibrary::BlobStorePut(const FString& Root, const FString& Name, const TArray<uint8>& Bytes, FAGTBlobStoreStats& Stats, FString& Error, EAGTWriteMode Mode)
+{
+    return FAGTBlobStore::Get(Root)->Put(Name, Bytes.GetData(), Bytes.Num(), Mode, Stats, Error);
+}
+
+bool UAdvanceGameToolLibrary::BlobStoreRead(const FString& Root, const FString& Name, TArray<uint8>& Bytes, FString& Error)
+{
+    return FAGTBlobStore::Get(Root)->Read(Name, Bytes, Error);
+}
+
+bool UAdvanceGameToolLibrary::BlobStoreRemove(const FString& Root, const FString& Name)
+{
+    return FAGTBlobStore::Get(Root)->Remove(Name);
+}
+
+FAGTBlobStoreStats UAdvanceGameToolLibrary::BlobStoreCollectGarbage(const FString& Root)
+{
+    return FAGTBlobStore::Get(Root)->CollectGarbage();
+}
+
+#pragma endregion
+
 #pragma region Screenshot
 
 bool UAdvanceGameToolLibrary::TakeScreenShot(FString Filename, FString& Path, bool PrefixTimestamp, bool ShowUI)
@@ -1041,22 +1895,45 @@ UTexture2D* UAdvanceGameToolLibrary::LoadScreenshot(FString Path, bool& Success)
 
 #pragma region
 
-bool UAdvanceGameToolLibrary::DatatableToCSV(UDataTable* Table, FString& Output)
+bool UAdvanceGameToolLibrary::DatatableToCSV(UDataTable* Table, FString& Output, bool Parallel)
+{
+    if (Table == nullptr || !Table->RowStruct)
+    {
+        return false;
+    }
+    return UAdvanceGameToolLibrary::WriteTableToCSV(*Table, Output, Parallel);
+}
+
+bool UAdvanceGameToolLibrary::DataTableToJSON(UDataTable* Table, FString& Output, bool Pretty, bool Parallel)
+{
+    if (Table == nullptr || !Table->RowStruct)
+    {
+        return false;
+    }
+    return UAdvanceGameToolLibrary::WriteTableToJSON(*Table, Output, Pretty, Parallel);
+}
+
+bool UAdvanceGameToolLibrary::DatatableToCSVFile(UDataTable* Table, const FString& Path, FString& Error, bool Parallel)
 {
     if (Table == nullptr || !Table->RowStruct)
     {
+        Error = FString("Invalid datatable");
         return false;
     }
-    return UAdvanceGameToolLibrary::WriteTableToCSV(*Table, Output);
+    return FAGTChunkedExport::ToFile(
+        Path, [Table, Parallel](FAGTChunkedExport::FSink Sink) { return UAdvanceGameToolLibrary::WriteTableToCSV(*Table, Sink, Parallel); }, Error);
 }
 
-bool UAdvanceGameToolLibrary::DataTableToJSON(UDataTable* Table, FString& Output)
+bool UAdvanceGameToolLibrary::DataTableToJSONFile(UDataTable* Table, const FString& Path, FString& Error, bool Pretty, bool Parallel)
 {
     if (Table == nullptr || !Table->RowStruct)
     {
+        Error = FString("Invalid datatable");
         return false;
     }
-    return UAdvanceGameToolLibrary::WriteTableToJSON(*Table, Output);
+    return FAGTChunkedExport::ToFile(
+        Path, [Table, Pretty, Parallel](FAGTChunkedExport::FSink Sink) { return UAdvanceGameToolLibrary::WriteTableToJSON(*Table, Pretty, Sink, Parallel); },
+        Error);
 }
 
 UDataTable* UAdvanceGameToolLibrary::CSVToDataTable(FString CSV, UScriptStruct* Struct, bool& Success)
@@ -1093,7 +1970,30 @@ UDataTable* UAdvanceGameToolLibrary::JSONToDataTable(FString JSON, UScriptStruct
     return DataTable;
 }
 
-bool UAdvanceGameToolLibrary::WriteTableToCSV(const UDataTable& InDataTable, FString& Output)
+TArray<TPair<FName, const uint8*>> UAdvanceGameToolLibrary::GetTableRows(const UDataTable& InDataTable)
+{
+    TArray<TPair<FName, const uint8*>> Rows;
+    Rows.Reserve(InDataTable.GetRowMap().Num());
+    for (auto RowIt = InDataTable.GetRowMap().CreateConstIterator(); RowIt; ++RowIt)
+    {
+        Rows.Emplace(RowIt.Key(), RowIt.Value());
+    }
+    return Rows;
+}
+
+bool UAdvanceGameToolLibrary::WriteTableToCSV(const UDataTable& InDataTable, FString& Output, bool bParallel)
+{
+    return UAdvanceGameToolLibrary::WriteTableToCSV(
+        InDataTable,
+        [&Output](const FString& Text)
+        {
+            Output += Text;
+            return true;
+        },
+        bParallel);
+}
+
+bool UAdvanceGameToolLibrary::WriteTableToCSV(const UDataTable& InDataTable, TFunctionRef<bool(const FString&)> Sink, bool bParallel)
 {
     if (!InDataTable.RowStruct)
     {
@@ -1101,6 +2001,7 @@ bool UAdvanceGameToolLibrary::WriteTableToCSV(const UDataTable& InDataTable, FSt
     }
 
     // Write the header (column titles)
+    FString Output;
     FString ImportKeyField;
     if (!InDataTable.ImportKeyField.IsEmpty())
     {
@@ -1132,20 +2033,25 @@ bool UAdvanceGameToolLibrary::WriteTableToCSV(const UDataTable& InDataTable, FSt
         Output += ColumnHeader;
     }
     Output += TEXT("\n");
-
-    // Write each row
-    for (auto RowIt = InDataTable.GetRowMap().CreateConstIterator(); RowIt; ++RowIt)
+    if (!Sink(Output))
     {
-        FName RowName = RowIt.Key();
-        Output += RowName.ToString();
-
-        uint8* RowData = RowIt.Value();
-        UAdvanceGameToolLibrary::WriteRowToCSV(InDataTable.RowStruct, RowData, Output);
-
-        Output += TEXT("\n");
+        return false;
     }
 
-    return true;
+    // Write the rows, chunks of them on worker threads when the caller opted in
+    const TArray<TPair<FName, const uint8*>> Rows = UAdvanceGameToolLibrary::GetTableRows(InDataTable);
+    return FAGTChunkedExport::Run(
+        Rows.Num(),
+        [&InDataTable, &Rows](int32 Begin, int32 End, FString& Chunk)
+        {
+            for (int32 Index = Begin; Index < End; ++Index)
+            {
+                Chunk += Rows[Index].Key.ToString();
+                UAdvanceGameToolLibrary::WriteRowToCSV(InDataTable.RowStruct, Rows[Index].Value, Chunk);
+                Chunk += TEXT("\n");
+            }
+        },
+        Sink, bParallel);
 }
 
 bool UAdvanceGameToolLibrary::WriteRowToCSV(const UScriptStruct* InRowStruct, const void* InRowData, FString& ExportedText)
@@ -1189,31 +2095,77 @@ FString UAdvanceGameToolLibrary::GetKeyFieldName(const UDataTable& InDataTable)
     return ExplicitString;
 }
 
-bool UAdvanceGameToolLibrary::WriteTableToJSON(const UDataTable& InDataTable, FString& OutExportText)
+bool UAdvanceGameToolLibrary::WriteTableToJSON(const UDataTable& InDataTable, FString& OutExportText, bool bPretty, bool bParallel)
+{
+    return UAdvanceGameToolLibrary::WriteTableToJSON(
+        InDataTable, bPretty,
+        [&OutExportText](const FString& Text)
+        {
+            OutExportText += Text;
+            return true;
+        },
+        bParallel);
+}
+
+bool UAdvanceGameToolLibrary::WriteTableToJSON(const UDataTable& InDataTable, bool bPretty, TFunctionRef<bool(const FString&)> Sink, bool bParallel)
 {
     if (!InDataTable.RowStruct)
     {
         return false;
     }
 
-    TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> JsonWriter = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&OutExportText);
+    const TArray<TPair<FName, const uint8*>> Rows = UAdvanceGameToolLibrary::GetTableRows(InDataTable);
+    if (!Sink(TEXT("[")))
+    {
+        return false;
+    }
+
+    const bool bRowsWritten = FAGTChunkedExport::Run(
+        Rows.Num(),
+        [&InDataTable, &Rows, bPretty](int32 Begin, int32 End, FString& Chunk)
+        {
+            // Chunks after the first continue the array
+            if (Begin > 0)
+            {
+                Chunk += TEXT(",");
+            }
+            const TArrayView<const TPair<FName, const uint8*>> ChunkRows(Rows.GetData() + Begin, End - Begin);
+            if (bPretty)
+            {
+                UAdvanceGameToolLibrary::WriteTableRowsToJSON<TPrettyJsonPrintPolicy<TCHAR>>(InDataTable, ChunkRows, Chunk);
+            }
+            else
+            {
+                UAdvanceGameToolLibrary::WriteTableRowsToJSON<TCondensedJsonPrintPolicy<TCHAR>>(InDataTable, ChunkRows, Chunk);
+            }
+        },
+        Sink, bParallel);
+
+    // Same ending a single pretty writer gives the array
+    return bRowsWritten && Sink(bPretty && Rows.Num() > 0 ? LINE_TERMINATOR TEXT("]") : TEXT("]"));
+}
+
+template <class PrintPolicy>
+void UAdvanceGameToolLibrary::WriteTableRowsToJSON(const UDataTable& InDataTable, TArrayView<const TPair<FName, const uint8*>> InRows, FString& OutExportText)
+{
+    // Each chunk is written as an array of its own so the writer indents the rows as it would in the whole table
+    FString ChunkText;
+    TSharedRef<TJsonWriter<TCHAR, PrintPolicy>> JsonWriter = TJsonWriterFactory<TCHAR, PrintPolicy>::Create(&ChunkText);
 
     FString KeyField = UAdvanceGameToolLibrary::GetKeyFieldName(InDataTable);
 
     JsonWriter->WriteArrayStart();
 
     // Iterate over rows
-    for (auto RowIt = InDataTable.GetRowMap().CreateConstIterator(); RowIt; ++RowIt)
+    for (const TPair<FName, const uint8*>& Row : InRows)
     {
         JsonWriter->WriteObjectStart();
         {
             // RowName
-            const FName RowName = RowIt.Key();
-            JsonWriter->WriteValue(KeyField, RowName.ToString());
+            JsonWriter->WriteValue(KeyField, Row.Key.ToString());
 
             // Now the values
-            uint8* RowData = RowIt.Value();
-            UAdvanceGameToolLibrary::WriteRowToJSON(InDataTable.RowStruct, RowData, JsonWriter);
+            UAdvanceGameToolLibrary::WriteRowToJSON(InDataTable.RowStruct, Row.Value, JsonWriter);
         }
         JsonWriter->WriteObjectEnd();
     }
@@ -1222,7 +2174,12 @@ bool UAdvanceGameToolLibrary::WriteTableToJSON(const UDataTable& InDataTable, FS
 
     JsonWriter->Close();
 
-    return true;
+    // Only the rows are kept, the brackets belong to the whole table
+    int32 LastRowEnd = INDEX_NONE;
+    if (ChunkText.FindLastChar(TEXT('}'), LastRowEnd))
+    {
+        OutExportText.AppendChars(*ChunkText + 1, LastRowEnd);
+    }
 }
 
 bool UAdvanceGameToolLibrary::WriteTableAsObjectToJSON(const UDataTable& InDataTable, TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> JsonWriter)
@@ -1252,7 +2209,8 @@ bool UAdvanceGameToolLibrary::WriteTableAsObjectToJSON(const UDataTable& InDataT
     return true;
 }
 
-bool UAdvanceGameToolLibrary::WriteRowToJSON(const UScriptStruct* InRowStruct, const void* InRowData, TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> JsonWriter)
+template <class PrintPolicy>
+bool UAdvanceGameToolLibrary::WriteRowToJSON(const UScriptStruct* InRowStruct, const void* InRowData, TSharedRef<TJsonWriter<TCHAR, PrintPolicy>> JsonWriter)
 {
     if (!InRowStruct)
     {
@@ -1262,7 +2220,8 @@ bool UAdvanceGameToolLibrary::WriteRowToJSON(const UScriptStruct* InRowStruct, c
     return UAdvanceGameToolLibrary::WriteStructToJSON(InRowStruct, InRowData, JsonWriter);
 }
 
-bool UAdvanceGameToolLibrary::WriteStructToJSON(const UScriptStruct* InStruct, const void* InStructData, TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> JsonWriter)
+template <class PrintPolicy>
+bool UAdvanceGameToolLibrary::WriteStructToJSON(const UScriptStruct* InStruct, const void* InStructData, TSharedRef<TJsonWriter<TCHAR, PrintPolicy>> JsonWriter)
 {
     for (TFieldIterator<const FProperty> It(InStruct); It; ++It)
     {
@@ -1293,8 +2252,9 @@ bool UAdvanceGameToolLibrary::WriteStructToJSON(const UScriptStruct* InStruct, c
     return true;
 }
 
+template <class PrintPolicy>
 bool UAdvanceGameToolLibrary::WriteStructEntryToJSON(
-    const void* InRowData, const FProperty* InProperty, const void* InPropertyData, TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> JsonWriter)
+    const void* InRowData, const FProperty* InProperty, const void* InPropertyData, TSharedRef<TJsonWriter<TCHAR, PrintPolicy>> JsonWriter)
 {
     const FString Identifier = DataTableUtils::GetPropertyExportName(InProperty, EDataTableExportFlags::UseJsonObjectsForStructs);
 
@@ -1390,8 +2350,9 @@ bool UAdvanceGameToolLibrary::WriteStructEntryToJSON(
     return true;
 }
 
+template <class PrintPolicy>
 bool UAdvanceGameToolLibrary::WriteContainerEntryToJSON(
-    const FProperty* InProperty, const void* InPropertyData, const FString* InIdentifier, TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> JsonWriter)
+    const FProperty* InProperty, const void* InPropertyData, const FString* InIdentifier, TSharedRef<TJsonWriter<TCHAR, PrintPolicy>> JsonWriter)
 {
     if (const FEnumProperty* EnumProp = CastField<const FEnumProperty>(InProperty))
     {
@@ -1451,7 +2412,8 @@ bool UAdvanceGameToolLibrary::WriteContainerEntryToJSON(
     return true;
 }
 
-void UAdvanceGameToolLibrary::WriteJSONObjectStartWithOptionalIdentifier(TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> JsonWriter, const FString* InIdentifier)
+template <class PrintPolicy>
+void UAdvanceGameToolLibrary::WriteJSONObjectStartWithOptionalIdentifier(TSharedRef<TJsonWriter<TCHAR, PrintPolicy>> JsonWriter, const FString* InIdentifier)
 {
     if (InIdentifier)
     {
@@ -1463,7 +2425,8 @@ void UAdvanceGameToolLibrary::WriteJSONObjectStartWithOptionalIdentifier(TShared
     }
 }
 
-void UAdvanceGameToolLibrary::WriteJSONValueWithOptionalIdentifier(TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> JsonWriter, const FString* InIdentifier, const TCHAR* InValue)
+template <class PrintPolicy>
+void UAdvanceGameToolLibrary::WriteJSONValueWithOptionalIdentifier(TSharedRef<TJsonWriter<TCHAR, PrintPolicy>> JsonWriter, const FString* InIdentifier, const TCHAR* InValue)
 {
     if (InIdentifier)
     {
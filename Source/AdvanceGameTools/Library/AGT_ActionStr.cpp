@@ -1,6 +1,10 @@
 ﻿/** Copyright Mark Veligod. Published in 2023. **/
 
 #include "SHA256Hash.h"
+#include "AdvanceGameTools/Library/AGTSha256.h"
+#include "AdvanceGameTools/Library/AGTHashCache.h"
+#include "AdvanceGameTools/Library/AGTFingerprint.h"
+#include "AdvanceGameTools/Library/AGTTreeHash.h"
 #include "AdvanceGameTools/Library/AdvanceGameToolLibrary.h"
 #include "Misc/Paths.h"
 #include "Internationalization/StringTable.h"
@@ -226,9 +230,194 @@ void UAdvanceGameToolLibrary::SHA256HashFromArray(FSHA256Hash& SHA256, const TAr
     SHA256.FromArray(Arr);
 }
 
+void UAdvanceGameToolLibrary::SHA256HashFromStrings(const TArray<FString>& Strings, TArray<FString>& Hashes)
+{
+    TArray<uint8> Digests;
+    Digests.SetNumUninitialized(Strings.Num() * FAGTSha256::DigestSize);
+    FAGTSha256::HashStrings(Strings, Digests);
+
+    // Existing entries keep their buffers, the hex digits are written in place
+    static const TCHAR* Digits = TEXT("0123456789abcdef");
+    Hashes.SetNum(Strings.Num());
+    for (int32 Index = 0; Index < Strings.Num(); ++Index)
+    {
+        TArray<TCHAR>& Chars = Hashes[Index].GetCharArray();
+        Chars.SetNumUninitialized(FAGTSha256::DigestSize * 2 + 1);
+        const uint8* Digest = Digests.GetData() + Index * FAGTSha256::DigestSize;
+        for (int32 Byte = 0; Byte < FAGTSha256::DigestSize; ++Byte)
+        {
+            Chars[Byte * 2] = Digits[Digest[Byte] >> 4];
+            Chars[Byte * 2 + 1] = Digits[Digest[Byte] & 0xf];
+        }
+        Chars[FAGTSha256::DigestSize * 2] = TEXT('\0');
+    }
+}
+
+bool UAdvanceGameToolLibrary::SHA256HashFromFiles(const TArray<FString>& Filenames, TArray<FString>& Hashes)
+{
+    FAGTBatchHash Batch(Filenames, 1);
+    Batch.Run();
+    Hashes = Batch.GetHashes();
+    return Batch.GetResult() == EAGTFileIOResult::Success;
+}
+
+bool UAdvanceGameToolLibrary::SHA256HashFromFilesCached(const TArray<FString>& Filenames, TArray<FString>& Hashes)
+{
+    return FAGTHashCache::Get().Hash(Filenames, Hashes);
+}
+
+bool UAdvanceGameToolLibrary::SaveFileHashCache()
+{
+    return FAGTHashCache::Get().Save();
+}
+
+void UAdvanceGameToolLibrary::GetFileHashCacheStats(int64& cached, int64& hashed)
+{
+    const FAGTHashCache& cache = FAGTHashCache::Get();
+    cached = cache.GetHits();
+    hashed = cache.GetMisses();
+}
+
 FString UAdvanceGameToolLibrary::SHA256HashGetHash(FSHA256Hash& SHA256)
 {
     return SHA256.GetHash();
 }
 
+bool UAdvanceGameToolLibrary::SHA256TreeHashFile(const FString& Filename, const FString& TreeFile, FString& RootHash, const int64 LeafSize)
+{
+    FAGTTreeHash tree;
+    FString error;
+    if (!tree.Build(Filename, LeafSize) || !tree.Save(TreeFile, error))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Could not tree hash %s %s"), *Filename, *error);
+        return false;
+    }
+    RootHash = tree.GetRootHex();
+    return true;
+}
+
+bool UAdvanceGameToolLibrary::SHA256TreeVerifyFile(const FString& Filename, const FString& TreeFile, TArray<int64>& ChangedOffsets, const int64 Offset, const int64 Length)
+{
+    ChangedOffsets.Reset();
+    FAGTTreeHash tree;
+    TArray<int32> changed;
+    if (!tree.Load(TreeFile) || !tree.Verify(Filename, Offset, Length, changed))
+    {
+        return false;
+    }
+    for (const int32 leaf : changed)
+    {
+        ChangedOffsets.Add(leaf * tree.GetLeafSize());
+    }
+    return true;
+}
+
+bool UAdvanceGameToolLibrary::SHA256TreeHashRange(const FString& Filename, const int64 Offset, const int64 Length, FString& RootHash, const int64 LeafSize)
+{
+    return FAGTTreeHash::HashRange(Filename, Offset, Length, RootHash, LeafSize);
+}
+
+void UAdvanceGameToolLibrary::FingerprintFromString(FAGTFingerprint& Fingerprint, const FString& Str)
+{
+    Fingerprint.FromString(Str);
+}
+
+bool UAdvanceGameToolLibrary::FingerprintFromFile(FAGTFingerprint& Fingerprint, const FString& Filename)
+{
+    return Fingerprint.FromFile(Filename);
+}
+
+void UAdvanceGameToolLibrary::FingerprintFromArray(FAGTFingerprint& Fingerprint, const TArray<uint8>& Arr)
+{
+    Fingerprint.FromArray(Arr);
+}
+
+FString UAdvanceGameToolLibrary::FingerprintGetHash(const FAGTFingerprint& Fingerprint)
+{
+    return Fingerprint.GetHash();
+}
+
+bool UAdvanceGameToolLibrary::EqualEqual_Fingerprint(const FAGTFingerprint& A, const FAGTFingerprint& B)
+{
+    return A == B;
+}
+
+#pragma endregion
+
+#pragma region AsyncHashFiles
+
+UAGTAsyncHashFiles* UAGTAsyncHashFiles::SHA256HashFromFilesAsync(UObject* WorldContextObject, const TArray<FString>& Filenames, int32 Concurrency)
+{
+    UAGTAsyncHashFiles* BlueprintNode = NewObject<UAGTAsyncHashFiles>();
+    BlueprintNode->Batch = MakeShared<FAGTBatchHash, ESPMode::ThreadSafe>(Filenames, Concurrency);
+    BlueprintNode->RegisterWithGameInstance(WorldContextObject);
+    return BlueprintNode;
+}
+
+void UAGTAsyncHashFiles::Activate()
+{
+    if (!Batch.IsValid())
+    {
+        SetReadyToDestroy();
+        return;
+    }
+
+    TWeakObjectPtr<UAGTAsyncHashFiles> WeakThis(this);
+    Batch->Start(
+        [WeakThis](FAGTBatchHash& InBatch)
+        {
+            if (UAGTAsyncHashFiles* Action = WeakThis.Get())
+            {
+                Action->OnHashComplete(InBatch);
+            }
+        });
+    TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UAGTAsyncHashFiles::TickProgress));
+}
+
+void UAGTAsyncHashFiles::Cancel()
+{
+    if (Batch.IsValid())
+    {
+        Batch->Cancel();
+    }
+}
+
+bool UAGTAsyncHashFiles::TickProgress(float DeltaTime)
+{
+    if (!Batch.IsValid() || !Batch->IsRunning())
+    {
+        TickerHandle.Reset();
+        return false;
+    }
+    const FAGTFileOperationProgress Current = Batch->GetProgress();
+    if (Current.BytesDone != LastBytesDone)
+    {
+        LastBytesDone = Current.BytesDone;
+        Progress.Broadcast(Current);
+    }
+    return true;
+}
+
+void UAGTAsyncHashFiles::OnHashComplete(FAGTBatchHash& InBatch)
+{
+    if (TickerHandle.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+        TickerHandle.Reset();
+    }
+
+    const EAGTFileIOResult Result = InBatch.GetResult();
+    if (Result == EAGTFileIOResult::Success)
+    {
+        Progress.Broadcast(InBatch.GetProgress());
+        Completed.Broadcast(Result, InBatch.GetHashes(), InBatch.GetErrors());
+    }
+    else
+    {
+        Failed.Broadcast(Result, InBatch.GetHashes(), InBatch.GetErrors());
+    }
+    Batch.Reset();
+    SetReadyToDestroy();
+}
+
 #pragma endregion
@@ -8,6 +8,15 @@
 #include "Misc/OutputDeviceNull.h"
 #include "Kismet/BlueprintAsyncActionBase.h"
 #include "XmlNode.h"
+#include "AdvanceGameTools/Library/AGTMappedFileView.h"
+#include "AdvanceGameTools/Library/AGTFileIOQueue.h"
+#include "AdvanceGameTools/Library/AGTBulkFileOperation.h"
+#include "AdvanceGameTools/Library/AGTBatchHash.h"
+#include "AdvanceGameTools/Library/AGTPositionalReader.h"
+#include "AdvanceGameTools/Library/AGTReadAhead.h"
+#include "AdvanceGameTools/Library/AGTFileChange.h"
+#include "Containers/Ticker.h"
+#include "Internationalization/Regex.h"
 #include "AdvanceGameToolLibrary.generated.h"
 
 /** Preprocesses for timers **/
@@ -20,6 +29,9 @@
 
 class UCanvasPanel;
 class UAGTFileHandle;
+class UAGTMappedFile;
+class UAGTLineReader;
+struct FAGTFingerprint;
 
 /**
  * @class ADVANCE GAME TOOL LIBRARY
@@ -64,6 +76,25 @@ public:
     UFUNCTION(BlueprintCallable, Category = "ActionFiles")
     static bool FileLoadString(FString FileName, FString& Text);
 
+    /**
+     * Append Text to FileName in the project log directory. Callable from any thread, the text is written in batches on a background thread.
+     */
+    UFUNCTION(BlueprintCallable, Category = "ActionFiles")
+    static void FileAppendString(FString Text, FString FileName, const bool addNewLine = true);
+
+    /**
+     * Block until everything passed to FileAppendString so far has been written.
+     */
+    UFUNCTION(BlueprintCallable, Category = "ActionFiles")
+    static void FlushAppendedStrings();
+
+    /**
+     * Rotate the files of FileAppendString once they exceed maxFileSize bytes or have been open for maxFileAge seconds. 0 disables a limit.
+     * Rotated files are kept as Name.1.ext, Name.2.ext... up to maxBackups.
+     */
+    UFUNCTION(BlueprintCallable, Category = "ActionFiles")
+    static void SetAppendRotation(const int64 maxFileSize = 0, const float maxFileAge = 0.0f, const int32 maxBackups = 5);
+
     /**
      * Open a file handle for reading and writing to a file. Use the file handle object to seek, read, write, etc.
      */
@@ -75,10 +106,11 @@ public:
      * @param filePath The full path to the file to write to
      * @param allowOverwrite If true, if the file exists it will be overwritten, or the function will return false
      * @param bytesOut The bytes to write out to the file
+     * @param writeMode Direct writes over the file, the atomic modes replace it through a synced temp file
      * @return True if success
      */
     UFUNCTION(BlueprintCallable, Category = "ActionFiles")
-    static bool WriteBytesToFile(const FString filePath, const bool allowOverwrite, const TArray<uint8>& bytesOut);
+    static bool WriteBytesToFile(const FString filePath, const bool allowOverwrite, const TArray<uint8>& bytesOut, const EAGTWriteMode writeMode = EAGTWriteMode::Direct);
 
     /**
      * Read all bytes from a file and put them into bytesIn
@@ -101,6 +133,62 @@ public:
     UFUNCTION(BlueprintCallable, Category = "ActionFiles")
     static bool ReadBytesFromFile(const FString filePath, TArray<uint8>& bytesIn, const int64 offset = 0, const int64 numBytes = 99999999999);
 
+    /**
+     * Read many ranges of a file in one call. Overlapping and adjacent ranges are merged and read together.
+     * @param filePath The full path to the file to read from
+     * @param ranges The offset and length of every range
+     * @param bytesIn All bytes that were read, back to back
+     * @param slices Where each range is located inside bytesIn, in the order of ranges
+     * @return True if success
+     */
+    UFUNCTION(BlueprintCallable, Category = "ActionFiles")
+    static bool ReadRangesFromFile(const FString& filePath, const TArray<FAGTReadRange>& ranges, TArray<uint8>& bytesIn, TArray<FAGTReadRange>& slices);
+
+    /**
+     * Read many ranges of a file in one call, one array per range
+     * @param filePath The full path to the file to read from
+     * @param ranges The offset and length of every range
+     * @param chunks The bytes of each range, in the order of ranges
+     * @return True if success
+     */
+    UFUNCTION(BlueprintCallable, Category = "ActionFiles")
+    static bool ReadRangesFromFileSeparate(const FString& filePath, const TArray<FAGTReadRange>& ranges, TArray<FAGTByteArray>& chunks);
+
+    /**
+     * Statistics of the pool of open files shared by ReadAllBytesFromFile, ReadBytesFromFile and SHA256HashFromFile
+     * @param reused Reads that found the file already open
+     * @param opened Reads that had to open the file
+     * @param openFiles Files currently kept open
+     */
+    UFUNCTION(BlueprintPure, Category = "ActionFiles")
+    static void GetFileHandlePoolStats(int64& reused, int64& opened, int32& openFiles);
+
+    /**
+     * Change how many files the pool keeps open. The least recently used ones are closed first.
+     */
+    UFUNCTION(BlueprintCallable, Category = "ActionFiles")
+    static void SetFileHandlePoolLimit(const int32 maxOpenFiles = 64);
+
+    /**
+     * Map a file read-only into memory. Use the mapped file object to read slices without loading the whole file.
+     * If the platform can't map the file, the object falls back to buffered reads.
+     * @param filePath The full path to the file to map
+     * @return The mapped file or nullptr if the file could not be opened
+     */
+    UFUNCTION(BlueprintCallable, Category = "ActionFiles")
+    static UAGTMappedFile* OpenMappedFile(UObject* outer, const FString filePath, bool& success);
+
+    /**
+     * Open a streaming line reader. The reader goes through the file with a fixed-size buffer and returns lines in batches,
+     * so memory use does not depend on the file size.
+     * @param filePath The full path to the file to read
+     * @param pattern Optional regex, only lines matching it are returned
+     * @param bufferSize Size of the read buffer in bytes
+     * @return The reader or nullptr if the file could not be opened
+     */
+    UFUNCTION(BlueprintCallable, Category = "ActionFiles")
+    static UAGTLineReader* OpenLineReader(UObject* outer, const FString filePath, const FString pattern, bool& success, const int32 bufferSize = 65536);
+
 #pragma region Paths
 
 public:
@@ -123,7 +211,7 @@ public:
     static bool ReadText(FString Path, FString& Output);
     UFUNCTION(BlueprintCallable, meta = (DisplayName = "WriteTextFile", CompactNodeTitle = "WriteText", Keywords = "File plugin write text", ToolTip = "Save a standard text file"),
         Category = "ActionFiles|Text")
-    static bool SaveText(FString Path, FString Text, FString& Error, bool Append = false, bool Force = false);
+    static bool SaveText(FString Path, FString Text, FString& Error, bool Append = false, bool Force = false, EAGTWriteMode Mode = EAGTWriteMode::Direct);
     UFUNCTION(BlueprintCallable,
         meta = (DisplayName = "ReadLineFile", CompactNodeTitle = "ReadLine", Keywords = "File plugin read text lines pattern", ToolTip = "Read the lines of a standard text file"),
         Category = "ActionFiles|Text")
@@ -135,7 +223,23 @@ public:
     static bool ReadByte(FString Path, TArray<uint8>& Bytes);
     UFUNCTION(
         BlueprintCallable, meta = (DisplayName = "WriteByteFile", CompactNodeTitle = "WriteByte", Keywords = "File plugin write byte", ToolTip = "Save byte to file"), Category = "ActionFiles|Byte")
-    static bool SaveByte(FString Path, const TArray<uint8>& Bytes, FString& Error, bool Append = false, bool Force = false);
+    static bool SaveByte(FString Path, const TArray<uint8>& Bytes, FString& Error, bool Append = false, bool Force = false, EAGTWriteMode Mode = EAGTWriteMode::Direct);
+    UFUNCTION(BlueprintCallable,
+        meta = (DisplayName = "WriteCompressedByteFile", CompactNodeTitle = "WriteCompressed", Keywords = "File plugin write byte compress lz4 zlib oodle",
+            ToolTip = "Save bytes to a file as independently compressed blocks"),
+        Category = "ActionFiles|Byte")
+    static bool SaveByteCompressed(FString Path, const TArray<uint8>& Bytes, FString& Error, bool Force = false, EAGTCompression Codec = EAGTCompression::LZ4,
+        int32 BlockSize = 262144, EAGTWriteMode Mode = EAGTWriteMode::Direct);
+    UFUNCTION(BlueprintCallable,
+        meta = (DisplayName = "ReadCompressedByteFile", CompactNodeTitle = "ReadCompressed", Keywords = "File plugin read byte compress decompress",
+            ToolTip = "Read a file written by WriteCompressedByteFile"),
+        Category = "ActionFiles|Byte")
+    static bool ReadByteCompressed(FString Path, TArray<uint8>& Bytes);
+    UFUNCTION(BlueprintCallable,
+        meta = (DisplayName = "ReadCompressedByteRange", Keywords = "File plugin read byte compress decompress range seek",
+            ToolTip = "Read part of a compressed file, only the blocks covering the range are decompressed"),
+        Category = "ActionFiles|Byte")
+    static bool ReadByteCompressedRange(FString Path, const int64 Offset, const int64 Length, TArray<uint8>& Bytes);
 
 #pragma endregion
 
@@ -144,17 +248,25 @@ public:
 public:
     UFUNCTION(BlueprintPure, meta = (DisplayName = "StrToBase64", CompactNodeTitle = "ToBase64", Keywords = "File plugin string convert base64 encode", ToolTip = "Encodes a string to base64"),
         Category = "ActionFiles|Text")
-    static FString StringToBase64(const FString Source);
+    static FString StringToBase64(const FString& Source);
     UFUNCTION(BlueprintPure, meta = (DisplayName = "StrFromBase64", CompactNodeTitle = "FromBase64", Keywords = "File plugin string convert decode base64", ToolTip = "Decodes a string from base64"),
         Category = "ActionFiles|Text")
-    static bool StringFromBase64(FString Base64Str, FString& Result);
+    static bool StringFromBase64(const FString& Base64Str, FString& Result);
     UFUNCTION(BlueprintPure, meta = (DisplayName = "BytesToBase64", CompactNodeTitle = "ToBase64", Keywords = "File plugin bytes convert base64 encode", ToolTip = "Encodes a byte array to base64"),
         Category = "ActionFiles|Byte")
-    static FString BytesToBase64(const TArray<uint8> Bytes);
+    static FString BytesToBase64(const TArray<uint8>& Bytes);
     UFUNCTION(BlueprintPure,
         meta = (DisplayName = "BytesFromBase64", CompactNodeTitle = "FromBase64", Keywords = "File plugin bytes convert base64 decode", ToolTip = "Decodes a byte array from base64"),
         Category = "ActionFiles|Byte")
-    static bool BytesFromBase64(const FString Source, TArray<uint8>& Out);
+    static bool BytesFromBase64(const FString& Source, TArray<uint8>& Out);
+    UFUNCTION(BlueprintCallable,
+        meta = (DisplayName = "Base64EncodeFile", Keywords = "File plugin base64 encode stream", ToolTip = "Encodes a file to base64 in fixed size chunks, without loading it whole"),
+        Category = "ActionFiles|Byte")
+    static bool Base64EncodeFile(const FString& SourcePath, const FString& DestPath, FString& Error);
+    UFUNCTION(BlueprintCallable,
+        meta = (DisplayName = "Base64DecodeFile", Keywords = "File plugin base64 decode stream", ToolTip = "Decodes a base64 file in fixed size chunks, without loading it whole"),
+        Category = "ActionFiles|Byte")
+    static bool Base64DecodeFile(const FString& SourcePath, const FString& DestPath, FString& Error);
 
 #pragma endregion
 
@@ -162,11 +274,16 @@ public:
 
 public:
     UFUNCTION(BlueprintCallable, meta = (DisplayName = "WriteCSVFile", CompactNodeTitle = "WriteCSV", Keywords = "File plugin write csv", ToolTip = "Save a csv file"), Category = "ActionFiles|CSV")
-    static bool SaveCSV(FString Path, TArray<FString> Headers, TArray<FString> Data, int32& Total, bool Force = false);
+    static bool SaveCSV(const FString& Path, const TArray<FString>& Headers, const TArray<FString>& Data, int32& Total, bool Force = false);
 
     UFUNCTION(BlueprintCallable, meta = (DisplayName = "ReadCSVFile", CompactNodeTitle = "ReadCSV", Keywords = "File plugin read csv", ToolTip = "Read a csv file"), Category = "ActionFiles|CSV")
     static bool ReadCSV(FString Path, TArray<FString>& Headers, TArray<FString>& Data, int32& Total, bool HeaderFirst = true);
 
+    UFUNCTION(BlueprintCallable,
+        meta = (DisplayName = "ReadCSVColumns", Keywords = "File plugin read csv column typed stream", ToolTip = "Stream a UTF-8 csv file from disk into typed columns"),
+        Category = "ActionFiles|CSV")
+    static bool ReadCSVColumns(const FString& Path, const TArray<EAGTCsvColumnType>& ColumnTypes, TArray<FAGTCsvColumn>& Columns, int32& Rows, bool HeaderFirst = true);
+
 #pragma endregion
 
 #pragma region CSVConvert
@@ -178,7 +295,7 @@ public:
 
     UFUNCTION(
         BlueprintCallable, meta = (DisplayName = "CSVToString", CompactNodeTitle = "CSVToStr", Keywords = "File plugin csv string", ToolTip = "convert a csv to string"), Category = "ActionFiles|CSV")
-    static bool CSVToString(FString& Result, TArray<FString> Headers, TArray<FString> Data, int32& Total);
+    static bool CSVToString(FString& Result, const TArray<FString>& Headers, const TArray<FString>& Data, int32& Total);
 
 #pragma endregion
 
@@ -336,6 +453,60 @@ public:
 
 #pragma endregion
 
+#pragma region DirectoryIndex
+
+public:
+    UFUNCTION(BlueprintCallable,
+        meta = (DisplayName = "WatchDirectory", Keywords = "File plugin directory index cache watch", ToolTip = "Keeps the cached listings and stats below a directory up to date"),
+        Category = "ActionFiles|DirectoryIndex")
+    static bool WatchDirectory(const FString& Path);
+    UFUNCTION(BlueprintCallable, meta = (DisplayName = "UnwatchDirectory", Keywords = "File plugin directory index cache watch", ToolTip = "Stops watching a directory"),
+        Category = "ActionFiles|DirectoryIndex")
+    static void UnwatchDirectory(const FString& Path);
+    UFUNCTION(BlueprintCallable,
+        meta = (DisplayName = "InvalidateDirectoryIndex", Keywords = "File plugin directory index cache invalidate", ToolTip = "Drops cached listings and stats for a path"),
+        Category = "ActionFiles|DirectoryIndex")
+    static void InvalidateDirectoryIndex(const FString& Path);
+    UFUNCTION(BlueprintCallable,
+        meta = (DisplayName = "CachedListDirectory", Keywords = "File plugin directory index cache list pattern regex recursive", ToolTip = "List nodes from directory through the directory index"),
+        Category = "ActionFiles|DirectoryIndex")
+    static bool CachedListDirectory(const FString& Path, const FString& Pattern, TArray<FString>& Nodes, bool ShowFile = true, bool ShowDirectory = true, bool Recursive = false,
+        EAGTCachePolicy Policy = EAGTCachePolicy::Exact);
+    UFUNCTION(BlueprintCallable, meta = (DisplayName = "CachedIsFile", Keywords = "File plugin directory index cache exists", ToolTip = "Checks if a file exists through the directory index"),
+        Category = "ActionFiles|DirectoryIndex")
+    static bool CachedIsFile(const FString& Path, EAGTCachePolicy Policy = EAGTCachePolicy::Exact);
+    UFUNCTION(BlueprintCallable,
+        meta = (DisplayName = "CachedIsDirectory", Keywords = "File plugin directory index cache exists", ToolTip = "Checks if a directory exists through the directory index"),
+        Category = "ActionFiles|DirectoryIndex")
+    static bool CachedIsDirectory(const FString& Path, EAGTCachePolicy Policy = EAGTCachePolicy::Exact);
+    UFUNCTION(BlueprintCallable, meta = (DisplayName = "CachedGetFileSize", Keywords = "File plugin directory index cache size", ToolTip = "Gets the size of a file through the directory index"),
+        Category = "ActionFiles|DirectoryIndex")
+    static int64 CachedGetFileSize(const FString& Path, EAGTCachePolicy Policy = EAGTCachePolicy::Exact);
+
+#pragma endregion
+
+#pragma region BlobStore
+
+public:
+    UFUNCTION(BlueprintCallable,
+        meta = (DisplayName = "BlobStorePut", Keywords = "File plugin blob store dedup chunk save snapshot", ToolTip = "Stores bytes under a name, only chunks the store does not have yet are written"),
+        Category = "ActionFiles|BlobStore")
+    static bool BlobStorePut(const FString& Root, const FString& Name, const TArray<uint8>& Bytes, FAGTBlobStoreStats& Stats, FString& Error,
+        EAGTWriteMode Mode = EAGTWriteMode::Direct);
+    UFUNCTION(BlueprintCallable, meta = (DisplayName = "BlobStoreRead", Keywords = "File plugin blob store dedup chunk load snapshot", ToolTip = "Rebuilds the bytes stored under a name"),
+        Category = "ActionFiles|BlobStore")
+    static bool BlobStoreRead(const FString& Root, const FString& Name, TArray<uint8>& Bytes, FString& Error);
+    UFUNCTION(BlueprintCallable,
+        meta = (DisplayName = "BlobStoreRemove", Keywords = "File plugin blob store delete", ToolTip = "Removes a name from the store, its chunks are reclaimed by the next garbage collection"),
+        Category = "ActionFiles|BlobStore")
+    static bool BlobStoreRemove(const FString& Root, const FString& Name);
+    UFUNCTION(BlueprintCallable,
+        meta = (DisplayName = "BlobStoreCollectGarbage", Keywords = "File plugin blob store gc garbage reclaim", ToolTip = "Deletes the chunks no stored name refers to"),
+        Category = "ActionFiles|BlobStore")
+    static FAGTBlobStoreStats BlobStoreCollectGarbage(const FString& Root);
+
+#pragma endregion
+
 #pragma region Screenshot
 
 public:
@@ -352,12 +523,20 @@ public:
 #pragma region DataTable
 
 public:
-    UFUNCTION(BlueprintCallable, meta = (DisplayName = "DataTableToCSV", Keywords = "File plugin datatable csv convert export", ToolTip = "Converts a datatable to csv string"),
+    UFUNCTION(BlueprintCallable, meta = (DisplayName = "DataTableToCSV", Keywords = "File plugin datatable csv convert export", ToolTip = "Converts a datatable to csv string, optionally in parallel"),
+        Category = "ActionFiles|Datatable")
+    static bool DatatableToCSV(UDataTable* Table, FString& Output, bool Parallel = false);
+    UFUNCTION(BlueprintCallable, meta = (DisplayName = "DataTableToJSON", Keywords = "File plugin datatable json convert export", ToolTip = "Converts a datatable to json string, optionally in parallel"),
+        Category = "ActionFiles|Datatable")
+    static bool DataTableToJSON(UDataTable* Table, FString& Output, bool Pretty = true, bool Parallel = false);
+    UFUNCTION(BlueprintCallable,
+        meta = (DisplayName = "DataTableToCSVFile", Keywords = "File plugin datatable csv convert export write stream", ToolTip = "Streams a datatable to a csv file, keeps the old file on failure"),
         Category = "ActionFiles|Datatable")
-    static bool DatatableToCSV(UDataTable* Table, FString& Output);
-    UFUNCTION(BlueprintCallable, meta = (DisplayName = "DataTableToJSON", Keywords = "File plugin datatable json convert export", ToolTip = "Converts a datatable to json string"),
+    static bool DatatableToCSVFile(UDataTable* Table, const FString& Path, FString& Error, bool Parallel = false);
+    UFUNCTION(BlueprintCallable,
+        meta = (DisplayName = "DataTableToJSONFile", Keywords = "File plugin datatable json convert export write stream", ToolTip = "Streams a datatable to a json file, keeps the old file on failure"),
         Category = "ActionFiles|Datatable")
-    static bool DataTableToJSON(UDataTable* Table, FString& Output);
+    static bool DataTableToJSONFile(UDataTable* Table, const FString& Path, FString& Error, bool Pretty = true, bool Parallel = false);
     UFUNCTION(BlueprintCallable, meta = (DisplayName = "CSVToDataTable", Keywords = "File plugin datatable csv convert import", ToolTip = "Converts a csv string to datatable"),
         Category = "ActionFiles|Datatable")
     static UDataTable* CSVToDataTable(FString CSV, UScriptStruct* Struct, bool& Success);
@@ -365,22 +544,34 @@ public:
         Category = "ActionFiles|Datatable")
     static UDataTable* JSONToDataTable(FString JSON, UScriptStruct* Struct, bool& Success);
 
+    // datatable rows in order, serialized in chunks. bParallel moves the chunks to worker threads, which row ExportText does not allow for every struct
+    static TArray<TPair<FName, const uint8*>> GetTableRows(const UDataTable& InDataTable);
+
     // datatable csv
-    static bool WriteTableToCSV(const UDataTable& InDataTable, FString& Output);
+    static bool WriteTableToCSV(const UDataTable& InDataTable, FString& Output, bool bParallel = false);
+    static bool WriteTableToCSV(const UDataTable& InDataTable, TFunctionRef<bool(const FString&)> Sink, bool bParallel = false);
     static bool WriteRowToCSV(const UScriptStruct* InRowStruct, const void* InRowData, FString& ExportedText);
     static bool WriteStructEntryToCSV(const void* InRowData, FProperty* InProperty, const void* InPropertyData, FString& ExportedText);
 
     // datatable json
     static FString GetKeyFieldName(const UDataTable& InDataTable);
-    static bool WriteTableToJSON(const UDataTable& InDataTable, FString& OutExportText);
+    static bool WriteTableToJSON(const UDataTable& InDataTable, FString& OutExportText, bool bPretty = true, bool bParallel = false);
+    static bool WriteTableToJSON(const UDataTable& InDataTable, bool bPretty, TFunctionRef<bool(const FString&)> Sink, bool bParallel = false);
+    template <class PrintPolicy>
+    static void WriteTableRowsToJSON(const UDataTable& InDataTable, TArrayView<const TPair<FName, const uint8*>> InRows, FString& OutExportText);
     static bool WriteTableAsObjectToJSON(const UDataTable& InDataTable, TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> JsonWriter);
-    static bool WriteRowToJSON(const UScriptStruct* InRowStruct, const void* InRowData, TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> JsonWriter);
-    static bool WriteStructToJSON(const UScriptStruct* InStruct, const void* InStructData, TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> JsonWriter);
-    static bool WriteStructEntryToJSON(const void* InRowData, const FProperty* InProperty, const void* InPropertyData, TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> JsonWriter);
-    static bool WriteContainerEntryToJSON(
-        const FProperty* InProperty, const void* InPropertyData, const FString* InIdentifier, TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> JsonWriter);
-    static void WriteJSONObjectStartWithOptionalIdentifier(TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> JsonWriter, const FString* InIdentifier);
-    static void WriteJSONValueWithOptionalIdentifier(TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> JsonWriter, const FString* InIdentifier, const TCHAR* InValue);
+    template <class PrintPolicy>
+    static bool WriteRowToJSON(const UScriptStruct* InRowStruct, const void* InRowData, TSharedRef<TJsonWriter<TCHAR, PrintPolicy>> JsonWriter);
+    template <class PrintPolicy>
+    static bool WriteStructToJSON(const UScriptStruct* InStruct, const void* InStructData, TSharedRef<TJsonWriter<TCHAR, PrintPolicy>> JsonWriter);
+    template <class PrintPolicy>
+    static bool WriteStructEntryToJSON(const void* InRowData, const FProperty* InProperty, const void* InPropertyData, TSharedRef<TJsonWriter<TCHAR, PrintPolicy>> JsonWriter);
+    template <class PrintPolicy>
+    static bool WriteContainerEntryToJSON(const FProperty* InProperty, const void* InPropertyData, const FString* InIdentifier, TSharedRef<TJsonWriter<TCHAR, PrintPolicy>> JsonWriter);
+    template <class PrintPolicy>
+    static void WriteJSONObjectStartWithOptionalIdentifier(TSharedRef<TJsonWriter<TCHAR, PrintPolicy>> JsonWriter, const FString* InIdentifier);
+    template <class PrintPolicy>
+    static void WriteJSONValueWithOptionalIdentifier(TSharedRef<TJsonWriter<TCHAR, PrintPolicy>> JsonWriter, const FString* InIdentifier, const TCHAR* InValue);
 
 #pragma endregion
 
@@ -1480,9 +1671,72 @@ public:
     UFUNCTION(BlueprintCallable, Category = "ActionStr|SHA256Hash")
     static void SHA256HashFromArray(UPARAM(ref) FSHA256Hash& SHA256, const TArray<uint8>& Arr);
 
+    /** Hashes many strings at once, several per SIMD lane set. Hashes follow the order of Strings and match SHA256HashFromString */
+    UFUNCTION(BlueprintCallable, Category = "ActionStr|SHA256Hash")
+    static void SHA256HashFromStrings(const TArray<FString>& Strings, TArray<FString>& Hashes);
+
+    /** Hashes many files in parallel. Hashes follow the order of Filenames, a file that could not be read gets an empty string. Returns true if every file was hashed */
+    UFUNCTION(BlueprintCallable, Category = "ActionStr|SHA256Hash")
+    static bool SHA256HashFromFiles(const TArray<FString>& Filenames, TArray<FString>& Hashes);
+
+    /**
+     * Like SHA256HashFromFiles, but files whose path, size, modification time and file id match the on-disk hash cache are not read.
+     * Only new or changed files are hashed. The cache is saved on SaveFileHashCache and when the module shuts down
+     */
+    UFUNCTION(BlueprintCallable, Category = "ActionStr|SHA256Hash")
+    static bool SHA256HashFromFilesCached(const TArray<FString>& Filenames, TArray<FString>& Hashes);
+
+    /** Writes the hash cache to Saved/AGT/FileHashes.bin if it changed */
+    UFUNCTION(BlueprintCallable, Category = "ActionStr|SHA256Hash")
+    static bool SaveFileHashCache();
+
+    /**
+     * Statistics of the hash cache since startup
+     * @param cached Files answered from the cache
+     * @param hashed Files that had to be read and hashed
+     */
+    UFUNCTION(BlueprintPure, Category = "ActionStr|SHA256Hash")
+    static void GetFileHashCacheStats(int64& cached, int64& hashed);
+
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ActionStr|SHA256Hash")
     static FString SHA256HashGetHash(UPARAM(ref) FSHA256Hash& SHA256);
 
+    /**
+     * Hashes a large file as a SHA-256 Merkle tree, leaves in parallel, and saves the leaf hashes to TreeFile
+     * @param RootHash Root of the tree. Differs from SHA256HashFromFile of the same file
+     * @param LeafSize Raised to 1024 if smaller
+     */
+    UFUNCTION(BlueprintCallable, Category = "ActionStr|SHA256Hash")
+    static bool SHA256TreeHashFile(const FString& Filename, const FString& TreeFile, FString& RootHash, const int64 LeafSize = 4194304);
+
+    /**
+     * Re-hashes only the leaves of [Offset, Offset + Length) and compares them with the ones saved in TreeFile. A negative Length checks to the end
+     * @param ChangedOffsets Start of every leaf that differs, empty if the range is intact
+     * @return false if the file or the tree could not be read
+     */
+    UFUNCTION(BlueprintCallable, Category = "ActionStr|SHA256Hash")
+    static bool SHA256TreeVerifyFile(const FString& Filename, const FString& TreeFile, TArray<int64>& ChangedOffsets, const int64 Offset = 0, const int64 Length = -1);
+
+    /** Tree hash of a subrange of a file, leaves counted from Offset. LeafSize is raised to 1024 if smaller */
+    UFUNCTION(BlueprintCallable, Category = "ActionStr|SHA256Hash")
+    static bool SHA256TreeHashRange(const FString& Filename, const int64 Offset, const int64 Length, FString& RootHash, const int64 LeafSize = 4194304);
+
+    /** Fast non-cryptographic fingerprint for change detection and cache keys */
+    UFUNCTION(BlueprintCallable, Category = "ActionStr|Fingerprint")
+    static void FingerprintFromString(UPARAM(ref) FAGTFingerprint& Fingerprint, const FString& Str);
+
+    UFUNCTION(BlueprintCallable, Category = "ActionStr|Fingerprint")
+    static bool FingerprintFromFile(UPARAM(ref) FAGTFingerprint& Fingerprint, const FString& Filename);
+
+    UFUNCTION(BlueprintCallable, Category = "ActionStr|Fingerprint")
+    static void FingerprintFromArray(UPARAM(ref) FAGTFingerprint& Fingerprint, const TArray<uint8>& Arr);
+
+    UFUNCTION(BlueprintPure, Category = "ActionStr|Fingerprint")
+    static FString FingerprintGetHash(const FAGTFingerprint& Fingerprint);
+
+    UFUNCTION(BlueprintPure, Category = "ActionStr|Fingerprint", meta = (DisplayName = "Equal (Fingerprint)", CompactNodeTitle = "=="))
+    static bool EqualEqual_Fingerprint(const FAGTFingerprint& A, const FAGTFingerprint& B);
+
 #pragma endregion
 
 #pragma region ActionWidget
@@ -1894,6 +2148,177 @@ private:
     EAsyncCallType CallType;
 };
 
+/**
+ * Asynchronous file request running on the background file I/O queue.
+ * Completed and Failed fire on the game thread, Progress fires every frame while the request runs.
+ * Keep the returned node around to Cancel it.
+ */
+UCLASS()
+class ADVANCEGAMETOOLS_API UAGTAsyncFileIO : public UBlueprintAsyncActionBase
+{
+    GENERATED_BODY()
+
+public:
+    UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject", HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"),
+        Category = "ActionFiles|Async")
+    static UAGTAsyncFileIO* ReadTextAsync(UObject* WorldContextObject, const FString& Path, EAGTFileIOPriority Priority = EAGTFileIOPriority::Normal);
+
+    UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject", HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"),
+        Category = "ActionFiles|Async")
+    static UAGTAsyncFileIO* SaveTextAsync(
+        UObject* WorldContextObject, const FString& Path, const FString& Text, bool Append = false, bool Force = false, EAGTFileIOPriority Priority = EAGTFileIOPriority::Normal);
+
+    UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject", HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"),
+        Category = "ActionFiles|Async")
+    static UAGTAsyncFileIO* ReadByteAsync(UObject* WorldContextObject, const FString& Path, EAGTFileIOPriority Priority = EAGTFileIOPriority::Normal);
+
+    UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject", HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"),
+        Category = "ActionFiles|Async")
+    static UAGTAsyncFileIO* SaveByteAsync(UObject* WorldContextObject, const FString& Path, const TArray<uint8>& Bytes, bool Append = false, bool Force = false,
+        EAGTFileIOPriority Priority = EAGTFileIOPriority::Normal);
+
+    UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject", HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"),
+        Category = "ActionFiles|Async")
+    static UAGTAsyncFileIO* ReadCSVAsync(UObject* WorldContextObject, const FString& Path, bool HeaderFirst = true, EAGTFileIOPriority Priority = EAGTFileIOPriority::Normal);
+
+    UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject", HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"),
+        Category = "ActionFiles|Async")
+    static UAGTAsyncFileIO* SaveCSVAsync(UObject* WorldContextObject, const FString& Path, const TArray<FString>& Headers, const TArray<FString>& Data, bool Force = false,
+        EAGTFileIOPriority Priority = EAGTFileIOPriority::Normal);
+
+    // UBlueprintAsyncActionBase interface
+    virtual void Activate() override;
+    //~UBlueprintAsyncActionBase interface
+
+    /** Stops the request. Failed fires with the Canceled result. */
+    UFUNCTION(BlueprintCallable, Category = "ActionFiles|Async")
+    void Cancel();
+
+    UPROPERTY(BlueprintAssignable)
+    FAGTFileIOProgressSignature Progress;
+
+    UPROPERTY(BlueprintAssignable)
+    FAGTFileIOCompleteSignature Completed;
+
+    UPROPERTY(BlueprintAssignable)
+    FAGTFileIOCompleteSignature Failed;
+
+private:
+    typedef TFunction<FAGTFileIORequestRef(FAGTFileIORequest::FOnComplete&&)> FStartRequest;
+
+    static UAGTAsyncFileIO* Create(UObject* WorldContextObject, FStartRequest&& InStartRequest);
+
+    /** Reports progress while the request runs */
+    bool TickProgress(float DeltaTime);
+
+    void OnRequestComplete(FAGTFileIORequest& InRequest);
+
+    FStartRequest StartRequest;
+    FAGTFileIORequestPtr Request;
+    FTSTicker::FDelegateHandle TickerHandle;
+    float LastProgress{-1.0f};
+};
+
+/**
+ * Bulk copy, move and delete jobs running on the thread pool.
+ * Progress fires every frame while files are processed, Completed or Failed fire once on the game thread.
+ * To resume a canceled or failed run, start the same jobs again with Resume set.
+ */
+UCLASS()
+class ADVANCEGAMETOOLS_API UAGTAsyncFileOperation : public UBlueprintAsyncActionBase
+{
+    GENERATED_BODY()
+
+public:
+    UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject", HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"),
+        Category = "ActionFiles|Async")
+    static UAGTAsyncFileOperation* RunFileOperationsAsync(UObject* WorldContextObject, const TArray<FAGTFileOperationJob>& Jobs, int32 Concurrency = 4, bool Resume = false);
+
+    UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject", HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"),
+        Category = "ActionFiles|Async")
+    static UAGTAsyncFileOperation* CopyDirectoryAsync(UObject* WorldContextObject, const FString& Source, const FString& Dest, int32 Concurrency = 4, bool Resume = false);
+
+    UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject", HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"),
+        Category = "ActionFiles|Async")
+    static UAGTAsyncFileOperation* MoveDirectoryAsync(UObject* WorldContextObject, const FString& Source, const FString& Dest, int32 Concurrency = 4, bool Resume = false);
+
+    UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject", HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"),
+        Category = "ActionFiles|Async")
+    static UAGTAsyncFileOperation* RemoveDirectoryAsync(UObject* WorldContextObject, const FString& Path, int32 Concurrency = 4);
+
+    // UBlueprintAsyncActionBase interface
+    virtual void Activate() override;
+    //~UBlueprintAsyncActionBase interface
+
+    /** Stops after the current chunk of every worker. Failed fires with the Canceled result. */
+    UFUNCTION(BlueprintCallable, Category = "ActionFiles|Async")
+    void Cancel();
+
+    UPROPERTY(BlueprintAssignable)
+    FAGTFileOperationProgressSignature Progress;
+
+    UPROPERTY(BlueprintAssignable)
+    FAGTFileOperationCompleteSignature Completed;
+
+    UPROPERTY(BlueprintAssignable)
+    FAGTFileOperationCompleteSignature Failed;
+
+private:
+    static UAGTAsyncFileOperation* Create(UObject* WorldContextObject, const TArray<FAGTFileOperationJob>& Jobs, int32 Concurrency, bool Resume);
+
+    /** Reports progress while the operation runs */
+    bool TickProgress(float DeltaTime);
+
+    void OnOperationComplete(FAGTBulkFileOperation& InOperation);
+
+    FAGTBulkFileOperationPtr Operation;
+    FTSTicker::FDelegateHandle TickerHandle;
+    int64 LastBytesDone{-1};
+    int32 LastFilesDone{-1};
+};
+
+/**
+ * SHA-256 of many files, hashed on the thread pool.
+ * Progress fires every frame while files are hashed, Completed or Failed fire once on the game thread with one hash per input file.
+ */
+UCLASS()
+class ADVANCEGAMETOOLS_API UAGTAsyncHashFiles : public UBlueprintAsyncActionBase
+{
+    GENERATED_BODY()
+
+public:
+    UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject", HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"),
+        Category = "ActionStr|SHA256Hash")
+    static UAGTAsyncHashFiles* SHA256HashFromFilesAsync(UObject* WorldContextObject, const TArray<FString>& Filenames, int32 Concurrency = 8);
+
+    // UBlueprintAsyncActionBase interface
+    virtual void Activate() override;
+    //~UBlueprintAsyncActionBase interface
+
+    /** Stops after the current chunk of every worker. Failed fires with the Canceled result. */
+    UFUNCTION(BlueprintCallable, Category = "ActionStr|SHA256Hash")
+    void Cancel();
+
+    UPROPERTY(BlueprintAssignable)
+    FAGTFileOperationProgressSignature Progress;
+
+    UPROPERTY(BlueprintAssignable)
+    FAGTBatchHashCompleteSignature Completed;
+
+    UPROPERTY(BlueprintAssignable)
+    FAGTBatchHashCompleteSignature Failed;
+
+private:
+    /** Reports progress while the hashing runs */
+    bool TickProgress(float DeltaTime);
+
+    void OnHashComplete(FAGTBatchHash& InBatch);
+
+    FAGTBatchHashPtr Batch;
+    FTSTicker::FDelegateHandle TickerHandle;
+    int64 LastBytesDone{-1};
+};
+
 /**
  * A handle to a file
  * If this object is garbage collected or destroyed
@@ -1909,11 +2334,7 @@ public:
     virtual void BeginDestroy() override
     {
         UObject::BeginDestroy();
-        if (Handle)
-        {
-            delete Handle;
-            Handle = nullptr;
-        }
+        Close();
     }
 
     /**
@@ -1922,7 +2343,7 @@ public:
     UFUNCTION(BlueprintCallable)
     bool Seek(const int64 newPosition)
     {
-        if (!Handle)
+        if (!Handle || !Flush())
         {
             return false;
         }
@@ -1936,7 +2357,7 @@ public:
     UFUNCTION(BlueprintCallable)
     bool SeekFromEnd(const int64 numBytes)
     {
-        if (!Handle)
+        if (!Handle || !Flush())
         {
             return false;
         }
@@ -1950,7 +2371,7 @@ public:
     UFUNCTION(BlueprintCallable)
     bool SeekToStart()
     {
-        if (!Handle)
+        if (!Handle || !Flush())
         {
             return false;
         }
@@ -1964,7 +2385,7 @@ public:
     UFUNCTION(BlueprintCallable)
     bool SeekToEnd()
     {
-        if (!Handle)
+        if (!Handle || !Flush())
         {
             return false;
         }
@@ -1978,21 +2399,100 @@ public:
     UFUNCTION(BlueprintCallable)
     bool Read(TArray<uint8>& bytesTo, const int64 numBytes)
     {
-        if (!Handle || !CanRead)
+        if (!Handle || !CanRead || !Flush())
         {
             return false;
         }
 
-        const int64 numToRead = FMath::Min(Handle->Size() - Handle->Tell(), numBytes);
+        const int64 position = Handle->Tell();
+        const int64 numToRead = FMath::Min(Handle->Size() - position, numBytes);
         if (numToRead <= 0)
         {
             return false;
         }
 
         bytesTo.SetNum(numToRead);
+        if (ReadAhead.IsValid() && position + numToRead <= Reader->Size())
+        {
+            return ReadAhead->Read(position, bytesTo.GetData(), numToRead) == numToRead && Handle->Seek(position + numToRead);
+        }
         return Handle->Read(bytesTo.GetData(), bytesTo.Num());
     }
 
+    /**
+     * Prefetch the chunks after the one being read on a background thread, so Read in fixed steps usually finds its data in memory.
+     * chunkSize is the size of one prefetched block, numChunks how many are kept. A numChunks of 0 turns read-ahead off.
+     */
+    UFUNCTION(BlueprintCallable)
+    bool SetReadAhead(const int32 chunkSize = 262144, const int32 numChunks = 4);
+
+    /**
+     * How many reads since SetReadAhead found their data prefetched, and how many had to wait for the disk
+     */
+    UFUNCTION(BlueprintPure)
+    void GetReadAheadStats(int64& hits, int64& misses) const
+    {
+        hits = ReadAhead.IsValid() ? ReadAhead->GetHits() : 0;
+        misses = ReadAhead.IsValid() ? ReadAhead->GetMisses() : 0;
+    }
+
+    /**
+     * Read numBytes at offset without moving the cursor. Safe to call from several threads at once.
+     * Bytes still waiting in the write buffer are not visible until Flush.
+     */
+    UFUNCTION(BlueprintCallable)
+    bool ReadAt(TArray<uint8>& bytesTo, const int64 offset, const int64 numBytes)
+    {
+        if (!Reader.IsValid() || !CanRead)
+        {
+            return false;
+        }
+
+        return Reader->ReadAt(offset, numBytes, bytesTo);
+    }
+
+    /**
+     * Read up to numBytes at offset into the start of an existing buffer, never more than the buffer holds.
+     * The buffer is not resized, so it can be reused for every read. Safe to call from several threads at once.
+     */
+    UFUNCTION(BlueprintCallable)
+    bool ReadAtIntoBuffer(UPARAM(ref) TArray<uint8>& buffer, const int64 offset, const int64 numBytes, int64& bytesRead)
+    {
+        bytesRead = 0;
+        if (!Reader.IsValid() || !CanRead)
+        {
+            return false;
+        }
+
+        bytesRead = Reader->ReadAt(offset, buffer.GetData(), FMath::Min<int64>(numBytes, buffer.Num()));
+        return bytesRead >= 0;
+    }
+
+    /**
+     * Read many ranges at once without moving the cursor. The bytes of all ranges end up in bytesTo, slices locates each range in it.
+     */
+    UFUNCTION(BlueprintCallable)
+    bool ReadRanges(const TArray<FAGTReadRange>& ranges, TArray<uint8>& bytesTo, TArray<FAGTReadRange>& slices)
+    {
+        if (!Reader.IsValid() || !CanRead)
+        {
+            return false;
+        }
+
+        return Reader->ReadRanges(ranges, bytesTo, slices);
+    }
+
+    /**
+     * Read many ranges at once without moving the cursor, one array per range
+     */
+    UFUNCTION(BlueprintCallable)
+    bool ReadRangesSeparate(const TArray<FAGTReadRange>& ranges, TArray<FAGTByteArray>& chunks);
+
+    /**
+     * The positional reader behind ReadAt. Tasks can keep it alive independently of this object.
+     */
+    FAGTPositionalReaderPtr GetPositionalReader() const { return Reader; }
+
     /**
      * Write to the file
      */
@@ -2004,7 +2504,63 @@ public:
             return false;
         }
 
-        return Handle->Write(bytesOut.GetData(), bytesOut.Num());
+        return Append(bytesOut.GetData(), bytesOut.Num());
+    }
+
+    /**
+     * Collect writes in memory and hand them to the file in larger blocks.
+     * The buffer is written out once bufferSize bytes are pending, and every flushInterval seconds if flushInterval is above 0.
+     * A bufferSize of 0 writes straight through again.
+     */
+    UFUNCTION(BlueprintCallable)
+    bool SetWriteBuffer(const int32 bufferSize = 65536, const float flushInterval = 0.0f);
+
+    /**
+     * Write the pending buffer to the file. With toDisk the operating system is asked to put it on disk as well.
+     */
+    UFUNCTION(BlueprintCallable)
+    bool Flush(const bool toDisk = false);
+
+    /**
+     * Append a 32 bit integer in little endian order
+     */
+    UFUNCTION(BlueprintCallable)
+    bool WriteInt(const int32 value) { return AppendValue(value); }
+
+    /**
+     * Append a 64 bit integer in little endian order
+     */
+    UFUNCTION(BlueprintCallable)
+    bool WriteInt64(const int64 value) { return AppendValue(value); }
+
+    /**
+     * Append a 32 bit float
+     */
+    UFUNCTION(BlueprintCallable)
+    bool WriteFloat(const float value) { return AppendValue(value); }
+
+    /**
+     * Append a string as UTF-8, without terminator
+     */
+    UFUNCTION(BlueprintCallable)
+    bool WriteString(const FString& value, const bool addNewLine = false);
+
+    /**
+     * Append the binary serialized form of any struct
+     * Structs holding object, class, soft, weak or interface references or delegates are refused
+     */
+    UFUNCTION(BlueprintCallable, CustomThunk, meta = (CustomStructureParam = "value"))
+    bool WriteStruct(const UStruct* value);
+    DECLARE_FUNCTION(execWriteStruct)
+    {
+        Stack.Step(Stack.Object, NULL);
+
+        FProperty* Property = Stack.MostRecentProperty;
+        void* Ptr = Stack.MostRecentPropertyAddress;
+
+        P_FINISH;
+
+        *(bool*)RESULT_PARAM = P_THIS->AppendStruct(CastField<FStructProperty>(Property), Ptr);
     }
 
     /**
@@ -2018,7 +2574,8 @@ public:
             return 0;
         }
 
-        return Handle->Size();
+        // Pending bytes go to the current position once flushed
+        return FMath::Max(Handle->Size(), Handle->Tell() + WriteBuffer.Num());
     }
 
     /**
@@ -2027,19 +2584,205 @@ public:
     UFUNCTION(BlueprintCallable)
     void Close()
     {
+        if (FlushTicker.IsValid())
+        {
+            FTSTicker::GetCoreTicker().RemoveTicker(FlushTicker);
+            FlushTicker.Reset();
+        }
         if (Handle)
         {
+            Flush();
             delete Handle;
             Handle = nullptr;
         }
+        ReadAhead.Reset();
+        Reader.Reset();
+        if (!Path.IsEmpty())
+        {
+            // Readers pooled and stats cached while the file was open for write may hold its old state
+            FAGTFileChange::Notify(Path);
+            Path.Reset();
+        }
     }
 
 private:
+    /** Buffers or writes the bytes depending on the write buffer settings */
+    bool Append(const uint8* data, const int64 num);
+
+    template <typename T>
+    bool AppendValue(const T value)
+    {
+        if (!Handle || !CanWrite)
+        {
+            return false;
+        }
+        // Values are stored in the byte order of the platform, which is little endian on every supported target
+        return Append(reinterpret_cast<const uint8*>(&value), sizeof(T));
+    }
+
+    bool AppendStruct(FStructProperty* property, void* data);
+
+    /** Writes the buffer once the flush interval has passed */
+    bool TickFlush(float deltaTime);
+
+    /** Drops prefetched chunks before the file changes under them */
+    void InvalidateReadAhead()
+    {
+        if (ReadAhead.IsValid())
+        {
+            ReadAhead->Invalidate();
+        }
+    }
+
+    TArray<uint8> WriteBuffer;
+    int32 WriteBufferSize{0};
+    FTSTicker::FDelegateHandle FlushTicker;
+
     // The handle to the file. If this object is destroyed the file handle will go as well.
     IFileHandle* Handle;
 
+    // Separate descriptor for positional reads, shared with whoever asked for it
+    FAGTPositionalReaderPtr Reader;
+
+    // Prefetch ring used by Read, only set while read-ahead is on
+    TUniquePtr<FAGTReadAhead> ReadAhead;
+
+    // Path of a handle opened for write, its pooled readers and cached stats are dropped on close
+    FString Path;
+
     bool CanRead;
     bool CanWrite;
 
     friend class UAdvanceGameToolLibrary;
 };
+
+/**
+ * A read-only memory mapped view of a file
+ * If this object is garbage collected or destroyed the mapping is released
+ */
+UCLASS(BlueprintType)
+class ADVANCEGAMETOOLS_API UAGTMappedFile : public UObject
+{
+    GENERATED_BODY()
+
+public:
+    virtual void BeginDestroy() override
+    {
+        UObject::BeginDestroy();
+        View.Close();
+    }
+
+    /**
+     * Return true if the file is mapped into memory, false if reads fall back to a file handle
+     */
+    UFUNCTION(BlueprintPure)
+    bool IsMapped() const { return View.IsMapped(); }
+
+    /**
+     * Return the size of the file
+     */
+    UFUNCTION(BlueprintPure)
+    int64 Size() const { return View.Size(); }
+
+    /**
+     * Copy numBytes at offset into bytesTo. Only the requested slice is copied.
+     */
+    UFUNCTION(BlueprintCallable)
+    bool ReadSlice(TArray<uint8>& bytesTo, const int64 offset, const int64 numBytes) { return View.CopyRange(offset, numBytes, bytesTo); }
+
+    /**
+     * Releases the mapping. No further reads can be performed once this is called.
+     */
+    UFUNCTION(BlueprintCallable)
+    void Close() { View.Close(); }
+
+    /** Zero-copy access for native code. Valid while the file stays open and IsMapped returns true. */
+    bool GetView(const int64 offset, const int64 numBytes, TArrayView64<const uint8>& viewOut) const { return View.GetView(offset, numBytes, viewOut); }
+
+    const FAGTMappedFileView& GetFileView() const { return View; }
+
+private:
+    FAGTMappedFileView View;
+
+    friend class UAdvanceGameToolLibrary;
+};
+
+/**
+ * A streaming reader of text lines. Reads UTF-8/ANSI and UTF-16LE files through a fixed-size buffer.
+ * If this object is garbage collected or destroyed the file handle is closed
+ */
+UCLASS(BlueprintType)
+class ADVANCEGAMETOOLS_API UAGTLineReader : public UObject
+{
+    GENERATED_BODY()
+
+public:
+    virtual void BeginDestroy() override
+    {
+        UObject::BeginDestroy();
+        Close();
+    }
+
+    /**
+     * Read up to maxLines lines matching the pattern. lineOffsets receives the byte offset of each line in the file.
+     * @return True if at least one line was read
+     */
+    UFUNCTION(BlueprintCallable)
+    bool ReadLines(TArray<FString>& lines, TArray<int64>& lineOffsets, const int32 maxLines = 100);
+
+    /**
+     * Move the reader to a byte offset, usually one returned by ReadLines.
+     */
+    UFUNCTION(BlueprintCallable)
+    bool SeekToOffset(const int64 offset);
+
+    /**
+     * Return true once every line has been read
+     */
+    UFUNCTION(BlueprintPure)
+    bool IsEndOfFile() const { return bEndOfFile; }
+
+    /**
+     * Return the byte offset of the next unread line
+     */
+    UFUNCTION(BlueprintPure)
+    int64 Tell() const { return PendingLine.Num() > 0 ? PendingOffset : BufferStart + Cursor; }
+
+    /**
+     * Return the size of the file
+     */
+    UFUNCTION(BlueprintPure)
+    int64 Size() const { return FileSize; }
+
+    /**
+     * Closes the reader. No further lines can be read once this is called.
+     */
+    UFUNCTION(BlueprintCallable)
+    void Close();
+
+private:
+    /** Reads the next block of the file into the buffer. Returns false at the end of the file */
+    bool FillBuffer();
+
+    /** Converts one line without its terminator and adds it if it matches the pattern */
+    bool EmitLine(const uint8* Data, int32 NumBytes, const int64 Offset, TArray<FString>& Lines, TArray<int64>& Offsets) const;
+
+    IFileHandle* Handle{nullptr};
+    TUniquePtr<FRegexPattern> Pattern;
+
+    TArray<uint8> Buffer;
+    int64 BufferStart{0};
+    int32 BufferLen{0};
+    int32 Cursor{0};
+
+    // Bytes of a line that runs past the end of the buffer
+    TArray<uint8> PendingLine;
+    int64 PendingOffset{0};
+
+    int64 FileSize{0};
+    int64 ContentStart{0};
+    bool bUTF16{false};
+    bool bEndOfFile{false};
+
+    friend class UAdvanceGameToolLibrary;
+};
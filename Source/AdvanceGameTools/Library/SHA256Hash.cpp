@@ -1,7 +1,10 @@
 ﻿#include "SHA256Hash.h"
 #include "GenericPlatform/GenericPlatformFile.h"
 #include "Containers/ArrayView.h"
-#include <AdvanceGameTools/ThirdParty/SHA/picosha2.h>
+#include "AdvanceGameTools/Library/AGTFileHandlePool.h"
+#include "Async/AsyncFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "AdvanceGameTools/Library/AGTSha256.h"
 #include <vector>
 
 FSHA256Hash::FSHA256Hash()
@@ -17,34 +20,36 @@ FString FSHA256Hash::HashStringHelper(const FString& Str)
 
 void FSHA256Hash::FromString(const FString& Str)
 {
-    std::string HashStr;
-    picosha2::hash256_hex_string(std::string(TCHAR_TO_UTF8(*Str)), HashStr);
-    Hash = UTF8_TO_TCHAR(HashStr.c_str());
+    const FTCHARToUTF8 Utf8(*Str, Str.Len());
+    Hash = FAGTSha256::HashHex(Utf8.Get(), Utf8.Length());
 }
 
 void FSHA256Hash::FromArray(const TArray<uint8>& Arr)
 {
-    const auto ArrView = MakeArrayView(Arr.GetData(), Arr.Num());
-    Hash = UTF8_TO_TCHAR(picosha2::hash256_hex_string(ArrView.begin(), ArrView.end()).c_str());
+    Hash = FAGTSha256::HashHex(Arr.GetData(), Arr.Num());
 }
 
 void FSHA256Hash::FromArray64(const TArray64<uint8>& Arr)
 {
-    const auto ArrView = TArrayView64<const uint8>(Arr.GetData(), Arr.Num());
-    Hash = UTF8_TO_TCHAR(picosha2::hash256_hex_string(ArrView.begin(), ArrView.end()).c_str());
+    Hash = FAGTSha256::HashHex(Arr.GetData(), Arr.Num());
+}
+
+void FSHA256Hash::FromBytes(const uint8* Data, int64 Size)
+{
+    Hash = FAGTSha256::HashHex(Data, Size);
 }
 
 bool FSHA256Hash::FromFile(const FString& File)
 {
-    if (IFileHandle* FilePtr = IPlatformFile::GetPlatformPhysical().OpenRead(*File))
+    if (const FAGTPositionalReaderPtr Reader = FAGTFileHandlePool::Get().Acquire(File))
     {
-        picosha2::hash256_one_by_one hasher;
+        FAGTSha256 hasher;
 
         // read in 64K chunks to prevent raising the memory high water mark too much
         {
             static const int64 FILE_BUFFER_SIZE = 64 * 1024;
             std::vector<uint8> VecBuff(FILE_BUFFER_SIZE, 0);
-            int64 FileSize = FilePtr->Size();
+            int64 FileSize = Reader->Size();
             for (int64 Pointer = 0; Pointer < FileSize;)
             {
                 // how many bytes to read in this iteration
@@ -54,27 +59,19 @@ bool FSHA256Hash::FromFile(const FString& File)
                     SizeToRead = FILE_BUFFER_SIZE;
                 }
                 // read dem bytes
-                if (!FilePtr->Read(VecBuff.data(), SizeToRead))
+                if (Reader->ReadAt(Pointer, VecBuff.data(), SizeToRead) != SizeToRead)
                 {
                     UE_LOG(LogTemp, Error, TEXT("Read error while validating '%s' at offset %lld."), *File, Pointer);
-
-                    // don't forget to close
-                    delete FilePtr;
                     return false;
                 }
                 Pointer += SizeToRead;
 
                 // update the hash
-                hasher.process(VecBuff.begin(), VecBuff.begin() + SizeToRead);
+                hasher.Update(VecBuff.data(), SizeToRead);
             }
-
-            // done with the file
-            delete FilePtr;
         }
 
-        hasher.finish();
-
-        Hash = UTF8_TO_TCHAR(picosha2::get_hash_hex_string(hasher).c_str());
+        Hash = hasher.FinalHex();
 
         return true;
     }
@@ -82,6 +79,74 @@ bool FSHA256Hash::FromFile(const FString& File)
     return false;
 }
 
+bool FSHA256Hash::FromFileOverlapped(const FString& File, const TFunction<bool(int64)>& OnChunk)
+{
+    static constexpr int64 ChunkSize = 256 * 1024;
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    const int64 FileSize = PlatformFile.FileSize(*File);
+    if (FileSize < 0)
+    {
+        return false;
+    }
+    TUniquePtr<IAsyncReadFileHandle> Handle(PlatformFile.OpenAsyncRead(*File));
+    if (!Handle.IsValid())
+    {
+        return false;
+    }
+
+    TArray<uint8> Buffers[2];
+    Buffers[0].SetNumUninitialized(static_cast<int32>(FMath::Min(ChunkSize, FileSize)));
+    Buffers[1].SetNumUninitialized(Buffers[0].Num());
+    auto Issue = [&Handle, &Buffers, FileSize](int64 Offset, int32 Slot)
+    { return Handle->ReadRequest(Offset, FMath::Min(ChunkSize, FileSize - Offset), AIOP_Normal, nullptr, Buffers[Slot].GetData()); };
+
+    FAGTSha256 hasher;
+    IAsyncReadRequest* Pending = FileSize > 0 ? Issue(0, 0) : nullptr;
+    bool bSuccess = true;
+    int32 Slot = 0;
+    for (int64 Offset = 0; Offset < FileSize; Slot ^= 1)
+    {
+        const int64 Size = FMath::Min(ChunkSize, FileSize - Offset);
+        bSuccess = Pending && Pending->WaitCompletion() && Pending->GetReadResults() != nullptr;
+        delete Pending;
+        Pending = nullptr;
+        if (!bSuccess)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Read error while hashing '%s' at offset %lld."), *File, Offset);
+            break;
+        }
+
+        // The other buffer fills while this one is hashed
+        const int64 Next = Offset + Size;
+        if (Next < FileSize)
+        {
+            Pending = Issue(Next, Slot ^ 1);
+        }
+        hasher.Update(Buffers[Slot].GetData(), Size);
+        Offset = Next;
+
+        if (OnChunk && !OnChunk(Size))
+        {
+            bSuccess = false;
+            break;
+        }
+    }
+    if (Pending)
+    {
+        // The read still writes into a buffer, it must land before the buffers go away
+        Pending->WaitCompletion();
+        delete Pending;
+    }
+    if (!bSuccess)
+    {
+        return false;
+    }
+
+    Hash = hasher.FinalHex();
+    return true;
+}
+
 FString FSHA256Hash::GetHash() const
 {
     return Hash;
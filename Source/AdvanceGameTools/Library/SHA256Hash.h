@@ -18,8 +18,15 @@ public:
     void FromString(const FString& Str);
     void FromArray(const TArray<uint8>& Arr);
     void FromArray64(const TArray64<uint8>& Arr);
+    void FromBytes(const uint8* Data, int64 Size);
     bool FromFile(const FString& File);
 
+    /**
+     * Hashes a file with two buffers: the next chunk is read by the platform's async I/O while the current one is hashed.
+     * OnChunk gets the size of every hashed chunk, returning false from it cancels.
+     */
+    bool FromFileOverlapped(const FString& File, const TFunction<bool(int64)>& OnChunk = nullptr);
+
     FString GetHash() const;
 
 private: